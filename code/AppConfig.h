@@ -1,11 +1,34 @@
 // AppConfig.h
 #pragma once
 
-enum class DateLocale { EN, DE };
+#ifndef METRICS_HTTP
+#define METRICS_HTTP 0  // 1: serve the Metrics JSON at http://<device-ip>/metrics
+#endif
+
+#ifndef EPD_PUSH_ASYNC
+#define EPD_PUSH_ASYNC 1  // 1: upload partial regions from a task, one panel refresh per batch
+#endif
+
+#ifndef CAL_TIME_SLICED
+// 1: calendar fetch in time slices on the loop instead of a task (single-core chips: S2/C3)
+#if defined(CONFIG_FREERTOS_UNICORE) && CONFIG_FREERTOS_UNICORE
+#define CAL_TIME_SLICED 1
+#else
+#define CAL_TIME_SLICED 0
+#endif
+#endif
+
+enum class DateLocale { EN, DE, FR };
 
 struct AppConfig {
   DateLocale dateLocale = DateLocale::DE; // default to German
   bool use24h = true;                     // keep 24h clock
+  bool deepSleep = false;                 // battery mode: deep sleep between minute ticks
+  int  sleepRefreshMin = 15;              // deep sleep: minutes between WiFi refresh cycles
+  bool wifiOffWhenIdle = false;           // radio off between fetches (fast reconnect) instead of modem sleep
+  bool wifiStaticIp = false;              // reuse the last DHCP lease as static IP (skips DHCP)
+  float weatherLat = 52.52f;              // forecast location (default Berlin)
+  float weatherLon = 13.41f;
 };
 
 extern AppConfig gConfig;
@@ -0,0 +1,33 @@
+// BackgroundTask.cpp
+#include "BackgroundTask.h"
+#include <stdio.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+bool BackgroundTask::start(const char* name, Job job, void* arg, uint32_t periodMs,
+                           int core, uint32_t stackBytes, UBaseType_t prio) {
+  if (handle_) return true;
+  job_ = job; arg_ = arg; periodMs_ = periodMs;
+  if (xTaskCreatePinnedToCore(&BackgroundTask::entry, name, stackBytes, this, prio, &handle_, core) != pdPASS) {
+    DBG("[TASK] %s: create failed\n", name);
+    handle_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void BackgroundTask::kick() {
+  if (handle_) xTaskNotifyGive(handle_);
+}
+
+void BackgroundTask::entry(void* self) {
+  BackgroundTask* t = (BackgroundTask*)self;
+  for (;;) {
+    t->job_(t->arg_);
+    t->runs_ = t->runs_ + 1;
+    // Sleep until the next period; a kick() ends the wait early
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(t->periodMs_));
+  }
+}
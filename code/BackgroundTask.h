@@ -0,0 +1,30 @@
+// BackgroundTask.h
+// Periodic job on its own FreeRTOS task, pinned away from the render loop
+// - Runs job(arg) once right after start(), then every periodMs or when kicked
+// - The job publishes its results itself (e.g. through a SnapshotChannel)
+#pragma once
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+class BackgroundTask {
+public:
+  typedef void (*Job)(void* arg);
+
+  // core: 0 keeps network work next to the WiFi stack, away from loop() on core 1
+  bool start(const char* name, Job job, void* arg, uint32_t periodMs,
+             int core = 0, uint32_t stackBytes = 12288, UBaseType_t prio = 1);
+  // Run the job now instead of waiting for the period (never blocks the caller)
+  void kick();
+  bool running() const { return handle_ != nullptr; }
+  uint32_t runs() const { return runs_; }
+
+private:
+  static void entry(void* self);
+
+  TaskHandle_t handle_{nullptr};
+  Job      job_{nullptr};
+  void*    arg_{nullptr};
+  uint32_t periodMs_{0};
+  volatile uint32_t runs_{0};
+};
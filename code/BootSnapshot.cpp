@@ -0,0 +1,210 @@
+// BootSnapshot.cpp
+#include "BootSnapshot.h"
+#include "Fnv1a.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const uint32_t kFileMagic   = 0x5A534E50;          // "ZSNP"
+static const int64_t  kMinSpanUs   = 3600LL * 1000000LL;  // drift samples need an hour between syncs
+static const float    kMaxDriftPpm = 50000.0f;            // the RTC slow clock is bad, not that bad
+static const char*    kFramePath   = "/frame.bin";
+static const char*    kCalPath     = "/cal.bin";
+static const char*    kTimePath    = "/time.bin";
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t len;   // payload bytes
+  uint32_t hash;  // FNV-1a of the payload
+};
+
+struct Part {
+  const void* p;
+  size_t      n;
+};
+
+static bool gMounted = false;
+static uint32_t gFrameHash = 0;  // last frame written, skips identical saves
+
+static void* allocPreferPsram(size_t n) {
+  void* p = psramFound() ? ps_malloc(n) : nullptr;
+  return p ? p : malloc(n);
+}
+
+// Temp file + rename: a reset mid-write leaves the previous snapshot intact
+static bool writeParts(const char* path, const Part* parts, int n) {
+  if (!gMounted) return false;
+  FileHeader h{ kFileMagic, 0, kFnv1aBasis };
+  for (int i = 0; i < n; ++i) { h.len += (uint32_t)parts[i].n; h.hash = fnv1a(h.hash, parts[i].p, parts[i].n); }
+
+  char tmp[24];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+  File f = LittleFS.open(tmp, "w");
+  if (!f) return false;
+  bool ok = f.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+  for (int i = 0; i < n && ok; ++i) ok = f.write((const uint8_t*)parts[i].p, parts[i].n) == parts[i].n;
+  f.close();
+  if (ok) { LittleFS.remove(path); ok = LittleFS.rename(tmp, path); }
+  if (!ok) { LittleFS.remove(tmp); DBG("[SNAP] write %s failed\n", path); }
+  return ok;
+}
+
+// Payload length from the header, -1 if the file is missing or foreign
+static long openPayload(const char* path, File* f, FileHeader* h) {
+  if (!gMounted || !LittleFS.exists(path)) return -1;
+  *f = LittleFS.open(path, "r");
+  if (!*f) return -1;
+  if (f->read((uint8_t*)h, sizeof(*h)) != sizeof(*h) || h->magic != kFileMagic ||
+      f->size() != sizeof(*h) + h->len) {
+    f->close();
+    return -1;
+  }
+  return (long)h->len;
+}
+
+// Read exactly the given parts and verify the hash
+static bool readParts(const char* path, const Part* parts, int n) {
+  File f; FileHeader h;
+  size_t want = 0;
+  for (int i = 0; i < n; ++i) want += parts[i].n;
+  if (openPayload(path, &f, &h) != (long)want) return false;
+  uint32_t hash = kFnv1aBasis;
+  bool ok = true;
+  for (int i = 0; i < n && ok; ++i) {
+    ok = f.read((uint8_t*)parts[i].p, parts[i].n) == parts[i].n;
+    hash = fnv1a(hash, parts[i].p, parts[i].n);
+  }
+  f.close();
+  return ok && hash == h.hash;
+}
+
+bool snapshotBegin() {
+  if (!gMounted) gMounted = LittleFS.begin(/*formatOnFail=*/true);
+  if (!gMounted) DBG("[SNAP] LittleFS unavailable, no fast boot\n");
+  return gMounted;
+}
+
+// ---------- Frame ----------
+
+bool snapshotSaveFrame(const uint8_t* fb, size_t n, const BootState& st) {
+  const uint32_t hash = fnv1a(kFnv1aBasis, fb, n);
+  if (hash == gFrameHash) return true;  // region state only changes together with the frame
+  const uint32_t t0 = millis();
+  const Part parts[] = { { &st, sizeof(st) }, { fb, n } };
+  if (!writeParts(kFramePath, parts, 2)) return false;
+  gFrameHash = hash;
+  DBG("[SNAP] frame saved (%u bytes, %u ms)\n", (unsigned)(sizeof(st) + n), (unsigned)(millis() - t0));
+  return true;
+}
+
+bool snapshotLoadFrame(uint8_t* fb, size_t n, BootState* st) {
+  const Part parts[] = { { st, sizeof(*st) }, { fb, n } };
+  if (!readParts(kFramePath, parts, 2)) return false;
+  gFrameHash = fnv1a(kFnv1aBasis, fb, n);
+  return true;
+}
+
+// ---------- Calendar ----------
+
+bool snapshotSaveCalendar(ICalendarProvider* cal) {
+  const size_t need = cal ? cal->saveCache(nullptr, 0) : 0;
+  if (!need) return false;
+  uint8_t* buf = (uint8_t*)allocPreferPsram(need);
+  if (!buf) return false;
+  const size_t n = cal->saveCache(buf, need);
+  const Part part = { buf, n };
+  const bool ok = n && writeParts(kCalPath, &part, 1);
+  free(buf);
+  if (ok) DBG("[SNAP] calendar saved (%u bytes)\n", (unsigned)n);
+  return ok;
+}
+
+bool snapshotLoadCalendar(ICalendarProvider* cal) {
+  File f; FileHeader h;
+  const long len = openPayload(kCalPath, &f, &h);
+  if (!cal || len <= 0) return false;
+  f.close();
+  uint8_t* buf = (uint8_t*)allocPreferPsram((size_t)len);
+  if (!buf) return false;
+  const Part part = { buf, (size_t)len };
+  const bool ok = readParts(kCalPath, &part, 1) && cal->loadCache(buf, (size_t)len);
+  free(buf);
+  return ok;
+}
+
+// ---------- Time ----------
+
+struct TimeHistory {
+  int64_t  lastSyncUs{0};  // UTC of the last NTP sync, microseconds
+  float    driftPpm{0};
+  uint32_t syncs{0};       // syncs that fed the estimate
+};
+
+static TimeHistory gHist;
+static volatile bool gHistDirty = false;
+// Uncorrected clock reading the next sync is compared against (UTC and esp_timer, us)
+static int64_t gBaseUtcUs = 0, gBaseMonoUs = 0;
+
+static int64_t nowUtcUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// SNTP task context: update the estimate in RAM only
+static void onTimeSync(struct timeval* tv) {
+  const int64_t synced = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+  const int64_t mono = esp_timer_get_time();
+  if (gHist.lastSyncUs > 0 && gBaseUtcUs >= gHist.lastSyncUs) {
+    const int64_t predicted = gBaseUtcUs + (mono - gBaseMonoUs);
+    const int64_t span = predicted - gHist.lastSyncUs;
+    if (span >= kMinSpanUs) {
+      float ppm = (float)(synced - predicted) * 1e6f / (float)span;
+      if (ppm > kMaxDriftPpm) ppm = kMaxDriftPpm;
+      if (ppm < -kMaxDriftPpm) ppm = -kMaxDriftPpm;
+      gHist.driftPpm = gHist.syncs ? gHist.driftPpm + (ppm - gHist.driftPpm) / 4 : ppm;
+      gHist.syncs++;
+    }
+  }
+  gHist.lastSyncUs = synced;
+  gBaseUtcUs = synced; gBaseMonoUs = mono;
+  gHistDirty = true;
+}
+
+void timeKeeperBegin() {
+  const Part part = { &gHist, sizeof(gHist) };
+  if (!readParts(kTimePath, &part, 1)) gHist = TimeHistory();
+  gBaseUtcUs = nowUtcUs(); gBaseMonoUs = esp_timer_get_time();
+  sntp_set_time_sync_notification_cb(onTimeSync);
+}
+
+bool timeKeeperRestore() {
+  const int64_t raw = gBaseUtcUs;
+  if (gHist.lastSyncUs <= 0 || raw < gHist.lastSyncUs) return false;  // power cycle: RTC restarted
+  const int64_t fix = (int64_t)((float)(raw - gHist.lastSyncUs) * gHist.driftPpm / 1e6f);
+  const int64_t t = nowUtcUs() + fix;
+  struct timeval tv = { (time_t)(t / 1000000LL), (suseconds_t)(t % 1000000LL) };
+  settimeofday(&tv, nullptr);
+  DBG("[Time] RTC kept running, %lds since NTP, drift %.1f ppm, corrected %+ld ms\n",
+      (long)((raw - gHist.lastSyncUs) / 1000000LL), gHist.driftPpm, (long)(fix / 1000));
+  return true;
+}
+
+void timeKeeperSave() {
+  if (!gHistDirty) return;
+  gHistDirty = false;
+  const TimeHistory h = gHist;
+  const Part part = { &h, sizeof(h) };
+  writeParts(kTimePath, &part, 1);
+}
+
+float timeKeeperDriftPpm() {
+  return gHist.driftPpm;
+}
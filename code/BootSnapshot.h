@@ -0,0 +1,44 @@
+// BootSnapshot.h
+// Fast boot after a power cycle or reset, from state persisted on LittleFS
+// - Frame: the last composited FBFull plus what each region / the clock had pushed,
+//   so boot shows it at once (no clear) and partial updates continue from there
+// - Calendar: the provider's saveCache() blob (events + validators)
+// - Time: last NTP sync and a clock drift estimate; an RTC that kept running through
+//   the reset is trusted (drift-corrected), so boot need not wait for NTP
+// - Files carry magic, length and FNV-1a; written to a temp file, then renamed
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "Calendar.h"
+#include "Clock.h"
+#include "DirtyRegion.h"
+#include "Weather.h"
+
+// What the panel showed when the frame was saved
+struct BootState {
+  ClockState  clock;
+  DirtyRegion weather, calendar, plants;
+  bool        hasWeather{false};
+  WeatherData weatherData{};
+};
+
+// Mount LittleFS (formats an unformatted partition); false if persistence is unavailable
+bool snapshotBegin();
+
+// Frame + region state. Save skips the write if the frame did not change since the last save.
+bool snapshotSaveFrame(const uint8_t* fb, size_t n, const BootState& st);
+bool snapshotLoadFrame(uint8_t* fb, size_t n, BootState* st);
+
+// Provider cache; call from the task that owns the provider
+bool snapshotSaveCalendar(ICalendarProvider* cal);
+bool snapshotLoadCalendar(ICalendarProvider* cal);
+
+// Load the sync history and hook SNTP; call before configTime()
+void timeKeeperBegin();
+// True if the RTC kept the time through the reset; applies the drift correction
+bool timeKeeperRestore();
+// Persist the sync history if an NTP sync updated it (not from the SNTP callback: flash I/O)
+void timeKeeperSave();
+// Estimated clock drift in ppm (positive: the clock runs slow)
+float timeKeeperDriftPpm();
@@ -1,27 +1,63 @@
 // Calendar.h
 #pragma once
-#include <Arduino.h>
+#include <stdint.h>
 #include <time.h>
 
 struct CalItem {
   char title[40];
   char time[18];   // "HH:MM - HH:MM" needs 14 incl. NUL; give some headroom
+  time_t start;    // UTC; merge key when several providers feed one list
 };
 
+// Fixed-size fields: parsing an event never touches the heap
 struct CalendarEvent {
   time_t start{};
   time_t end{};
-  String summary;
-  String location;
+  char summary[48]{};
+  char location[40]{};
   bool cancelled{false};
 };
 
+// Network counters, e.g. to confirm connection reuse works
+struct CalNetStats {
+  uint32_t handshakes{0};   // fresh TLS connects
+  uint32_t reuses{0};       // requests on a kept-alive connection
+  uint32_t notModified{0};  // refreshes answered by 304
+};
+
+// refreshStep() progress
+enum class CalRefresh : uint8_t { Idle, Running, Done, Failed };
+
 class ICalendarProvider {
 public:
   virtual ~ICalendarProvider() {}
   virtual bool begin() = 0;
   virtual void setUrl(const char* url) = 0;
+  // Today's events (local day), start-sorted; refreshes from the network only when stale
   virtual int readToday(CalItem* out, int maxn) = 0;
+  // Events overlapping [fromUTC, toUTC), start-sorted, answered from the provider's cache
+  virtual int readRange(time_t fromUTC, time_t toUTC, CalItem* out, int maxn) = 0;
+  // Force a network refresh of the cache (normally driven by readToday's cadence)
+  virtual bool refresh() { return false; }
+  // Time-sliced refresh for single-core builds: starts one when the cache is stale (Idle
+  // if it is not), then does about budgetMs of work per call until Done or Failed.
+  // Queries in between answer from the cache that is still current.
+  virtual CalRefresh refreshStep(uint32_t budgetMs) { (void)budgetMs; return CalRefresh::Idle; }
+  // The next readToday()/refreshStep() would go to the network (callers wake WiFi only then)
+  virtual bool refreshDue() const { return true; }
+  virtual CalNetStats netStats() const { return CalNetStats(); }
+  // Cached events + validators as a flat blob (persisted across power cycles).
+  // out == nullptr returns the bytes needed; 0 when there is nothing worth saving.
+  virtual size_t saveCache(uint8_t* out, size_t cap) { (void)out; (void)cap; return 0; }
+  // Restore a saveCache() blob taken for the same URL(s); the next query answers from it
+  virtual bool loadCache(const uint8_t* in, size_t n) { (void)in; (void)n; return false; }
 };
 
 ICalendarProvider* makeIcsCalendarProvider(bool insecureTLS = true);
+
+// Several providers shown as one list: refreshes run concurrently (as many at once as
+// the heap allows for TLS sessions), results are merged by start time.
+// tags (optional, may be null or hold "") are prefixed to the titles of their source.
+// setUrl() on the composite takes a whitespace-separated list, one URL per source.
+ICalendarProvider* makeCompositeCalendarProvider(ICalendarProvider* const* sources,
+                                                 const char* const* tags, int n);
@@ -0,0 +1,321 @@
+// CalendarFeed.cpp
+// Binary event feed provider (format in CalendarFeed.h)
+// - One persistent HttpSession; GET <url>?since=<seq> once a generation is cached,
+//   the endpoint answers 304, a delta, or a full feed
+// - Records stream into the back cache, which is swapped in only after the checksum matched
+// - Delta: front events that no delta record names are carried over into the back cache
+// - Feed missing, foreign or corrupt: the fallback provider refreshes and answers reads;
+//   every refresh tries the feed again first
+// - saveCache/loadCache: whichever side answered last, tagged
+
+#include "CalendarFeed.h"
+#include "DateTimeFormatter.h"
+#include "EventCache.h"
+#include "Fnv1a.h"
+#include "HttpSession.h"
+#include "Metrics.h"
+#include "TimeZone.h"
+#include <WiFi.h>
+#include <string.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const size_t   kCacheEvents    = 256;     // cached events per buffer
+static const size_t   kCachePoolBytes = 6144;    // interned title bytes per buffer
+static const uint32_t kRefreshSec     = 15 * 60; // same cadence as the ICS provider
+static const uint32_t kMaxPayload     = 262144;  // larger feeds are refused as foreign
+static const int      kMaxDeltaKeys   = 128;     // records one delta may name; more asks for a full feed
+static const int      kDeltaMismatch  = -3;      // fetchFeed(): delta does not apply, fetch in full
+static const uint32_t kBlobMagic      = 0x46454431;  // "FED1": saveCache() layout
+
+// saveCache() layout: header, then the front EventCache blob or the fallback's blob
+struct FeedBlobHeader {
+  uint32_t magic;
+  uint32_t urlHash;
+  uint32_t seq;
+  uint8_t  fallback;  // 1: the rest is the fallback provider's blob
+  uint8_t  reserved[3];
+  int64_t  lastRefresh;
+};
+
+class FeedCalendarProvider : public ICalendarProvider {
+public:
+  FeedCalendarProvider(ICalendarProvider* fallback, bool insecure) : fallback_(fallback), session_(insecure) {}
+
+  bool begin() override {
+    time_t nowUTC; time(&nowUTC);
+    tzSetDevice(getenv("TZ"), nowUTC);
+    bool ok = cacheA_.begin(kCacheEvents, kCachePoolBytes) && cacheB_.begin(kCacheEvents, kCachePoolBytes);
+    if (!ok) DBG("[FEED] OOM event cache\n");
+    if (fallback_) ok = fallback_->begin() && ok;
+    return ok;
+  }
+
+  // The feed URL; the fallback keeps its own (set on it directly)
+  void setUrl(const char* url) override {
+    url_ = url ? String(url) : String();
+    seq_ = 0; front_->clear(0, 0);
+    lastRefresh_ = 0;
+  }
+
+  int readToday(CalItem* out, int maxn) override {
+    if (!out || maxn <= 0) return 0;
+    time_t nowUTC; time(&nowUTC);
+    tzSetDevice(getenv("TZ"), nowUTC);
+    if (nowUTC - lastRefresh_ >= (time_t)kRefreshSec) refresh();
+    return readRange(tzDayStartUTC(nowUTC), tzDayStartUTC(nowUTC, 1), out, maxn);
+  }
+
+  int readRange(time_t fromUTC, time_t toUTC, CalItem* out, int maxn) override {
+    if (!out || maxn <= 0) return 0;
+    if (onFallback()) return fallback_->readRange(fromUTC, toUTC, out, maxn);
+    const EventCache& c = *front_;
+    size_t first, last;
+    c.range(fromUTC, toUTC, &first, &last);
+    int n = 0;
+    for (size_t i = first; i < last && n < maxn; ++i) {
+      const CachedEvent& e = c.at(i);
+      if (!c.overlaps(e, fromUTC, toUTC)) continue;
+      toCalItem(e.start, c.endOf(e), c.title(e), out[n++]);
+    }
+    return n;
+  }
+
+  bool refresh() override {
+    time_t nowUTC; time(&nowUTC);
+    int r = fetchFeed();
+    if (r == kDeltaMismatch) { seq_ = 0; r = fetchFeed(); }
+    if (r >= 0) {
+      useFallback_ = false;
+      lastRefresh_ = nowUTC;
+      return true;
+    }
+    if (!fallback_) return false;
+    DBG("[FEED] feed unavailable, refreshing the fallback\n");
+    const bool ok = fallback_->refresh();
+    if (ok) { useFallback_ = true; lastRefresh_ = nowUTC; }
+    return ok;
+  }
+
+  // The feed is small: one step does the whole fetch; the fallback slices its own
+  CalRefresh refreshStep(uint32_t budgetMs) override {
+    if (fallbackStepping_) {
+      const CalRefresh r = fallback_->refreshStep(budgetMs);
+      if (r == CalRefresh::Running) return r;
+      fallbackStepping_ = false;
+      if (r == CalRefresh::Done) useFallback_ = true;
+      lastRefresh_ = time(nullptr);
+      return r;
+    }
+    time_t nowUTC; time(&nowUTC);
+    if (nowUTC - lastRefresh_ < (time_t)kRefreshSec) return CalRefresh::Idle;
+    int r = fetchFeed();
+    if (r == kDeltaMismatch) { seq_ = 0; r = fetchFeed(); }
+    if (r >= 0) { useFallback_ = false; lastRefresh_ = nowUTC; return CalRefresh::Done; }
+    if (!fallback_) { lastRefresh_ = nowUTC; return CalRefresh::Failed; }
+    fallbackStepping_ = true;
+    return CalRefresh::Running;
+  }
+
+  bool refreshDue() const override {
+    return fallbackStepping_ || time(nullptr) - lastRefresh_ >= (time_t)kRefreshSec;
+  }
+
+  CalNetStats netStats() const override {
+    CalNetStats st = fallback_ ? fallback_->netStats() : CalNetStats();
+    st.handshakes  += session_.stats().handshakes;
+    st.reuses      += session_.stats().reuses;
+    st.notModified += notModified_;
+    return st;
+  }
+
+  size_t saveCache(uint8_t* out, size_t cap) override {
+    const bool fb = onFallback();
+    const size_t hdr = sizeof(FeedBlobHeader);
+    const size_t body = fb ? fallback_->saveCache(nullptr, 0) : front_->exportTo(nullptr, 0);
+    if (!body) return 0;
+    if (!out) return hdr + body;
+    if (cap < hdr + body) return 0;
+    FeedBlobHeader h{ kBlobMagic, fnv1a(kFnv1aBasis, url_.c_str(), url_.length()), seq_,
+                      (uint8_t)fb, {0, 0, 0}, (int64_t)lastRefresh_ };
+    memcpy(out, &h, hdr);
+    const size_t n = fb ? fallback_->saveCache(out + hdr, cap - hdr) : front_->exportTo(out + hdr, cap - hdr);
+    return n ? hdr + n : 0;
+  }
+
+  bool loadCache(const uint8_t* in, size_t n) override {
+    FeedBlobHeader h;
+    if (!in || n < sizeof(h)) return false;
+    memcpy(&h, in, sizeof(h));
+    if (h.magic != kBlobMagic || h.urlHash != fnv1a(kFnv1aBasis, url_.c_str(), url_.length())) return false;
+    const uint8_t* body = in + sizeof(h);
+    const size_t len = n - sizeof(h);
+    if (h.fallback) {
+      if (!fallback_ || !fallback_->loadCache(body, len)) return false;
+      useFallback_ = true;
+    } else {
+      if (!front_->importFrom(body, len)) return false;
+      seq_ = h.seq;
+      useFallback_ = false;
+    }
+    lastRefresh_ = (time_t)h.lastRefresh;
+    DBG("[FEED] restored %s cache\n", h.fallback ? "fallback" : "feed");
+    return true;
+  }
+
+private:
+  struct Key { uint32_t uid, start; };
+
+  bool onFallback() const { return fallback_ && (useFallback_ || !front_->valid()); }
+
+  // Map a cached event to a UI row "HH:MM-HH:MM" + title
+  static void toCalItem(time_t startUTC, time_t endUTC, const char* title, CalItem& item) {
+    char hms[8], hme[8];
+    const long s = (long)(tzDevice().utcToLocal(startUTC) % 86400);
+    const long e = (long)(tzDevice().utcToLocal(endUTC > startUTC ? endUTC : startUTC) % 86400);
+    fmtHHMM(hms, sizeof(hms), (int)(s / 3600), (int)(s / 60 % 60));
+    fmtHHMM(hme, sizeof(hme), (int)(e / 3600), (int)(e / 60 % 60));
+    FmtOut(item.time, sizeof(item.time)).s(hms).c('-').s(hme).end();
+    FmtOut(item.title, sizeof(item.title)).u8(title, strlen(title)).end();  // cut on a UTF-8 boundary
+    item.start = startUTC;
+  }
+
+  // Exactly n body bytes into dst (checksummed); false on a short body or read error
+  bool readHashed(void* dst, size_t n) {
+    uint8_t* p = (uint8_t*)dst;
+    size_t got = 0;
+    while (got < n) {
+      const int r = session_.read(p + got, n - got);
+      if (r <= 0) return false;
+      got += (size_t)r;
+    }
+    hash_ = fnv1a(hash_, dst, n);
+    return true;
+  }
+
+  // Events added, -1 on any error, kDeltaMismatch when the delta does not fit the cache
+  int fetchFeed() {
+    if (WiFi.status() != WL_CONNECTED || url_.isEmpty()) return -1;
+    String u = url_;
+    const bool since = seq_ && front_->valid();
+    if (since) u += String(url_.indexOf('?') < 0 ? "?since=" : "&since=") + String(seq_);
+    if (!session_.begin(u)) return -1;
+    session_.http().setAcceptEncoding("identity");
+    const int code = session_.GET();
+    DBG("[FEED] GET since=%u code=%d\n", since ? (unsigned)seq_ : 0u, code);
+    if (code == 304 && since) { session_.end(); notModified_++; return (int)front_->count(); }
+    if (code != 200) { session_.end(); return -1; }
+
+    const uint32_t t0 = (uint32_t)micros();
+    const int n = readFeed();
+    session_.end();
+    metricsRecord(Phase::Transfer, (uint32_t)micros() - t0, bodyBytes_);
+    return n;
+  }
+
+  int readFeed() {
+    FeedHeader h;
+    bodyBytes_ = 0;
+    hash_ = kFnv1aBasis;
+    if (!readHashed(&h, sizeof(h))) return -1;
+    bodyBytes_ = sizeof(h);
+    // The checksum covers the header with its own field zeroed
+    const uint32_t sum = h.checksum;
+    h.checksum = 0;
+    hash_ = fnv1a(kFnv1aBasis, &h, sizeof(h));
+    if (h.magic != kFeedMagic || h.version != kFeedVersion || h.payloadBytes > kMaxPayload ||
+        h.windowEnd <= h.windowStart) {
+      DBG("[FEED] not a v%u feed (magic %08x version %u)\n", (unsigned)kFeedVersion, (unsigned)h.magic, (unsigned)h.version);
+      return -1;
+    }
+    const bool delta = (h.flags & kFeedDelta) != 0;
+    if (delta && (h.baseSeq != seq_ || !front_->valid())) return kDeltaMismatch;
+
+    back_->clear((time_t)h.windowStart, (time_t)h.windowEnd);
+    nKeys_ = 0;
+    uint32_t left = h.payloadBytes;
+    for (uint32_t i = 0; i < h.count; ++i) {
+      FeedRecord r;
+      if (left < sizeof(r) || !readHashed(&r, sizeof(r))) return -1;
+      left -= sizeof(r);
+      if (left < (uint32_t)r.titleLen + r.locationLen) return -1;
+      if (!readHashed(title_, r.titleLen) || !readHashed(location_, r.locationLen)) return -1;
+      left -= (uint32_t)r.titleLen + r.locationLen;
+
+      if (delta) {
+        if (nKeys_ >= kMaxDeltaKeys) return kDeltaMismatch;
+        keys_[nKeys_++] = Key{ r.uid, r.start };
+      }
+      if (r.flags & kRecDelete) continue;
+      // "Summary (Location)", cut at a UTF-8 boundary like the ICS titles
+      char row[sizeof(CalItem::title)];
+      FmtOut o(row, sizeof(row));
+      o.u8(title_, r.titleLen);
+      if (r.locationLen) o.s(" (").u8(location_, r.locationLen).c(')');
+      o.end();
+      back_->add((time_t)r.start, (time_t)r.end, row, (r.flags & kRecAllDay) ? kEvAllDay : 0, r.uid);
+    }
+    // Payload beyond the records: fields of a later minor revision, hashed and skipped
+    while (left) {
+      const uint32_t n = (left < sizeof(title_)) ? left : (uint32_t)sizeof(title_);
+      if (!readHashed(title_, n)) return -1;
+      left -= n;
+    }
+    bodyBytes_ += h.payloadBytes;
+    if (hash_ != sum) { DBG("[FEED] checksum mismatch, feed dropped\n"); return -1; }
+
+    if (delta) carryOver();
+    back_->finalize();
+    EventCache* t = front_; front_ = back_; back_ = t;
+    seq_ = h.seq;
+    DBG("[FEED] %s seq %u: %u records, cache %u events\n", delta ? "delta" : "full",
+        (unsigned)h.seq, (unsigned)h.count, (unsigned)front_->count());
+    return (int)front_->count();
+  }
+
+  // Base generation events inside the new window that the delta did not name
+  void carryOver() {
+    const EventCache& f = *front_;
+    for (size_t i = 0; i < f.count(); ++i) {
+      const CachedEvent& e = f.at(i);
+      if (!f.overlaps(e, back_->windowStart(), back_->windowEnd()) || named(e.uid, e.start)) continue;
+      back_->add((time_t)e.start, f.endOf(e), f.title(e), e.flags, e.uid);
+    }
+  }
+
+  bool named(uint32_t uid, uint32_t start) const {
+    for (int i = 0; i < nKeys_; ++i)
+      if (keys_[i].uid == uid && keys_[i].start == start) return true;
+    return false;
+  }
+
+  ICalendarProvider* fallback_;
+  String url_;
+  HttpSession session_;
+  uint32_t seq_{0};          // generation behind front_
+  uint32_t notModified_{0};
+  bool useFallback_{false};  // the last refresh came from the fallback
+  bool fallbackStepping_{false};
+
+  // Streaming state of one fetch
+  uint32_t hash_{0};
+  uint32_t bodyBytes_{0};
+  char     title_[256];
+  char     location_[256];
+  Key      keys_[kMaxDeltaKeys];
+  int      nKeys_{0};
+
+  // Double-buffered event cache: the feed lands in back_, swapped in once verified
+  EventCache  cacheA_;
+  EventCache  cacheB_;
+  EventCache* front_{&cacheA_};
+  EventCache* back_{&cacheB_};
+  time_t      lastRefresh_{0};
+};
+
+ICalendarProvider* makeFeedCalendarProvider(ICalendarProvider* fallback, bool insecureTLS) {
+  return new FeedCalendarProvider(fallback, insecureTLS);
+}
@@ -0,0 +1,47 @@
+// CalendarFeed.h
+// Wire format of the pre-digested event feed (companion endpoint) and its provider
+// - Little-endian; one FeedHeader, then `count` records: FeedRecord + title + location
+// - Records are already expanded (no RRULEs) and start-sorted for the window in the header
+// - checksum: FNV-1a over the header (checksum field zero) and the whole payload
+// - Delta (kFeedDelta): GET <url>?since=<seq> may answer with only what changed since
+//   baseSeq. Every record replaces the event with the same uid@start; kRecDelete
+//   records only remove it. Events of the base generation not named stay.
+// - The device streams records straight into its EventCache: no text scanning, no
+//   recurrence expansion
+#pragma once
+#include <stdint.h>
+#include "Calendar.h"
+
+static const uint32_t kFeedMagic   = 0x4656455A;  // "ZEVF"
+static const uint16_t kFeedVersion = 1;
+
+static const uint16_t kFeedDelta = 0x0001;  // FeedHeader::flags
+
+static const uint8_t kRecAllDay = 0x01;     // FeedRecord::flags
+static const uint8_t kRecDelete = 0x80;     // delta: remove uid@start, no new event
+
+struct FeedHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t flags;
+  uint32_t seq;           // generation of the event set this feed describes
+  uint32_t baseSeq;       // delta: generation it applies on top of (0 = full feed)
+  uint32_t windowStart;   // UTC span the records cover
+  uint32_t windowEnd;
+  uint32_t count;         // records
+  uint32_t payloadBytes;  // bytes after the header
+  uint32_t checksum;
+};
+
+struct FeedRecord {
+  uint32_t start, end;    // UTC epoch seconds
+  uint32_t uid;           // hash of the event UID; with start it keys an instance
+  uint8_t  flags;
+  uint8_t  titleLen;      // UTF-8 bytes following the record
+  uint8_t  locationLen;   // UTF-8 bytes following the title
+  uint8_t  reserved;
+};
+
+// Binary feed at setUrl(); while the feed cannot be fetched or does not verify, reads
+// and refreshes go to fallback (e.g. makeIcsCalendarProvider with the ICS link set)
+ICalendarProvider* makeFeedCalendarProvider(ICalendarProvider* fallback, bool insecureTLS = true);
@@ -1,310 +1,600 @@
 // CalendarICS.cpp
 // ICS-over-HTTPS calendar provider for ESP32 (Arduino)
-// - Fast on large ICS: tail fetch + early-exit once UI is filled
-// - Robust local time: converts UTC -> local via measured offset (no TZ propagation issues)
-// - Formats times as "HH:MM - HH:MM"
+// - Fast on large ICS: adaptive Range walk from the tail (learned window, 206 chunks
+//   backwards/forwards as needed) for feeds learned to be in start order without series;
+//   any other feed, or a server that ignores Range, gets one full (compressed) GET
+// - Parses into a 7-day EventCache; readToday/readRange answer from memory
+// - Bounded: a full cache keeps the earliest events; full bodies of feeds learned to be
+//   in start order stop at the first event past the window
+// - Expands RRULE/EXDATE/RECURRENCE-ID series into the cached window (IcsRecurrence)
+// - Local time from a precomputed DST table (TimeZone): device TZ plus the feed's VTIMEZONEs
+// - Conditional GET: remembers ETag/Last-Modified of the last clean parse, a 304 keeps the cached events
+// - saveCache/loadCache: cache + validators survive a power cycle, so boot answers from
+//   flash and the first refresh is usually a 304
+// - gzip/deflate on full-body GETs (Inflate); ranges stay identity so offsets are file offsets
+// - One persistent HttpSession: keep-alive between refreshes and the range steps
+// - Resumable fetch: the Range walk is a state machine, refreshStep() runs it in time
+//   slices on single-core builds; refresh() runs it to the end
+// - Allocation-free parse: IcsParser/IcsTokenizer work in fixed buffers, fields are fixed-size
+// - Formats times as "HH:MM-HH:MM" (DateTimeFormatter emitters, no printf)
 
 #include "Calendar.h"
+#include "DateTimeFormatter.h"
+#include "Fnv1a.h"
+#include "HttpSession.h"
+#include "IcsParser.h"
+#include "Inflate.h"
+#include "EventCache.h"
+#include "Metrics.h"
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
+#include <string.h>
 
 #ifndef DBG
   #define DBG(...) printf(__VA_ARGS__)
 #endif
 
 // ---- Tunables ----
-static const int     kUiNeededItems = 6;       // how many rows your UI normally shows
-static const size_t  kTailBytesTry  = 200000;  // first try: last ~200 KB of the ICS
-static const size_t  kLineBuf       = 1024;    // buffer for one physical line
-
-// ---- Portable timegm() (define early so we can use it everywhere) ----
-static time_t timegm_compat(struct tm *tm) {
-#if defined(__USE_BSD) || defined(_BSD_SOURCE) || defined(__USE_MISC)
-  return timegm(tm);
-#else
-  char *old_tz = getenv("TZ");
-  setenv("TZ", "", 1); tzset();
-  time_t t = mktime(tm);
-  if (old_tz) setenv("TZ", old_tz, 1); else unsetenv("TZ");
-  tzset();
-  return t;
-#endif
-}
+static const long    kTailBytesTry  = 200000;  // first try before a window has been learned
+static const long    kTailBytesMin  = 32768;   // learned window never shrinks below this
+static const long    kRangeChunk    = 131072;  // first backward step; doubles per step
+static const long    kRangeChunkMax = 1048576; // cap for one backward step
+static const int     kMaxRangeSteps = 24;      // extra range requests per refresh
+static const int     kMinWindowEvents = 1;     // sorted feed without series: walk back until this many
+static const int     kLookaheadDays = 7;       // days kept in the event cache
+static const uint32_t kRefreshSec   = 15 * 60; // network refresh cadence; queries in between hit the cache
+static const size_t  kCacheEvents   = 256;     // cached events per buffer
+static const size_t  kCachePoolBytes = 6144;   // interned title bytes per buffer
+static const bool    kAcceptCompressed = true; // ask for gzip/deflate when no Range is sent
+static const uint32_t kRevalidateEvery = 8;   // full parses: every n-th reads to EOF to re-check the feed order
+static const size_t  kParseSliceBytes = 2048;  // body bytes parsed between budget checks
+static const int     kNotModified   = -2;      // fetch result: server answered 304
+static const uint32_t kBlobMagic    = 0x49435032;  // "ICP2": saveCache() layout
 
 // ---- Small helpers ----
 
-// Unescape common ICS sequences (\, \n, \;)
-static String icsUnescape(const String& s) {
-  String o; o.reserve(s.length());
-  for (size_t i=0;i<s.length();++i) {
-    if (s[i]=='\\' && i+1<s.length()) {
-      char n = s[i+1];
-      if (n=='n' || n=='N') { o += ' '; i++; continue; }          // replace \n with space (single-line UI)
-      if (n=='\\' || n==',' || n==';') { o += n; i++; continue; } // unescape \\, \, and \;
-    }
-    o += s[i];
-  }
-  return o;
+// Format "HH:MM" local time for a UTC epoch (device zone table, no libc TZ state)
+static void fmtHHMM_local_fromUTC(char* out, size_t outsz, time_t tUTC) {
+  if (tUTC <= 0) { if (outsz) FmtOut(out, outsz).s("--:--").end(); return; }
+  const long sod = (long)(tzDevice().utcToLocal(tUTC) % 86400);  // seconds into the local day
+  fmtHHMM(out, outsz, (int)(sod / 3600), (int)(sod / 60 % 60));
 }
 
-// Compute local offset from UTC (seconds) without relying on TZ propagation in this TU.
-// offset = now_local_epoch - now_utc_epoch
-static long currentLocalOffsetSeconds() {
-  time_t now; time(&now);
-  struct tm localTm; localtime_r(&now, &localTm);
-  // Treat the local time struct as if it were UTC to recover the offset
-  time_t local_as_utc = timegm_compat(&localTm);
-  return (long)(local_as_utc - now);
-}
+// saveCache() layout: header, ETag, Last-Modified, EventCache blob of front_
+struct IcsBlobHeader {
+  uint32_t magic;
+  uint32_t urlHash;
+  int64_t  lastRefresh;
+  int32_t  tailBytes;
+  int32_t  feedBytes;
+  uint8_t  noRange, feedSorted, feedSeries;
+  uint16_t etagLen, lastModLen;
+};
+
+// "bytes <first>-<last>/<total>" from a 206; total is -1 for "/*"
+struct ContentRange {
+  long first{-1}, last{-1}, total{-1};
+};
 
-// Format "HH:MM" for a UTC epoch using our measured local offset (tz-agnostic)
-static void fmtHHMM_local_fromUTC(char* out, size_t outsz, time_t tUTC, long ofsSec) {
-  if (tUTC <= 0) { snprintf(out, outsz, "--:--"); return; }
-  time_t tl = tUTC + ofsSec;            // convert to local epoch
-  struct tm tmL; gmtime_r(&tl, &tmL);   // format via gmtime to avoid TZ dependency
-  snprintf(out, outsz, "%02d:%02d", tmL.tm_hour, tmL.tm_min);
+static bool parseContentRange(const String& h, ContentRange* cr) {
+  int sp = h.indexOf(' '), dash = h.indexOf('-'), slash = h.indexOf('/');
+  if (sp < 0 || dash < sp || slash < dash) return false;
+  cr->first = h.substring(sp + 1, dash).toInt();
+  cr->last  = h.substring(dash + 1, slash).toInt();
+  cr->total = (h.charAt(slash + 1) == '*') ? -1 : h.substring(slash + 1).toInt();
+  return cr->last >= cr->first;
 }
 
+// Response body as parser input; times the socket waits so parse time is the remainder
+class SessionSource : public IcsByteSource {
+public:
+  explicit SessionSource(HttpSession& s) : s_(s) {}
+  int read(uint8_t* dst, size_t n) override {
+    const uint32_t t0 = (uint32_t)micros();
+    int got = s_.read(dst, n);
+    waitUs += (uint32_t)micros() - t0;
+    return got;
+  }
+  uint32_t waitUs{0};
+
+private:
+  HttpSession& s_;
+};
+
 // ---- Provider implementation ----
 
 class IcsCalendarProvider : public ICalendarProvider {
 public:
-  explicit IcsCalendarProvider(bool insecure) : insecureTLS_(insecure) {}
+  explicit IcsCalendarProvider(bool insecure) : session_(insecure) {}
 
   bool begin() override {
-    // If TZ was set in the app, tzset() here helps when libc needs it per TU.
-    tzset();
-    return true;
+    time_t nowUTC; time(&nowUTC);
+    tzSetDevice(getenv("TZ"), nowUTC);
+    bool ok = cacheA_.begin(kCacheEvents, kCachePoolBytes) && cacheB_.begin(kCacheEvents, kCachePoolBytes);
+    if (!ok) DBG("[CAL] OOM event cache\n");
+    return ok;
   }
 
   void setUrl(const char* url) override {
     url_ = url ? String(url) : String();
+    // Validators and cached events belong to the old URL
+    etag_ = ""; lastModified_ = ""; front_->clear(0, 0);
+    tailBytes_ = kTailBytesTry; feedBytes_ = -1; noRange_ = false;
+    feedSorted_ = false; feedSeries_ = false; fullParses_ = 0;
   }
 
+  // Answered from the cache; the network is only touched when the cache is stale
   int readToday(CalItem* out, int maxn) override {
-    if (!out || maxn <= 0 || WiFi.status() != WL_CONNECTED || url_.isEmpty())
-      return 0;
+    if (!out || maxn <= 0) return 0;
 
-    tzset(); // try to honor app TZ if libc supports it; we still do offset math below
+    time_t nowUTC; time(&nowUTC);
+    tzSetDevice(getenv("TZ"), nowUTC);  // no-op unless TZ or the year changed
+    if (needsRefresh(nowUTC)) refresh();
 
-    // 1) Tail-first: newest events are typically near the end for Google ICS
-    int filled = fetchAndParse(out, maxn, /*useRangeTail=*/true);
-    if (filled >= 0) {
-      if (filled > 0) return filled;
+    return readRange(tzDayStartUTC(nowUTC), tzDayStartUTC(nowUTC, 1), out, maxn);
+  }
 
-      // 2) Fallback: full GET only if tail gave nothing (or not enough)
-      filled = fetchAndParse(out, maxn, /*useRangeTail=*/false);
-      return (filled < 0) ? 0 : filled;
+  int readRange(time_t fromUTC, time_t toUTC, CalItem* out, int maxn) override {
+    if (!out || maxn <= 0) return 0;
+    const EventCache& c = *front_;
+    size_t first, last;
+    c.range(fromUTC, toUTC, &first, &last);
+    int n = 0;
+    for (size_t i = first; i < last && n < maxn; ++i) {
+      const CachedEvent& e = c.at(i);
+      if (!c.overlaps(e, fromUTC, toUTC)) continue;
+      toCalItem(e.start, c.endOf(e), c.title(e), out[n++]);
     }
-    return 0;
+    return n;
   }
 
-private:
-  // Compare local calendar days via offsetted gmtime (tz-agnostic)
-  static bool isSameLocalDay(time_t aUTC, time_t bUTC, long ofsSec) {
-    auto dayKey = [&](time_t t)->long {
-      time_t tl = t + ofsSec;
-      struct tm tmL; gmtime_r(&tl, &tmL);
-      return (tmL.tm_year * 1000L + tmL.tm_yday);
-    };
-    return dayKey(aUTC) == dayKey(bUTC);
+  // Fetch the feed into the back cache and swap it in; a 304 keeps the current cache
+  bool refresh() override {
+    if (job_.st != Fetch::Idle || !refreshStart()) return false;
+    while (!fetchStep(UINT32_MAX)) {}
+    return refreshFinish();
   }
 
-  // Does [startUTC, endUTC] (or instant at startUTC if no end) overlap "today" in local time?
-  static bool spansToday(time_t startUTC, time_t endUTC, time_t refUTC, long ofsSec) {
-    // Build local day start/end for 'refUTC'
-    time_t tl = refUTC + ofsSec;
-    struct tm tmL; gmtime_r(&tl, &tmL);
-
-    struct tm d0 = tmL; d0.tm_hour = 0;  d0.tm_min = 0;  d0.tm_sec = 0;
-    struct tm d1 = tmL; d1.tm_hour = 23; d1.tm_min = 59; d1.tm_sec = 59;
+  CalRefresh refreshStep(uint32_t budgetMs) override {
+    if (job_.st == Fetch::Idle) {
+      time_t nowUTC; time(&nowUTC);
+      tzSetDevice(getenv("TZ"), nowUTC);
+      if (!needsRefresh(nowUTC)) return CalRefresh::Idle;
+      if (!refreshStart()) return CalRefresh::Failed;
+    }
+    if (!fetchStep(budgetMs)) return CalRefresh::Running;
+    return refreshFinish() ? CalRefresh::Done : CalRefresh::Failed;
+  }
 
-    // Convert local day start/end back to UTC epochs by reversing the offset
-    time_t dayStartLocalUTC = timegm_compat(&d0) - ofsSec;  // << fixed: use timegm_compat
-    time_t dayEndLocalUTC   = timegm_compat(&d1) - ofsSec;  // << fixed: use timegm_compat
+  bool refreshDue() const override {
+    if (job_.st != Fetch::Idle) return true;
+    time_t nowUTC; time(&nowUTC);
+    return !url_.isEmpty() && needsRefresh(nowUTC);
+  }
 
-    time_t eEnd = (endUTC > startUTC) ? endUTC : startUTC; // zero-duration events
-    return !(eEnd < dayStartLocalUTC || startUTC > dayEndLocalUTC);
+  CalNetStats netStats() const override {
+    CalNetStats st;
+    st.handshakes  = session_.stats().handshakes;
+    st.reuses      = session_.stats().reuses;
+    st.notModified = notModified_;
+    return st;
   }
 
-  // Parse DTSTART/DTEND variants:
-  // - "DTSTART:YYYYMMDDTHHMMSSZ"   (UTC)
-  // - "DTSTART;TZID=Europe/Berlin:YYYYMMDDTHHMMSS" (local)
-  // - "DTSTART;VALUE=DATE:YYYYMMDD" (all-day local)
-  static bool parseICSTime(const String& line, time_t* out) {
-    int colon = line.indexOf(':'); if (colon < 0) return false;
-
-    String meta = line.substring(0, colon);   // includes TZID/parameters if present
-    String v    = line.substring(colon+1); v.trim();
-
-    bool zulu = false;
-    if (v.length() && (v[v.length()-1]=='Z' || v[v.length()-1]=='z')) { zulu = true; v.remove(v.length()-1); }
-
-    int tpos = v.indexOf('T');
-
-    // All-day → treat as local midnight
-    if (tpos < 0) {
-      if (v.length() < 8) return false;
-      struct tm tmv{}; tmv.tm_year = v.substring(0,4).toInt() - 1900;
-      tmv.tm_mon  = v.substring(4,6).toInt() - 1;
-      tmv.tm_mday = v.substring(6,8).toInt();
-      tmv.tm_hour = 0; tmv.tm_min = 0; tmv.tm_sec = 0;
-      *out = mktime(&tmv); 
-      return (*out > 0);
-    }
+  size_t saveCache(uint8_t* out, size_t cap) override {
+    const size_t body = front_->exportTo(nullptr, 0);
+    if (!body) return 0;
+    const size_t need = sizeof(IcsBlobHeader) + etag_.length() + lastModified_.length() + body;
+    if (!out) return need;
+    if (cap < need) return 0;
+    IcsBlobHeader h{ kBlobMagic, fnv1a(url_.c_str()), (int64_t)lastRefresh_, (int32_t)tailBytes_,
+                     (int32_t)feedBytes_, noRange_, feedSorted_, feedSeries_,
+                     (uint16_t)etag_.length(), (uint16_t)lastModified_.length() };
+    uint8_t* p = out;
+    memcpy(p, &h, sizeof(h));                              p += sizeof(h);
+    memcpy(p, etag_.c_str(), h.etagLen);                   p += h.etagLen;
+    memcpy(p, lastModified_.c_str(), h.lastModLen);        p += h.lastModLen;
+    front_->exportTo(p, body);
+    return need;
+  }
 
-    if (tpos < 8) return false;
-    String d = v.substring(0, 8);
-    String t = v.substring(tpos+1);
+  bool loadCache(const uint8_t* in, size_t n) override {
+    IcsBlobHeader h;
+    if (!in || n < sizeof(h)) return false;
+    memcpy(&h, in, sizeof(h));
+    if (h.magic != kBlobMagic || h.urlHash != fnv1a(url_.c_str())) return false;
+    const size_t meta = sizeof(h) + h.etagLen + h.lastModLen;
+    if (n < meta || !front_->importFrom(in + meta, n - meta)) return false;
+
+    const char* p = (const char*)in + sizeof(h);
+    etag_ = ""; lastModified_ = "";
+    for (uint16_t i = 0; i < h.etagLen; ++i)    etag_ += p[i];
+    for (uint16_t i = 0; i < h.lastModLen; ++i) lastModified_ += p[h.etagLen + i];
+    lastRefresh_ = (time_t)h.lastRefresh;
+    tailBytes_ = h.tailBytes; feedBytes_ = h.feedBytes;
+    noRange_ = h.noRange; feedSorted_ = h.feedSorted; feedSeries_ = h.feedSeries;
+    DBG("[CAL] restored %u cached events\n", (unsigned)front_->count());
+    return true;
+  }
 
-    // Keep only digits from time and normalize to HHMMSS
-    String td; td.reserve(6);
-    for (int i=0;i<t.length();++i) if (t[i]>='0' && t[i]<='9') td += t[i];
-    while (td.length() < 6) td += '0';
-    if (td.length() > 6) td.remove(6);
+private:
+  enum class Fetch : uint8_t {
+    Idle, Tail, Body, Forward, BackwardStart, Backward, BackwardNext, Finish, AfterFull, Done
+  };
+
+  // Walk state kept between fetchStep() calls
+  struct FetchJob {
+    Fetch    st{Fetch::Idle};
+    Fetch    afterBody{Fetch::Idle};     // state once the open body is parsed
+    Fetch    afterForward{Fetch::Idle};  // state once Forward reached fwdEnd
+    bool     conditional{false};
+    bool     noRangePath{false};         // full body because the server ignores Range
+    bool     bodyLast{false};
+    time_t   nowUTC{0};                  // refresh start (becomes lastRefresh_)
+    long     lo{0}, hi{0}, total{-1};    // tail run and entity size
+    long     from{0}, boundary{0}, chunk{0};  // backward walk
+    long     fwdHi{0}, fwdEnd{0};        // run being continued: last byte parsed, end
+    int      steps{0};
+    int      result{-1};
+    uint32_t t0{0};
+    ContentRange   cr;
+    IcsByteSource* src{nullptr};
+    uint32_t bodyB0{0}, bodyUs{0};       // open body: parser bytes at its start, parse time
+    String   etag, lastModified;         // validators of the entity parsed; kept on success only
+  };
+
+  bool refreshStart() {
+    if (WiFi.status() != WL_CONNECTED || url_.isEmpty()) return false;
 
-    int YY = d.substring(0,4).toInt();
-    int MO = d.substring(4,6).toInt();
-    int DD = d.substring(6,8).toInt();
-    int HH = td.substring(0,2).toInt();
-    int MM = td.substring(2,4).toInt();
-    int SS = td.substring(4,6).toInt();
+    time_t nowUTC; time(&nowUTC);
+    tzSetDevice(getenv("TZ"), nowUTC);
+    // Validators are only worth sending while the cached window still covers the lookahead
+    fetchStart(*back_, tzDayStartUTC(nowUTC), tzDayStartUTC(nowUTC, kLookaheadDays), covers(*front_, nowUTC));
+    job_.nowUTC = nowUTC;
+    return true;
+  }
 
-    if (MO<1 || MO>12 || DD<1 || DD>31 || HH>23 || MM>59 || SS>60) return false;
+  bool refreshFinish() {
+    const int n = job_.result;
+    const time_t nowUTC = job_.nowUTC;
+    job_.st = Fetch::Idle;
+    if (n == kNotModified) {
+      DBG("[CAL] 304 not modified, keeping %u cached events\n", (unsigned)front_->count());
+      notModified_++;
+      lastRefresh_ = nowUTC;
+      return true;
+    }
+    if (n < 0) return false;
+
+    back_->finalize();
+    EventCache* t = front_; front_ = back_; back_ = t;
+    // Only a cleanly parsed body may answer later conditional GETs with 304
+    etag_         = job_.etag;
+    lastModified_ = job_.lastModified;
+    lastRefresh_ = nowUTC;
+    DBG("[CAL] cache %u events for %d days (%u dropped)\n",
+        (unsigned)front_->count(), kLookaheadDays, (unsigned)front_->dropped());
+    return true;
+  }
 
-    struct tm tmv{}; 
-    tmv.tm_year = YY - 1900; tmv.tm_mon = MO - 1; tmv.tm_mday = DD;
-    tmv.tm_hour = HH;         tmv.tm_min = MM;    tmv.tm_sec  = SS;
+  // Cache still answers the full lookahead from now?
+  static bool covers(const EventCache& c, time_t nowUTC) {
+    return c.valid() && c.windowStart() <= nowUTC &&
+           c.windowEnd() >= nowUTC + (kLookaheadDays - 1) * 86400L;
+  }
 
-    // If 'Z' present → UTC via timegm_compat(); else local via mktime()
-    *out = zulu ? timegm_compat(&tmv) : mktime(&tmv);
-    return (*out > 0);
+  bool needsRefresh(time_t nowUTC) const {
+    return !covers(*front_, nowUTC) || (nowUTC - lastRefresh_) >= (time_t)kRefreshSec;
   }
 
-  // Read one CRLF-terminated physical line into buf (without CRLF). Returns false on EOF.
-  static bool readPhysLine(Stream& s, char* buf, size_t bufsz) {
-    size_t n = s.readBytesUntil('\n', buf, bufsz - 1);
-    if (n == 0 && !s.available()) return false;
-    buf[n] = 0;
-    if (n>0 && buf[n-1]=='\r') buf[n-1] = 0;
-    return true;
+  // Map a cached event to a UI row "HH:MM-HH:MM" + title
+  static void toCalItem(time_t startUTC, time_t endUTC, const char* title, CalItem& item) {
+    char hms[8], hme[8];
+    fmtHHMM_local_fromUTC(hms, sizeof(hms), startUTC);
+    time_t endUse = (endUTC > startUTC) ? endUTC : startUTC;
+    fmtHHMM_local_fromUTC(hme, sizeof(hme), endUse);
+    FmtOut(item.time, sizeof(item.time)).s(hms).c('-').s(hme).end();
+    FmtOut(item.title, sizeof(item.title)).u8(title, strlen(title)).end();  // cut on a UTF-8 boundary
+    item.start = startUTC;
   }
 
-  // Read logical lines by folding continuation lines (leading space/tab), RFC 5545
-  template<typename Fn>
-  static void readLogicalLines(Stream& s, Fn onLine) {
-    char line[kLineBuf];
-    String logical; logical.reserve(256);
-    bool haveLogical = false;
-
-    while (readPhysLine(s, line, sizeof(line))) {
-      bool isCont = (line[0]==' ' || line[0]=='\t');
-      if (isCont) {
-        if (!haveLogical) { logical = String(line+1); haveLogical = true; }
-        else              { logical += (line+1); }
-      } else {
-        if (haveLogical) onLine(logical);
-        logical = String(line);
-        haveLogical = true;
-      }
+  // GET the feed, optionally for a byte range ("bytes=..."), and leave the body open.
+  // ifRange: only honor the range if the entity is unchanged (a changed feed answers 200).
+  int request(const String& range, bool conditional, bool ifRange, ContentRange* cr) {
+    if (!session_.begin(url_)) return -1;
+    HTTPClient& http = session_.http();
+    if (range.length()) http.addHeader("Range", range);
+    // A Range addresses bytes of the encoded body, so ranges are always fetched as identity
+    http.setAcceptEncoding((!range.length() && kAcceptCompressed && inflateOk_) ? "gzip, deflate" : "identity");
+    if (conditional) {
+      if (etag_.length())         http.addHeader("If-None-Match", etag_);
+      if (lastModified_.length()) http.addHeader("If-Modified-Since", lastModified_);
+    }
+    // If-Range pins the entity the walk started on, not the one behind front_
+    if (ifRange) {
+      if      (job_.etag.length())         http.addHeader("If-Range", job_.etag);
+      else if (job_.lastModified.length()) http.addHeader("If-Range", job_.lastModified);
     }
-    if (haveLogical) onLine(logical);
+
+    int code = session_.GET();
+    DBG("[CAL] GET %s code=%d\n", range.length() ? range.c_str() : "(full)", code);
+    if (code == 206 && !parseContentRange(http.header("Content-Range"), cr)) code = -1;
+    if (code != 200 && code != 206) { session_.end(); return code == 304 ? 304 : -1; }
+    if (code == 200) { *cr = ContentRange(); cr->first = 0; cr->total = http.getSize(); }
+    return code;
   }
 
-  // Core fetch+parse. If useRangeTail, send Range header to fetch only the tail.
-  // Returns number of UI items (0..maxn) or -1 on HTTP error.
-  int fetchAndParse(CalItem* out, int maxn, bool useRangeTail) {
-    WiFiClientSecure client; client.setTimeout(15000);
-    if (insecureTLS_) client.setInsecure();
+  static String byteRange(long first, long last) {
+    return String("bytes=") + String(first) + "-" + String(last);
+  }
 
-    HTTPClient http;
-    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-    http.setUserAgent("ESP32-EPD/1.0");
+  // ---- Resumable fetch: fetchStart(), then fetchStep() until it returns true ----
+  // Every stage of the walk below is one state; the parser keeps the partial VEVENT and
+  // line between slices, so a body can be parsed across any number of calls.
 
-    if (!http.begin(client, url_)) return -1;
+  void fetchStart(EventCache& dst, time_t winStart, time_t winEnd, bool conditional) {
+    parser_.beginWindow(&dst, winStart, winEnd);
+    job_ = FetchJob();
+    job_.conditional = conditional;
+    job_.t0 = millis();
+    job_.st = Fetch::Tail;
+  }
 
-    if (useRangeTail) {
-      http.addHeader("Range", String("bytes=-") + String(kTailBytesTry));
+  // Advance for about budgetMs; a request (connect + headers) is not sliced and can
+  // overrun it. True once done: job_.result holds events added, kNotModified or -1.
+  bool fetchStep(uint32_t budgetMs) {
+    const uint32_t t0 = millis();
+    while (job_.st != Fetch::Done) {
+      fetchAdvance();
+      if (job_.st != Fetch::Done && millis() - t0 >= budgetMs) return false;
     }
+    return true;
+  }
 
-    int code = http.GET();
-    DBG("[CAL] GET %s code=%d\n", useRangeTail ? "(tail)" : "(full)", code);
-    if (!(code == 200 || code == 206)) { http.end(); return -1; }
+  // Fill the window with as few bytes as the feed allows:
+  // 0) one full GET, compressed if the server offers that, when the server is known to
+  //    ignore Range or a count cannot end the walk (see rangeWalkPays())
+  // 1) suffix range of the learned window size
+  // 2) forward ranges if the server capped the reply short of EOF
+  // 3) backward ranges (growing) until the window has events or the file start is reached;
+  //    each ends at the earliest BEGIN:VEVENT already parsed, so the event cut by the
+  //    previous range start is re-read whole and nothing is parsed twice
+  // 4) once the steps run out, one full GET
+  // A 200 mid-walk means the feed changed (If-Range): start over from its full body.
+  void fetchAdvance() {
+    FetchJob& j = job_;
+    ContentRange& cr = j.cr;
+    switch (j.st) {
+      case Fetch::Tail: {
+        const bool walk = !noRange_ && rangeWalkPays();
+        const String tail = walk ? String("bytes=-") + String(tailBytes_) : String();
+        const int code = request(tail, j.conditional, false, &cr);
+        if (code == 304) { finishFetch(kNotModified); break; }
+        if (code < 0) { finishFetch(-1); break; }
+
+        // Validators describe the whole entity, so they are valid for ranges and full bodies alike
+        j.etag         = session_.http().header("ETag");
+        j.lastModified = session_.http().header("Last-Modified");
+
+        if (code == 200) {
+          // Asked for the full body, or the server ignores Range: compression pays most here
+          if (walk) { noRange_ = true; j.noRangePath = true; }
+          openFullBody();
+          break;
+        }
+        feedBytes_ = j.total = cr.total;
+        j.lo = cr.first;
+        j.fwdHi = cr.last;
+        j.fwdEnd = (cr.total > 0) ? cr.total : cr.last + 1;
+        j.afterForward = Fetch::BackwardStart;
+        parser_.beginRun(j.lo);
+        openBody(cr.total < 0 || cr.last + 1 >= cr.total, Fetch::Forward);
+        break;
+      }
 
-    Stream* s = http.getStreamPtr();
+      case Fetch::Body: {
+        const IcsStep st = parseSlice();
+        if (st == IcsStep::More) break;
+        closeBody();
+        // A cut or undecodable body leaves the window short: keep front_ and its validators
+        if (st == IcsStep::Error) { finishFetch(-1); break; }
+        j.st = j.afterBody;
+        break;
+      }
 
-    // Robust local offset (works even if TZ wasn't applied here)
-    const long ofs = currentLocalOffsetSeconds();
+      // Continue the run with adjacent ranges until [.., fwdEnd) is read
+      case Fetch::Forward: {
+        if (j.fwdHi + 1 >= j.fwdEnd) { j.st = j.afterForward; break; }
+        if (j.steps++ >= kMaxRangeSteps) { finishFetch(-1); break; }
+        const long want = j.fwdHi + 1;
+        const int code = request(byteRange(want, j.fwdEnd - 1), false, true, &cr);
+        if (code == 206 && cr.first != want) { session_.end(); finishFetch(-1); break; }
+        if (code == 200) { restartFromFull(); break; }
+        if (code != 206) { finishFetch(-1); break; }
+        j.fwdHi = cr.last;
+        openBody(cr.last + 1 >= j.fwdEnd, Fetch::Forward);
+        break;
+      }
 
-    // State for parsing
-    bool inEvent = false, inAlarm = false, cancelled = false;
-    CalendarEvent cur;
-    time_t nowUTC; time(&nowUTC);
+      case Fetch::BackwardStart:
+        j.hi = j.fwdHi;
+        j.boundary = (parser_.firstBegin() >= 0) ? parser_.firstBegin() : j.hi + 1;
+        j.chunk = kRangeChunk;
+        j.st = Fetch::Backward;
+        break;
+
+      case Fetch::Backward: {
+        if (j.lo <= 0 || parser_.filled() >= kMinWindowEvents) {
+          j.st = Fetch::Finish;
+          break;
+        }
+        if (j.steps++ >= kMaxRangeSteps) {
+          // Everything before j.lo may hold window events: the full body has them all
+          const int code = request(String(), false, false, &cr);
+          if (code == 200) { restartFromFull(); break; }
+          finishFetch(-1);
+          break;
+        }
+        j.from = (j.lo > j.chunk) ? j.lo - j.chunk : 0;
+        const int code = request(byteRange(j.from, j.boundary - 1), false, true, &cr);
+        if (code == 200) { restartFromFull(); break; }
+        if (code != 206 || cr.first != j.from) { if (code == 206) session_.end(); finishFetch(-1); break; }
+        j.fwdHi = cr.last;
+        j.fwdEnd = j.boundary;
+        j.afterForward = Fetch::BackwardNext;
+        parser_.beginRun(j.from);
+        openBody(cr.last + 1 >= j.boundary, Fetch::Forward);
+        break;
+      }
+
+      case Fetch::BackwardNext:
+        if (parser_.firstBegin() >= 0) j.boundary = parser_.firstBegin();
+        j.lo = j.from;
+        j.chunk = (j.chunk * 2 > kRangeChunkMax) ? kRangeChunkMax : j.chunk * 2;
+        j.st = Fetch::Backward;
+        break;
+
+      case Fetch::Finish: {
+        // Remember how much of the tail it took to find events, and start there next time
+        const long covered = ((j.total > 0) ? j.total : j.hi + 1) - j.lo;
+        if (parser_.filled() > 0) tailBytes_ = (covered > kTailBytesMin) ? covered : kTailBytesMin;
+        DBG("[CAL] parsed %u bytes (%ld of %ld, %d extra ranges) in %u ms\n",
+            (unsigned)parser_.stats().bytes, covered, feedBytes_, j.steps, (unsigned)(millis() - j.t0));
+        DBG("[CAL] window events=%d, next tail %ld bytes\n", parser_.filled(), tailBytes_);
+        finishFetch(parser_.filled());
+        break;
+      }
 
-    int filled = 0;
-
-    auto flushLogical = [&](const String& ln) {
-      // Skip alarms quickly
-      if (ln.startsWith("BEGIN:VALARM")) { inAlarm = true;  return; }
-      if (ln.startsWith("END:VALARM"))   { inAlarm = false; return; }
-      if (inAlarm) return;
-
-      if (ln == "BEGIN:VEVENT") { inEvent = true; cancelled = false; cur = CalendarEvent(); return; }
-      if (ln == "END:VEVENT") {
-        if (inEvent && !cancelled && cur.start > 0 && cur.summary.length()) {
-          if (spansToday(cur.start, cur.end, nowUTC, ofs)) {
-            // --- Map to UI item with "HH:MM - HH:MM"
-            char hms[8], hme[8];
-            fmtHHMM_local_fromUTC(hms, sizeof(hms), cur.start, ofs);
-            time_t endUse = (cur.end > cur.start) ? cur.end : cur.start;
-            fmtHHMM_local_fromUTC(hme, sizeof(hme), endUse, ofs);
-
-            snprintf(out[filled].time, sizeof(out[filled].time), "%s-%s", hms, hme);
-
-            String title = icsUnescape(cur.summary);
-            String loc   = icsUnescape(cur.location);
-            if (loc.length()) { title += " ("; title += loc; title += ")"; }
-
-            if ((int)sizeof(out[filled].title) <= (int)title.length())
-              title = title.substring(0, sizeof(out[filled].title) - 1);
-            strncpy(out[filled].title, title.c_str(), sizeof(out[filled].title));
-            out[filled].title[sizeof(out[filled].title)-1] = 0;
-
-            filled++;
-            // Early stop once UI is filled
-            if (filled >= maxn || filled >= kUiNeededItems) { /* stop via outer flag */ }
-          }
+      case Fetch::AfterFull: {
+        parser_.setEarlyExit(false);
+        const IcsParseStats& ps = parser_.stats();
+        if (!ps.stoppedEarly) {
+          feedSorted_ = ps.ordered;
+          feedSeries_ = ps.series > 0;
+          feedBytes_  = (long)ps.bytes;
+        } else if (ps.series > 0) {
+          // The parsed prefix already rules the range walk out; the order stays as learned
+          // (an early exit needs the prefix in order) until the next read to EOF
+          feedSeries_ = true;
         }
-        inEvent = false;
-        return;
+        DBG("[CAL] full body%s: %u bytes%s, window events=%d in %u ms\n",
+            j.noRangePath ? " (no range support)" : "",
+            (unsigned)ps.bytes, ps.stoppedEarly ? " (stopped past window)" : "",
+            parser_.filled(), (unsigned)(millis() - j.t0));
+        finishFetch(parser_.filled());
+        break;
       }
 
-      if (!inEvent) return;
+      case Fetch::Idle:
+      case Fetch::Done:
+        break;
+    }
+  }
+
+  void finishFetch(int result) {
+    job_.result = result;
+    job_.st = Fetch::Done;
+  }
 
-      if (ln.startsWith("DTSTART"))         parseICSTime(ln, &cur.start);
-      else if (ln.startsWith("DTEND"))      parseICSTime(ln, &cur.end);
-      else if (ln.startsWith("STATUS:"))    { if (ln.indexOf("CANCELLED") >= 0) cancelled = true; }
-      else if (ln.startsWith("SUMMARY:"))   cur.summary  = ln.substring(8);
-      else if (ln.startsWith("LOCATION:"))  cur.location = ln.substring(9);
-    };
+  // A suffix range is only worth its round trip when an event count can end the walk:
+  // the last complete parse found the feed in start order and without RRULE masters (a
+  // master sits at its first DTSTART, far ahead of the tail). Anything else, including a
+  // feed not parsed to the end yet, needs the full body anyway.
+  bool rangeWalkPays() const { return feedSorted_ && !feedSeries_; }
+
+  // A 200 body replaces the walk (feed changed, or the tail cannot settle the window)
+  void restartFromFull() {
+    job_.etag         = session_.http().header("ETag");
+    job_.lastModified = session_.http().header("Last-Modified");
+    parser_.restartWindow();
+    openFullBody();
+  }
 
-    bool stopEarly = false;
-    readLogicalLines(*s, [&](const String& l){
-      if (!stopEarly) {
-        flushLogical(l);
-        if (filled >= maxn || filled >= kUiNeededItems) stopEarly = true;
+  // The whole feed from offset 0. A feed last seen in start order is cut short once the
+  // window is passed (the unread rest of the body costs the keep-alive, not the transfer);
+  // every kRevalidateEvery-th full parse, the first one for a URL included, reads to the
+  // end to re-learn the order and series.
+  void openFullBody() {
+    parser_.setEarlyExit(feedSorted_ && (fullParses_++ % kRevalidateEvery) != 0);
+    parser_.beginRun(0);
+    openBody(true, Fetch::AfterFull);
+  }
+
+  // Parse the open response body into the current run (Body state), then go to next.
+  // last: the run ends with this body (flush the final line).
+  void openBody(bool last, Fetch next) {
+    job_.afterBody = next;
+    job_.bodyLast = last;
+    job_.src = &net_;
+    net_.waitUs = 0;
+    const ContentCoding cc = parseContentCoding(session_.http().header("Content-Encoding").c_str());
+    if (cc != ContentCoding::Identity) {
+      if (!inflate_.begin(&net_, cc)) {
+        // Skipping the body would swap an empty window in; fail, the retry asks for identity
+        DBG("[CAL] OOM inflate window, requesting identity from now on\n");
+        inflateOk_ = false;
+        session_.end();
+        finishFetch(-1);
+        return;
       }
-    });
+      job_.src = &inflate_;
+    }
+    job_.bodyB0 = parser_.stats().bytes;
+    job_.bodyUs = 0;
+    job_.st = Fetch::Body;
+  }
+
+  // One bounded slice of the open body; More until the body is used up
+  IcsStep parseSlice() {
+    const uint32_t t0 = (uint32_t)micros();
+    const IcsStep st = parser_.parseSome(*job_.src, job_.bodyLast, kParseSliceBytes);
+    job_.bodyUs += (uint32_t)micros() - t0;
+    if (st == IcsStep::Error) DBG("[CAL] body read/decode error\n");
+    return st;
+  }
 
-    http.end();
-    DBG("[CAL] ui filled=%d%s\n", filled, (useRangeTail && filled==0) ? " (tail empty, will fallback)" : "");
-    return filled;
+  // End the response and account its slices
+  void closeBody() {
+    const uint32_t bytes = parser_.stats().bytes - job_.bodyB0;
+    session_.end();
+    if (bytes) {
+      // Transfer counts wire bytes, parse counts decoded bytes (inflate time is part of parse)
+      const bool inflated = (job_.src == &inflate_);
+      const uint32_t wire = inflated ? inflate_.inBytes() : bytes;
+      metricsRecord(Phase::Transfer, net_.waitUs, wire);
+      metricsRecord(Phase::Parse, job_.bodyUs - net_.waitUs, bytes);
+      if (inflated) DBG("[CAL] inflated %u -> %u bytes\n", (unsigned)wire, (unsigned)bytes);
+    }
   }
 
 private:
   String url_;
-  bool insecureTLS_{true};
+  HttpSession session_;  // long-lived client: keep-alive across fetches
+  SessionSource net_{session_};  // body of the open response
+  FetchJob job_;
+
+  IcsParser parser_;  // parse working set, allocated once with the provider
+  uint32_t notModified_{0};
+
+  // Adaptive range state
+  long tailBytes_{kTailBytesTry};  // suffix size that last produced events
+  long feedBytes_{-1};             // entity size from Content-Range, -1 unknown
+  bool noRange_{false};            // server answered a suffix range with 200
+  bool feedSorted_{false};         // last complete parse saw VEVENTs in start order
+  bool feedSeries_{false};         // ... and RRULE masters among them
+  uint32_t fullParses_{0};
+
+  InflateSource inflate_;          // Content-Encoding stage, window kept between fetches
+  bool inflateOk_{true};           // false after the inflate window could not be allocated
+
+  // Conditional GET validators for the feed behind front_
+  String  etag_;
+  String  lastModified_;
+
+  // Double-buffered event cache: parse into back_, swap on success
+  EventCache  cacheA_;
+  EventCache  cacheB_;
+  EventCache* front_{&cacheA_};
+  EventCache* back_{&cacheB_};
+  time_t      lastRefresh_{0};
 };
 
 // Factory
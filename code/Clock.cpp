@@ -1,27 +1,29 @@
 // Clock.cpp
 #include "Clock.h"
-#include "GUI_Paint.h"
 #include "EPD.h"
 #include "fonts.h"
+#include "PanelRender.h"
+#include "MasterFrame.h"
+#include "EpdPush.h"
+#include "Metrics.h"
 #include <Arduino.h>
+#include <string.h>
 
-// Helper: draw string as monospace by placing each char in a fixed cell.
-// This avoids digit overlap/jitter on some font packs.
-static void drawMonospaceString(int x, int y, const char* s, const sFONT* font, int cellW) {
-  for (int i = 0; s[i]; ++i) {
-    char buf[2] = { s[i], 0 };
-    Paint_DrawString_EN(x + i*cellW, y, buf, (sFONT*)font, WHITE, BLACK);
-  }
-}
+// Widget layout (date line, monospace time cells): kClock* in PanelRender.h
+static const int kTimeX = kClockTimeX, kTimeY = kClockTimeY, kTimeCellW = kClockTimeCellW;
 
 class EpdClockWidget : public IClockWidget {
 public:
   EpdClockWidget(int x, int y, int w, int h, IDateTimeFormatter* fmt)
-  : _x(x), _y(y), _w(w), _h(h), _fmt(fmt) {}
+  : _x(x), _y(y), _w(w), _h(h), _fmt(fmt), _lastMinute(-1), _lastYday(-1), _dirty() {
+    _rowBytes = (_w + 7) / 8;
+    _date[0] = 0; _time[0] = 0;
+  }
 
   void begin() override {
     _lastMinute = -1;
     _lastYday   = -1;
+    _dirty.invalidate();  // begin() follows a clear or full refresh: always push
     // Optional: pre-draw empty box or keep your frame line. Clearing handled each update.
     updateNow(/*force*/true);
   }
@@ -34,36 +36,96 @@ public:
     }
   }
 
+  RegionStats stats() const override { return _dirty.stats(); }
+
+  ClockState saveState() const override {
+    ClockState st = ClockState();
+    st.lastMinute = _lastMinute; st.lastYday = _lastYday; st.dirty = _dirty;
+    memcpy(st.date, _date, sizeof(st.date));
+    memcpy(st.time, _time, sizeof(st.time));
+    return st;
+  }
+  void restoreState(const ClockState& st) override {
+    _lastMinute = st.lastMinute; _lastYday = st.lastYday; _dirty = st.dirty;
+    memcpy(_date, st.date, sizeof(_date));
+    memcpy(_time, st.time, sizeof(_time));
+  }
+
 private:
   void updateNow(bool force) {
     time_t now; time(&now);
     struct tm lt; localtime_r(&now, &lt);
 
     // Format strings
-    char dateStr[40];
-    char timeStr[16];
+    char dateStr[sizeof(_date)];
+    char timeStr[sizeof(_time)];
     _fmt->formatDate(dateStr, sizeof(dateStr), lt);
     _fmt->formatTime(timeStr, sizeof(timeStr), lt);
 
-    // Paint into the partial buffer region
-    Paint_SelectImage(_scratchForPartial()); // see comment below
-    Paint_NewImage(_scratchForPartial(), _w, _h, 0, WHITE);
-    Paint_Clear(WHITE);
+    const bool newDay = force || lt.tm_yday != _lastYday || strcmp(dateStr, _date) != 0;
+    _lastMinute = lt.tm_min;
+    _lastYday   = lt.tm_yday;
+    if (force) _dirty.invalidate();
+    if (!_dirty.needsPush(ContentHash().add(dateStr).add(timeStr).value())) return;
+
+    // Render the whole widget into its own buffer; only the changed part is pushed
+    UBYTE* buf = _canvas();
+    {
+      PhaseTimer t(Phase::RenderClock);
+      renderClock(buf, _w, _h, dateStr, timeStr);
+      masterFrameBlit(buf, _x, _y, _w, _h);
+    }
 
-    // Two lines: date (Font16), time (Font20), with monospace time
-    // date baseline y=2, time baseline y≈24 (tuned for your PRT_CLK_H)
-    Paint_DrawString_EN(4, 2, dateStr, &Font16, WHITE, BLACK);
+    if (masterFrameComposeOnly()) {
+      // Part of a full-frame composition: the caller pushes FBFull
+    } else if (newDay || buf == _scratchForPartial()) {
+      // Date line changed (once a day) or no private buffer: whole box.
+      // The push is asynchronous, so it goes out from a pool buffer, not the canvas.
+      UBYTE* out = epdPushAcquire();
+      memcpy(out, buf, (size_t)_rowBytes * _h);
+      epdPushSubmit(out, _x, _y, _x+_w, _y+_h);
+    } else {
+      pushChangedCells(timeStr);
+    }
+    memcpy(_date, dateStr, sizeof(_date));
+    memcpy(_time, timeStr, sizeof(_time));
+  }
 
-    // Use monospace draw to avoid glyph overlap issues in some font packs
-    // Choose a conservative cell width for Font20; tune if you want tighter spacing
-    const int cellW = 14;  // ~Font20 width per char on Waveshare packs; adjust if needed
-    drawMonospaceString(4, 22, timeStr, &Font20, cellW);
+  // Push the byte-aligned columns spanning every time cell that differs from _time.
+  // The controller ignores the low 3 bits of x, so widget column 0 sits at _x & ~7.
+  void pushChangedCells(const char* timeStr) {
+    const int nNew = (int)strlen(timeStr), nOld = (int)strlen(_time);
+    int first = -1, last = -1;
+    for (int i = 0; i < nNew || i < nOld; ++i) {
+      char c = (i < nNew) ? timeStr[i] : 0, p = (i < nOld) ? _time[i] : 0;
+      if (c == p) continue;
+      if (first < 0) first = i;
+      last = i;
+    }
+    if (first < 0) return;
 
-    // Push partial
-    EPD_7IN5_V2_Display_Part(_scratchForPartial(), _x, _y, _x+_w, _y+_h);
+    int b0 = (kTimeX + first * kTimeCellW) / 8;
+    int b1 = (kTimeX + (last + 1) * kTimeCellW + 7) / 8;
+    if (b1 > _rowBytes) b1 = _rowBytes;
+    const int x0 = (_x & ~7) + b0 * 8;
+    int x1 = (_x & ~7) + b1 * 8;
+    if (x1 % 256 == 0 && b1 < _rowBytes) { b1++; x1 += 8; }  // Display_Part sends x_end%256-1
+    const int r0 = kTimeY;
+    const int r1 = (kTimeY + Font20.Height < _h) ? kTimeY + Font20.Height : _h;
+    if (b0 >= b1 || r0 >= r1) return;
 
-    _lastMinute = lt.tm_min;
-    _lastYday   = lt.tm_yday;
+    // Gather the sub-rectangle into a pool buffer, rows packed tightly
+    UBYTE* out = epdPushAcquire();
+    const UBYTE* buf = _canvas();
+    const int n = b1 - b0;
+    for (int r = r0; r < r1; ++r) memcpy(out + (r - r0) * n, buf + r * _rowBytes + b0, n);
+    epdPushSubmit(out, x0, _y + r0, x1, _y + r1);
+  }
+
+  // Private canvas (kept between ticks so cells can be pushed alone); FBPart if allocation fails
+  UBYTE* _canvas() {
+    if (!_buf) _buf = (UBYTE*)malloc((size_t)_rowBytes * _h);
+    return _buf ? _buf : _scratchForPartial();
   }
 
   // We reuse the globally allocated partial framebuffer FBPart.
@@ -77,6 +139,11 @@ private:
   IDateTimeFormatter* _fmt;
   int _lastMinute;
   int _lastYday;
+  DirtyRegion _dirty;
+  int _rowBytes;
+  UBYTE* _buf = nullptr;
+  char _date[sizeof(ClockState::date)];  // what the panel shows
+  char _time[sizeof(ClockState::time)];
 };
 
 IClockWidget* makeEpdClockWidget(int x, int y, int w, int h, IDateTimeFormatter* fmt) {
@@ -2,16 +2,33 @@
 #pragma once
 #include <time.h>
 #include "DateTimeFormatter.h"
+#include "DirtyRegion.h"
+#include "Panel.h"
+
+// What the widget must remember across a deep sleep (kept in RTC memory by the caller).
+// Plain data, no initializers: see SleepState.
+struct ClockState {
+  int lastMinute;
+  int lastYday;
+  DirtyRegion dirty;
+  char date[40];  // strings on the panel, so the next tick pushes only changed cells
+  char time[16];
+};
 
 // Simple interface so you can swap renderers later if needed.
-class IClockWidget {
+// begin()/tick()/stats() come from IPanel; tick() only updates if minute/day changed.
+class IClockWidget : public IPanel {
 public:
-  virtual ~IClockWidget() {}
-  virtual void begin() = 0;
-  // Call frequently (e.g., each loop); it internally updates only if minute/day changed
-  virtual void tick() = 0;
+  // Carry the last rendered minute/day across a deep-sleep wakeup instead of begin()
+  virtual ClockState saveState() const {
+    ClockState st = ClockState();
+    st.lastMinute = st.lastYday = -1;
+    return st;
+  }
+  virtual void restoreState(const ClockState&) {}
 };
 
 // Create an EPD-backed clock widget that renders into a partial region.
-// It owns no buffers; it reuses your global FBPart via Paint_* APIs.
+// It keeps a small canvas of its own region and pushes only the changed time cells
+// (byte-aligned) through the EpdPush buffer pool; the date line is redrawn on a new day.
 IClockWidget* makeEpdClockWidget(int x, int y, int w, int h, IDateTimeFormatter* fmt);
@@ -0,0 +1,237 @@
+// CompositeCalendar.cpp
+// Several calendar providers behind one ICalendarProvider
+// - refresh(): one short-lived worker task per source, at most as many in flight as the
+//   heap has room for TLS sessions; the rest start as soon as one finishes (pipelined)
+// - refreshStep(): sequential, time-sliced by each source (single-core builds)
+// - Sources keep their own caches; reads merge their start-sorted rows (k-way merge)
+// - Optional per-source tag in front of each title ("W Standup")
+// - saveCache/loadCache concatenate the sources' blobs (length-prefixed)
+
+#include "Calendar.h"
+#include "TimeZone.h"
+#include <Arduino.h>
+#include <ctype.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const int      kMaxSources     = 4;
+static const int      kMaxRows        = 8;          // rows taken from each source per read
+static const int      kMaxParallel    = 3;          // refresh workers in flight at most
+static const uint32_t kSessionBytes   = 48 * 1024;  // heap one TLS fetch needs (handshake peak)
+static const uint32_t kBudgetMs       = 45000;      // no new worker starts after this
+static const uint32_t kRefreshSec     = 15 * 60;    // same cadence as the ICS provider
+static const uint32_t kWorkerStack    = 12288;
+static const size_t   kTagMax         = 8;
+static const uint32_t kBlobMagic      = 0x434D5031;  // "CMP1": saveCache() layout
+
+// saveCache() layout: header, then per source a uint32 length + that source's blob
+struct CompositeBlobHeader {
+  uint32_t magic;
+  uint32_t n;
+  int64_t  lastRefresh;
+};
+
+class CompositeCalendarProvider : public ICalendarProvider {
+public:
+  CompositeCalendarProvider(ICalendarProvider* const* sources, const char* const* tags, int n) {
+    n_ = (n < kMaxSources) ? n : kMaxSources;
+    for (int i = 0; i < n_; ++i) {
+      src_[i] = sources[i];
+      snprintf(tag_[i], sizeof(tag_[i]), "%s", (tags && tags[i]) ? tags[i] : "");
+    }
+    done_ = xSemaphoreCreateCounting(kMaxSources, 0);
+  }
+
+  bool begin() override {
+    bool ok = (done_ != nullptr);
+    for (int i = 0; i < n_; ++i) ok = src_[i]->begin() && ok;
+    return ok;
+  }
+
+  void setUrl(const char* urls) override {
+    // "url1 url2 ..." → one per source in order
+    const char* p = urls ? urls : "";
+    for (int i = 0; i < n_; ++i) {
+      while (*p && isspace((unsigned char)*p)) ++p;
+      const char* e = p;
+      while (*e && !isspace((unsigned char)*e)) ++e;
+      String one;
+      for (const char* c = p; c < e; ++c) one += *c;
+      src_[i]->setUrl(one.c_str());
+      p = e;
+    }
+    lastRefresh_ = 0;
+  }
+
+  int readToday(CalItem* out, int maxn) override {
+    if (!out || maxn <= 0) return 0;
+    time_t nowUTC; time(&nowUTC);
+    tzSetDevice(getenv("TZ"), nowUTC);
+    if (nowUTC - lastRefresh_ >= (time_t)kRefreshSec) refresh();
+
+    return readRange(tzDayStartUTC(nowUTC), tzDayStartUTC(nowUTC, 1), out, maxn);
+  }
+
+  // k-way merge of the sources' start-sorted rows
+  int readRange(time_t fromUTC, time_t toUTC, CalItem* out, int maxn) override {
+    if (!out || maxn <= 0) return 0;
+    int len[kMaxSources], head[kMaxSources];
+    const int take = (maxn < kMaxRows) ? maxn : kMaxRows;
+    for (int i = 0; i < n_; ++i) {
+      len[i] = src_[i]->readRange(fromUTC, toUTC, rows_[i], take);
+      if (len[i] < 0) len[i] = 0;
+      head[i] = 0;
+    }
+    int n = 0;
+    while (n < maxn) {
+      int best = -1;
+      for (int i = 0; i < n_; ++i) {
+        if (head[i] >= len[i]) continue;
+        if (best < 0 || rows_[i][head[i]].start < rows_[best][head[best]].start) best = i;
+      }
+      if (best < 0) break;
+      const CalItem& r = rows_[best][head[best]++];
+      out[n] = r;
+      if (tag_[best][0]) snprintf(out[n].title, sizeof(out[n].title), "%s %s", tag_[best], r.title);
+      n++;
+    }
+    return n;
+  }
+
+  // All sources at once within the memory and time budget; true if every source refreshed
+  bool refresh() override {
+    const uint32_t t0 = millis();
+    int par = (int)(ESP.getMaxAllocHeap() / kSessionBytes);
+    if (par > kMaxParallel) par = kMaxParallel;
+    if (par < 1) par = 1;
+
+    int next = 0, inFlight = 0;
+    bool allOk = true;
+    for (;;) {
+      while (inFlight < par && next < n_ && millis() - t0 < kBudgetMs) {
+        Worker& w = work_[next];
+        w.src = src_[next]; w.done = done_; w.ok = false;
+        if (par > 1 && xTaskCreatePinnedToCore(&CompositeCalendarProvider::worker, "calSrc", kWorkerStack,
+                                               &w, 1, nullptr, xPortGetCoreID()) == pdPASS) {
+          inFlight++;
+        } else {
+          w.ok = w.src->refresh();  // one session at a time: run it right here
+          allOk = allOk && w.ok;
+        }
+        next++;
+      }
+      if (inFlight == 0) break;
+      xSemaphoreTake(done_, portMAX_DELAY);  // workers always finish (HTTP has its own timeouts)
+      inFlight--;
+    }
+    for (int i = 0; i < next; ++i) allOk = allOk && work_[i].ok;
+    if (next < n_) { DBG("[CAL] budget spent, %d of %d sources refreshed\n", next, n_); allOk = false; }
+
+    lastRefresh_ = time(nullptr);
+    DBG("[CAL] %d sources refreshed in %u ms (%d in parallel)\n", next, (unsigned)(millis() - t0), par);
+    return allOk;
+  }
+
+  // Single core: the sources one after another, one source's slice per call
+  CalRefresh refreshStep(uint32_t budgetMs) override {
+    if (!stepping_) {
+      if (time(nullptr) - lastRefresh_ < (time_t)kRefreshSec) return CalRefresh::Idle;
+      stepping_ = true; stepAt_ = 0; stepOk_ = true;
+    }
+    if (stepAt_ < n_) {
+      const CalRefresh r = src_[stepAt_]->refreshStep(budgetMs);
+      if (r == CalRefresh::Running) return r;
+      stepOk_ = stepOk_ && r != CalRefresh::Failed;
+      if (++stepAt_ < n_) return CalRefresh::Running;
+    }
+    stepping_ = false;
+    lastRefresh_ = time(nullptr);
+    return stepOk_ ? CalRefresh::Done : CalRefresh::Failed;
+  }
+
+  bool refreshDue() const override {
+    return stepping_ || time(nullptr) - lastRefresh_ >= (time_t)kRefreshSec;
+  }
+
+  CalNetStats netStats() const override {
+    CalNetStats st;
+    for (int i = 0; i < n_; ++i) {
+      CalNetStats s = src_[i]->netStats();
+      st.handshakes += s.handshakes; st.reuses += s.reuses; st.notModified += s.notModified;
+    }
+    return st;
+  }
+
+  size_t saveCache(uint8_t* out, size_t cap) override {
+    size_t need = sizeof(CompositeBlobHeader);
+    for (int i = 0; i < n_; ++i) need += sizeof(uint32_t) + src_[i]->saveCache(nullptr, 0);
+    if (!out) return need;
+    if (cap < need) return 0;
+    CompositeBlobHeader h{ kBlobMagic, (uint32_t)n_, (int64_t)lastRefresh_ };
+    memcpy(out, &h, sizeof(h));
+    size_t at = sizeof(h);
+    for (int i = 0; i < n_; ++i) {
+      const uint32_t len = (uint32_t)src_[i]->saveCache(out + at + sizeof(len), cap - at - sizeof(len));
+      memcpy(out + at, &len, sizeof(len));
+      at += sizeof(len) + len;
+    }
+    return at;
+  }
+
+  bool loadCache(const uint8_t* in, size_t n) override {
+    CompositeBlobHeader h;
+    if (!in || n < sizeof(h)) return false;
+    memcpy(&h, in, sizeof(h));
+    if (h.magic != kBlobMagic || h.n != (uint32_t)n_) return false;
+    size_t at = sizeof(h);
+    bool all = true;
+    for (int i = 0; i < n_; ++i) {
+      uint32_t len;
+      if (n - at < sizeof(len)) return false;
+      memcpy(&len, in + at, sizeof(len));
+      at += sizeof(len);
+      if (n - at < len) return false;
+      all = (len && src_[i]->loadCache(in + at, len)) && all;
+      at += len;
+    }
+    // A source that did not restore makes the composite refresh on its next read
+    lastRefresh_ = all ? (time_t)h.lastRefresh : 0;
+    return all;
+  }
+
+private:
+  struct Worker {
+    ICalendarProvider* src;
+    SemaphoreHandle_t  done;
+    volatile bool      ok;
+  };
+
+  static void worker(void* arg) {
+    Worker* w = (Worker*)arg;
+    w->ok = w->src->refresh();
+    xSemaphoreGive(w->done);
+    vTaskDelete(nullptr);
+  }
+
+  int n_{0};
+  ICalendarProvider* src_[kMaxSources]{};
+  char    tag_[kMaxSources][kTagMax]{};
+  CalItem rows_[kMaxSources][kMaxRows];
+  Worker  work_[kMaxSources];
+  SemaphoreHandle_t done_{nullptr};
+  time_t  lastRefresh_{0};
+  bool    stepping_{false};  // refreshStep() in progress
+  bool    stepOk_{true};
+  int     stepAt_{0};        // source it is on
+};
+
+ICalendarProvider* makeCompositeCalendarProvider(ICalendarProvider* const* sources,
+                                                 const char* const* tags, int n) {
+  return new CompositeCalendarProvider(sources, tags, n);
+}
@@ -1,7 +1,13 @@
 // DateTimeFormatter.h
+// Clock and calendar strings without printf
+// - DateTimeFormatter<Locale, 24h>: locale and 12h/24h are template parameters, so every
+//   variant is its own straight-line code; makeFormatterStatic() picks one from gConfig
+// - Weekday/month names in constexpr tables, digits from two-digit emitters
+// - The date line changes at midnight: it is formatted once per tm_yday and copied after
 #pragma once
 #include <time.h>
-#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
 #include "AppConfig.h"
 
 class IDateTimeFormatter {
@@ -11,44 +17,112 @@ public:
   virtual void formatTime(char* out, size_t n, const struct tm& lt) const = 0;
 };
 
-class GermanDateTimeFormatter : public IDateTimeFormatter {
-public:
-  void formatDate(char* out, size_t n, const struct tm& lt) const override {
-    static const char* WD[] = {"Sonntag","Montag","Dienstag","Mittwoch","Donnerstag","Freitag","Samstag"};
-    // (Dienstag, 07.10.2025)
-    snprintf(out, n, "%s, %02d.%02d.%04d",
-             WD[lt.tm_wday], lt.tm_mday, lt.tm_mon+1, lt.tm_year+1900);
+// Bounded writer: appends while there is room, always NUL-terminated by end()
+struct FmtOut {
+  char* p;
+  char* last;  // slot reserved for the NUL
+
+  FmtOut(char* out, size_t n) : p(out), last(out + (n ? n - 1 : 0)) {}
+  FmtOut& c(char ch) { if (p < last) *p++ = ch; return *this; }
+  FmtOut& s(const char* str) { while (*str && p < last) *p++ = *str++; return *this; }
+  // UTF-8 text: stops before a sequence that would not fit whole
+  FmtOut& u8(const char* str, size_t n) {
+    for (size_t i = 0; i < n && str[i];) {
+      const unsigned char b = (unsigned char)str[i];
+      const size_t len = (b >= 0xF0) ? 4 : (b >= 0xE0) ? 3 : (b >= 0xC0) ? 2 : 1;
+      if (i + len > n || (size_t)(last - p) < len) break;
+      for (size_t k = 0; k < len; ++k) *p++ = str[i + k];
+      i += len;
+    }
+    return *this;
   }
-  void formatTime(char* out, size_t n, const struct tm& lt) const override {
-    // always 24h
-    snprintf(out, n, "%02d:%02d", lt.tm_hour, lt.tm_min);
+  FmtOut& d2(int v) { return c((char)('0' + v / 10 % 10)).c((char)('0' + v % 10)); }
+  FmtOut& sp2(int v) { return c(v >= 10 ? (char)('0' + v / 10 % 10) : ' ').c((char)('0' + v % 10)); }
+  FmtOut& d4(int v) { return d2(v / 100).d2(v % 100); }
+  void end() { *p = 0; }
+};
+
+// "HH:MM" in 24h (calendar rows, the 24h clock)
+inline void fmtHHMM(char* out, size_t n, int hour, int min) {
+  if (n < 1) return;
+  FmtOut(out, n).d2(hour).c(':').d2(min).end();
+}
+
+// ---- Locale tables ----
+
+static constexpr const char* kWeekdayDE[7] = {"Sonntag","Montag","Dienstag","Mittwoch","Donnerstag","Freitag","Samstag"};
+static constexpr const char* kWeekdayEN[7] = {"Sun","Mon","Tue","Wed","Thu","Fri","Sat"};
+static constexpr const char* kMonthEN[12]  = {"Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"};
+static constexpr const char* kWeekdayFR[7] = {"Dimanche","Lundi","Mardi","Mercredi","Jeudi","Vendredi","Samedi"};
+
+template <DateLocale L> struct DateLayout;
+
+template <> struct DateLayout<DateLocale::DE> {
+  // Dienstag, 07.10.2025
+  static void write(FmtOut& o, const struct tm& lt) {
+    o.s(kWeekdayDE[lt.tm_wday]).s(", ").d2(lt.tm_mday).c('.').d2(lt.tm_mon + 1).c('.').d4(lt.tm_year + 1900);
   }
 };
 
-class EnglishDateTimeFormatter : public IDateTimeFormatter {
+template <> struct DateLayout<DateLocale::EN> {
+  // Tue, 07 Oct 2025
+  static void write(FmtOut& o, const struct tm& lt) {
+    o.s(kWeekdayEN[lt.tm_wday]).s(", ").d2(lt.tm_mday).c(' ').s(kMonthEN[lt.tm_mon]).c(' ').d4(lt.tm_year + 1900);
+  }
+};
+
+template <> struct DateLayout<DateLocale::FR> {
+  // Mardi 07/10/2025
+  static void write(FmtOut& o, const struct tm& lt) {
+    o.s(kWeekdayFR[lt.tm_wday]).c(' ').d2(lt.tm_mday).c('/').d2(lt.tm_mon + 1).c('/').d4(lt.tm_year + 1900);
+  }
+};
+
+template <DateLocale L, bool H24>
+class DateTimeFormatter : public IDateTimeFormatter {
 public:
   void formatDate(char* out, size_t n, const struct tm& lt) const override {
-    static const char* WD[] = {"Sun","Mon","Tue","Wed","Thu","Fri","Sat"};
-    static const char* MO[] = {"Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"};
-    // e.g., Tue, 07 Oct 2025
-    snprintf(out, n, "%s, %02d %s %04d",
-             WD[lt.tm_wday], lt.tm_mday, MO[lt.tm_mon], lt.tm_year+1900);
+    if (n < 1) return;
+    if (lt.tm_yday != yday_ || lt.tm_year != year_) {
+      FmtOut o(date_, sizeof(date_));
+      DateLayout<L>::write(o, lt);
+      o.end();
+      yday_ = lt.tm_yday; year_ = lt.tm_year;
+    }
+    const size_t len = strnlen(date_, n - 1);
+    memcpy(out, date_, len);
+    out[len] = 0;
   }
+
   void formatTime(char* out, size_t n, const struct tm& lt) const override {
-    // 24h vs 12h based on gConfig
-    if (gConfig.use24h) {
-      snprintf(out, n, "%02d:%02d", lt.tm_hour, lt.tm_min);
+    if (n < 1) return;
+    if (H24) {
+      fmtHHMM(out, n, lt.tm_hour, lt.tm_min);
     } else {
-      int h = lt.tm_hour % 12; if (h == 0) h = 12;
-      snprintf(out, n, "%2d:%02d", h, lt.tm_min);
+      const int h = (lt.tm_hour % 12) ? lt.tm_hour % 12 : 12;
+      FmtOut(out, n).sp2(h).c(':').d2(lt.tm_min).end();
     }
   }
+
+private:
+  mutable char date_[40]{};
+  mutable int  yday_{-1}, year_{-1};
 };
 
+typedef DateTimeFormatter<DateLocale::DE, true> GermanDateTimeFormatter;   // always 24h
+typedef DateTimeFormatter<DateLocale::FR, true> FrenchDateTimeFormatter;   // always 24h
+typedef DateTimeFormatter<DateLocale::EN, true> EnglishDateTimeFormatter;
+typedef DateTimeFormatter<DateLocale::EN, false> English12hDateTimeFormatter;
+
 // Factory depending on config
 inline IDateTimeFormatter* makeFormatterStatic() {
   static GermanDateTimeFormatter de;
+  static FrenchDateTimeFormatter fr;
   static EnglishDateTimeFormatter en;
-  return (gConfig.dateLocale == DateLocale::DE) ? (IDateTimeFormatter*)&de
-                                                : (IDateTimeFormatter*)&en;
+  static English12hDateTimeFormatter en12;
+  switch (gConfig.dateLocale) {
+    case DateLocale::DE: return &de;
+    case DateLocale::FR: return &fr;
+    default:             return gConfig.use24h ? (IDateTimeFormatter*)&en : (IDateTimeFormatter*)&en12;
+  }
 }
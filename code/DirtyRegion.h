@@ -0,0 +1,51 @@
+// DirtyRegion.h
+// Content-hash dirty tracking for partial e-paper regions
+// - Each region hashes the data it is about to render (FNV-1a)
+// - Same hash as the last push: skip rendering, SPI transfer and panel refresh
+// - invalidate() after anything that overwrites the panel (full refresh, clear)
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// No member initializers here or in DirtyRegion: both sit in RTC memory (SleepState), which
+// must stay trivially constructible. Value-initialize (DirtyRegion()) for a zeroed one.
+struct RegionStats {
+  uint32_t pushes;
+  uint32_t skips;
+};
+
+// Incremental FNV-1a over the fields of a region's input.
+// Strings hash up to their NUL, so stale bytes behind it never count as a change.
+class ContentHash {
+public:
+  ContentHash& add(const void* p, size_t n) {
+    const uint8_t* b = (const uint8_t*)p;
+    for (size_t i = 0; i < n; ++i) { h_ ^= b[i]; h_ *= 16777619u; }
+    return *this;
+  }
+  ContentHash& add(const char* s) { return add(s, strlen(s) + 1); }
+  ContentHash& add(int v)         { return add(&v, sizeof(v)); }
+  uint32_t value() const { return h_; }
+
+private:
+  uint32_t h_{2166136261u};
+};
+
+class DirtyRegion {
+public:
+  // True if the panel needs this content; counts the push or the skip
+  bool needsPush(uint32_t hash) {
+    if (valid_ && hash == last_) { stats_.skips++; return false; }
+    last_ = hash; valid_ = true;
+    stats_.pushes++;
+    return true;
+  }
+  void invalidate() { valid_ = false; }
+  const RegionStats& stats() const { return stats_; }
+
+private:
+  uint32_t    last_;
+  bool        valid_;
+  RegionStats stats_;
+};
@@ -0,0 +1,13 @@
+// DisplayBackend.cpp
+#include "DisplayBackend.h"
+
+static IDisplayBackend* gBackend = nullptr;
+
+IDisplayBackend* gfx() {
+#ifdef ARDUINO
+  if (!gBackend) gBackend = makeWaveshareBackend();
+#endif
+  return gBackend;
+}
+
+void gfxSetBackend(IDisplayBackend* backend) { gBackend = backend; }
@@ -0,0 +1,63 @@
+// DisplayBackend.h
+// Everything the UI draws or pushes to the panel goes through one backend
+// - Drawing mirrors Paint_* (same arguments, same pixels) on the selected 1bpp image
+// - Panel calls mirror EPD_7IN5_V2_*
+// - No Waveshare headers here: colors, dot sizes, fills and line styles carry the Paint_*
+//   values under their own names, fonts are the font pack's sFONT (fonts.h); so the UI
+//   drawing builds on the host too
+// - Device: makeWaveshareBackend() (the default); host: makePbmBackend() (DisplayPbm.h)
+//   renders into memory and counts what each render touched
+#pragma once
+#include <stdint.h>
+
+typedef struct _tFont sFONT;  // fonts.h: glyph table + cell width/height
+
+// Paint_* colors (a white pixel is a set bit)
+static const uint16_t kGfxWhite = 0xFF;
+static const uint16_t kGfxBlack = 0x00;
+// FONT_BACKGROUND: text with this background draws its ink only
+static const uint16_t kGfxFontBackground = kGfxWhite;
+
+// DOT_PIXEL_1X1 .. DOT_PIXEL_8X8 are dot sizes 1 .. 8
+static const int kGfxDot1 = 1;
+
+enum class GfxFill  : uint8_t { Empty, Full };    // DRAW_FILL_EMPTY / DRAW_FILL_FULL
+enum class GfxStyle : uint8_t { Solid, Dotted };  // LINE_STYLE_SOLID / LINE_STYLE_DOTTED
+
+// The selected image as packed rows; plain = unrotated, unmirrored 1bpp, safe to write directly
+struct GfxCanvas {
+  uint8_t* image;
+  int      width, height;
+  int      rowBytes;
+  bool     plain;
+};
+
+enum class PanelMode : uint8_t { Full, Partial };
+
+class IDisplayBackend {
+public:
+  virtual ~IDisplayBackend() {}
+
+  // Draw into image from now on: w x h, unrotated, white background (Paint_NewImage)
+  virtual void select(uint8_t* image, int w, int h) = 0;
+  virtual GfxCanvas canvas() const = 0;
+  virtual void clear(uint16_t color) = 0;
+  virtual void line(int x0, int y0, int x1, int y1, uint16_t color, int dot, GfxStyle style) = 0;
+  virtual void rect(int x0, int y0, int x1, int y1, uint16_t color, int dot, GfxFill fill) = 0;
+  virtual void circle(int cx, int cy, int r, uint16_t color, int dot, GfxFill fill) = 0;
+  virtual void drawChar(int x, int y, char c, const sFONT* font, uint16_t bg, uint16_t fg) = 0;
+  virtual void drawString(int x, int y, const char* s, const sFONT* font, uint16_t bg, uint16_t fg) = 0;
+
+  virtual void panelInit(PanelMode mode) = 0;
+  virtual void panelClear() = 0;
+  virtual void panelShow(uint8_t* frame) = 0;
+  // Display_Part coordinates (end exclusive)
+  virtual void panelShowPart(uint8_t* buf, int x0, int y0, int x1, int y1) = 0;
+  virtual void panelSleep() = 0;
+};
+
+// Current backend; on the device the Waveshare one unless another was set
+IDisplayBackend* gfx();
+void gfxSetBackend(IDisplayBackend* backend);
+
+IDisplayBackend* makeWaveshareBackend();
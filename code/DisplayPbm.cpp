@@ -0,0 +1,225 @@
+// DisplayPbm.cpp
+#ifndef ARDUINO
+#include "DisplayPbm.h"
+#include "Raster1bpp.h"
+#include "fonts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class PbmBackend : public IDisplayBackend {
+public:
+  PbmBackend(int panelW, int panelH)
+  : pw_(panelW), ph_(panelH), prow_((panelW + 7) / 8) {
+    panel_ = (uint8_t*)malloc((size_t)prow_ * ph_);
+    if (panel_) memset(panel_, 0xFF, (size_t)prow_ * ph_);
+  }
+
+  void select(uint8_t* image, int w, int h) override {
+    img_ = image; w_ = (uint16_t)w; h_ = (uint16_t)h; rowBytes_ = (uint16_t)((w + 7) / 8);
+    stats_.selects++;
+  }
+  GfxCanvas canvas() const override {
+    GfxCanvas c{ img_, w_, h_, rowBytes_, true };
+    return c;
+  }
+  void clear(uint16_t color) override {
+    if (!img_) return;
+    memset(img_, (uint8_t)color, (size_t)rowBytes_ * h_);
+    stats_.clearedBytes += (uint32_t)rowBytes_ * h_;
+  }
+
+  // Paint_DrawLine: one error term, the step that keeps it smallest; 1x1 dots land at (x-1, y-1)
+  void line(int x0, int y0, int x1, int y1, uint16_t color, int dot, GfxStyle style) override {
+    if (raster_ && dot == kGfxDot1 && style == GfxStyle::Solid) { rasterLine(canvas(), x0, y0, x1, y1, color); return; }
+    const uint16_t xs = (uint16_t)x0, ys = (uint16_t)y0, xe = (uint16_t)x1, ye = (uint16_t)y1;
+    if (xs > w_ || ys > h_ || xe > w_ || ye > h_) return;
+    uint16_t x = xs, y = ys;
+    const int dx = (int)xe - (int)xs >= 0 ? xe - xs : xs - xe;
+    const int dy = (int)ye - (int)ys <= 0 ? ye - ys : ys - ye;
+    const int xAdd = xs < xe ? 1 : -1, yAdd = ys < ye ? 1 : -1;
+    int esp = dx + dy;
+    char dotted = 0;
+    for (;;) {
+      dotted++;
+      if (style == GfxStyle::Dotted && dotted % 3 == 0) {
+        point(x, y, kGfxWhite, dot);
+        dotted = 0;
+      } else {
+        point(x, y, color, dot);
+      }
+      if (2 * esp >= dy) {
+        if (x == xe) break;
+        esp += dy;
+        x += xAdd;
+      }
+      if (2 * esp <= dx) {
+        if (y == ye) break;
+        esp += dx;
+        y += yAdd;
+      }
+    }
+  }
+
+  // Paint_DrawRectangle: filled = one line per row, the last row (y1) left out
+  void rect(int x0, int y0, int x1, int y1, uint16_t color, int dot, GfxFill fill) override {
+    if (raster_ && dot == kGfxDot1) { rasterRect(canvas(), x0, y0, x1, y1, color, fill == GfxFill::Full); return; }
+    const uint16_t xs = (uint16_t)x0, ys = (uint16_t)y0, xe = (uint16_t)x1, ye = (uint16_t)y1;
+    if (xs > w_ || ys > h_ || xe > w_ || ye > h_) return;
+    if (fill == GfxFill::Full) {
+      for (uint16_t y = ys; y < ye; y++) line(xs, y, xe, y, color, dot, GfxStyle::Solid);
+    } else {
+      line(xs, ys, xe, ys, color, dot, GfxStyle::Solid);
+      line(xs, ys, xs, ye, color, dot, GfxStyle::Solid);
+      line(xe, ye, xe, ys, color, dot, GfxStyle::Solid);
+      line(xe, ye, xs, ye, color, dot, GfxStyle::Solid);
+    }
+  }
+
+  // Paint_DrawCircle: midpoint octants; filled = spans between the octant points
+  void circle(int cx, int cy, int r, uint16_t color, int dot, GfxFill fill) override {
+    if (raster_ && (dot == kGfxDot1 || fill == GfxFill::Full)) {
+      rasterCircle(canvas(), cx, cy, r, color, fill == GfxFill::Full);
+      return;
+    }
+    const uint16_t xc = (uint16_t)cx, yc = (uint16_t)cy;
+    if (xc > w_ || yc >= h_) return;
+    int16_t xi = 0, yi = (int16_t)(uint16_t)r;
+    int16_t esp = (int16_t)(3 - ((uint16_t)r << 1));
+    while (xi <= yi) {
+      if (fill == GfxFill::Full) {
+        for (int16_t s = xi; s <= yi; s++) octants(xc, yc, xi, s, color, kGfxDot1);
+      } else {
+        octants(xc, yc, xi, yi, color, dot);
+      }
+      if (esp < 0) {
+        esp += 4 * xi + 6;
+      } else {
+        esp += 10 + 4 * (xi - yi);
+        yi--;
+      }
+      xi++;
+    }
+  }
+
+  // Paint_DrawChar: font rows padded to whole bytes; opaque unless bg is kGfxFontBackground
+  void drawChar(int x, int y, char c, const sFONT* font, uint16_t bg, uint16_t fg) override {
+    const uint16_t xp = (uint16_t)x, yp = (uint16_t)y;
+    if (xp > w_ || yp > h_) return;
+    const uint32_t offset = (c - ' ') * font->Height * (font->Width / 8 + (font->Width % 8 ? 1 : 0));
+    const uint8_t* ptr = &font->table[offset];
+    for (uint16_t page = 0; page < font->Height; page++) {
+      for (uint16_t col = 0; col < font->Width; col++) {
+        if (*ptr & (0x80 >> (col % 8))) setPixel(xp + col, yp + page, fg);
+        else if (bg != kGfxFontBackground) setPixel(xp + col, yp + page, bg);
+        if (col % 8 == 7) ptr++;
+      }
+      if (font->Width % 8 != 0) ptr++;
+    }
+  }
+
+  // Paint_DrawString_EN: wrap at the right edge, back to the start at the bottom
+  void drawString(int x, int y, const char* s, const sFONT* font, uint16_t bg, uint16_t fg) override {
+    const uint16_t xs = (uint16_t)x, ys = (uint16_t)y;
+    if (xs > w_ || ys > h_) return;
+    uint16_t xp = xs, yp = ys;
+    for (; *s; ++s) {
+      if (xp + font->Width > w_)  { xp = xs; yp += font->Height; }
+      if (yp + font->Height > h_) { xp = xs; yp = ys; }
+      drawChar(xp, yp, *s, font, bg, fg);
+      xp += font->Width;
+    }
+  }
+
+  void panelInit(PanelMode) override {}
+  void panelClear() override {
+    if (panel_) memset(panel_, 0xFF, (size_t)prow_ * ph_);
+    stats_.fullPushes++;
+  }
+  void panelShow(uint8_t* frame) override {
+    if (panel_) memcpy(panel_, frame, (size_t)prow_ * ph_);
+    stats_.fullPushes++;
+  }
+  void panelShowPart(uint8_t* buf, int x0, int y0, int x1, int y1) override {
+    stats_.partPushes++;
+    if (!panel_ || x0 < 0 || y0 < 0 || x1 > pw_ || y1 > ph_ || x1 <= x0 || y1 <= y0) return;
+    const int bx0 = x0 / 8, bytes = (x1 + 7) / 8 - bx0;
+    for (int y = y0; y < y1; ++y)
+      memcpy(panel_ + (size_t)y * prow_ + bx0, buf + (size_t)(y - y0) * bytes, bytes);
+  }
+  void panelSleep() override {}
+
+  PbmStats stats_{};
+  bool raster_ = false;
+  uint8_t* panel_ = nullptr;
+  const int pw_, ph_, prow_;
+
+private:
+  // Paint_SetPixel (unrotated): the bounds test lets x == width / y == height through, as on
+  // the device; only writes past the end of the image are dropped here
+  void setPixel(uint16_t x, uint16_t y, uint16_t color) {
+    if (!img_ || x > w_ || y > h_) return;
+    const size_t addr = x / 8 + (size_t)y * rowBytes_;
+    if (addr >= (size_t)rowBytes_ * h_) return;
+    if (color == kGfxBlack) img_[addr] &= (uint8_t)~(0x80 >> (x % 8));
+    else                img_[addr] |= (uint8_t)(0x80 >> (x % 8));
+    stats_.pixelWrites++;
+  }
+
+  // Paint_DrawPoint, DOT_FILL_AROUND: a (2*dot-1)^2 square from (x-dot, y-dot)
+  void point(uint16_t x, uint16_t y, uint16_t color, int dot) {
+    if (x > w_ || y > h_) return;
+    for (int16_t dxi = 0; dxi < 2 * dot - 1; dxi++) {
+      for (int16_t dyi = 0; dyi < 2 * dot - 1; dyi++) {
+        if (x + dxi - dot < 0 || y + dyi - dot < 0) break;
+        setPixel(x + dxi - dot, y + dyi - dot, color);
+      }
+    }
+  }
+
+  void octants(uint16_t xc, uint16_t yc, int16_t a, int16_t b, uint16_t color, int dot) {
+    point(xc + a, yc + b, color, dot);
+    point(xc - a, yc + b, color, dot);
+    point(xc - b, yc + a, color, dot);
+    point(xc - b, yc - a, color, dot);
+    point(xc - a, yc - b, color, dot);
+    point(xc + a, yc - b, color, dot);
+    point(xc + b, yc - a, color, dot);
+    point(xc + b, yc + a, color, dot);
+  }
+
+  uint8_t* img_ = nullptr;
+  uint16_t  w_ = 0, h_ = 0, rowBytes_ = 0;
+};
+
+static PbmBackend* gPbm = nullptr;
+
+IDisplayBackend* makePbmBackend(int panelW, int panelH) {
+  if (!gPbm) gPbm = new PbmBackend(panelW, panelH);
+  return gPbm;
+}
+
+PbmStats pbmStats() { return gPbm ? gPbm->stats_ : PbmStats{}; }
+void pbmResetStats() { if (gPbm) gPbm->stats_ = PbmStats{}; }
+void pbmUseRaster(bool on) { if (gPbm) gPbm->raster_ = on; }
+const uint8_t* pbmPanel() { return gPbm ? gPbm->panel_ : nullptr; }
+
+bool pbmWritePanel(const char* path) {
+  return gPbm && gPbm->panel_ && pbmWrite(path, gPbm->panel_, gPbm->pw_, gPbm->ph_);
+}
+
+bool pbmWrite(const char* path, const uint8_t* image, int w, int h) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P4\n%d %d\n", w, h);
+  const int rowBytes = (w + 7) / 8;
+  uint8_t row[256];
+  bool ok = rowBytes <= (int)sizeof(row);
+  for (int y = 0; ok && y < h; ++y) {
+    // PBM: 1 = black
+    for (int i = 0; i < rowBytes; ++i) row[i] = (uint8_t)~image[(size_t)y * rowBytes + i];
+    ok = fwrite(row, 1, rowBytes, f) == (size_t)rowBytes;
+  }
+  return fclose(f) == 0 && ok;
+}
+#endif
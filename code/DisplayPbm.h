@@ -0,0 +1,32 @@
+// DisplayPbm.h
+// Host backend (not built for the device): renders into memory and writes PBM files
+// - Paint_*'s raster rules re-implemented pixel for pixel (bounds quirks included), so a
+//   dump matches what the device draws and can serve as a golden image
+// - Panel pushes land in a panel-sized frame: a full push replaces it, a partial one
+//   replaces its window (x taken down to a byte boundary, like the controller)
+// - pbmUseRaster(): the device's drawing path instead (1x1 solid strokes as Raster1bpp runs,
+//   the rest as above), to time it against the reference and prove both draw the same pixels
+// - Counters for benchmarks: pixel writes since the last reset, pushes per kind
+// - host/RenderBench.cpp (render_bench) times both paths per panel and compares the
+//   renders with the golden PBMs in host/golden
+#pragma once
+#include "DisplayBackend.h"
+
+struct PbmStats {
+  uint32_t pixelWrites;   // pixels set on the reference path (a pixel drawn twice counts twice)
+  uint32_t clearedBytes;  // bytes written by clear()
+  uint32_t selects;
+  uint32_t fullPushes, partPushes;
+};
+
+IDisplayBackend* makePbmBackend(int panelW, int panelH);
+
+// The backend made by makePbmBackend()
+PbmStats pbmStats();
+void pbmResetStats();
+void pbmUseRaster(bool on);  // off (the default): Paint_* reference rasterizer
+const uint8_t* pbmPanel();  // what the panel shows, rows of ceil(panelW/8) bytes
+bool pbmWritePanel(const char* path);
+
+// Binary PBM (P4) of a 1bpp image, 1 = white as in the framebuffers
+bool pbmWrite(const char* path, const uint8_t* image, int w, int h);
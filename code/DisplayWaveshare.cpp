@@ -0,0 +1,71 @@
+// DisplayWaveshare.cpp
+// Device backend: the Waveshare Paint_* / EPD_7IN5_V2_* library
+// - Plain images with 1x1 solid strokes go to the Raster1bpp runs (same pixels), the rest to Paint_*
+#ifdef ARDUINO
+#include "DisplayBackend.h"
+#include "GUI_Paint.h"
+#include "EPD.h"
+#include "Raster1bpp.h"
+
+static inline DOT_PIXEL toDot(int dot) { return (DOT_PIXEL)dot; }
+static inline DRAW_FILL toFill(GfxFill f) { return f == GfxFill::Full ? DRAW_FILL_FULL : DRAW_FILL_EMPTY; }
+static inline LINE_STYLE toStyle(GfxStyle s) { return s == GfxStyle::Dotted ? LINE_STYLE_DOTTED : LINE_STYLE_SOLID; }
+
+class WaveshareBackend : public IDisplayBackend {
+public:
+  void select(uint8_t* image, int w, int h) override {
+    Paint_SelectImage(image);
+    Paint_NewImage(image, w, h, ROTATE_0, WHITE);
+  }
+  GfxCanvas canvas() const override {
+    GfxCanvas c{ Paint.Image, Paint.Width, Paint.Height, Paint.WidthByte,
+                 Paint.Rotate == ROTATE_0 && Paint.Mirror == MIRROR_NONE && Paint.Scale == 2 };
+    return c;
+  }
+  void clear(uint16_t color) override {
+    const GfxCanvas c = canvas();
+    if (c.plain) rasterClear(c, color);
+    else         Paint_Clear(color);
+  }
+  void line(int x0, int y0, int x1, int y1, uint16_t color, int dot, GfxStyle style) override {
+    const GfxCanvas c = canvas();
+    if (c.plain && dot == kGfxDot1 && style == GfxStyle::Solid) rasterLine(c, x0, y0, x1, y1, color);
+    else Paint_DrawLine(x0, y0, x1, y1, color, toDot(dot), toStyle(style));
+  }
+  void rect(int x0, int y0, int x1, int y1, uint16_t color, int dot, GfxFill fill) override {
+    const GfxCanvas c = canvas();
+    if (c.plain && dot == kGfxDot1) rasterRect(c, x0, y0, x1, y1, color, fill == GfxFill::Full);
+    else Paint_DrawRectangle(x0, y0, x1, y1, color, toDot(dot), toFill(fill));
+  }
+  // A filled circle is drawn with 1x1 dots whatever the width
+  void circle(int cx, int cy, int r, uint16_t color, int dot, GfxFill fill) override {
+    const GfxCanvas c = canvas();
+    if (c.plain && (dot == kGfxDot1 || fill == GfxFill::Full))
+      rasterCircle(c, cx, cy, r, color, fill == GfxFill::Full);
+    else
+      Paint_DrawCircle(cx, cy, r, color, toDot(dot), toFill(fill));
+  }
+  void drawChar(int x, int y, char c, const sFONT* font, uint16_t bg, uint16_t fg) override {
+    Paint_DrawChar(x, y, c, (sFONT*)font, bg, fg);
+  }
+  void drawString(int x, int y, const char* s, const sFONT* font, uint16_t bg, uint16_t fg) override {
+    Paint_DrawString_EN(x, y, s, (sFONT*)font, bg, fg);
+  }
+
+  void panelInit(PanelMode mode) override {
+    if (mode == PanelMode::Partial) EPD_7IN5_V2_Init_Part();
+    else                            EPD_7IN5_V2_Init();
+  }
+  void panelClear() override { EPD_7IN5_V2_Clear(); }
+  void panelShow(uint8_t* frame) override { EPD_7IN5_V2_Display(frame); }
+  void panelShowPart(uint8_t* buf, int x0, int y0, int x1, int y1) override {
+    EPD_7IN5_V2_Display_Part(buf, x0, y0, x1, y1);
+  }
+  void panelSleep() override { EPD_7IN5_V2_Sleep(); }
+};
+
+IDisplayBackend* makeWaveshareBackend() {
+  static WaveshareBackend b;
+  return &b;
+}
+#endif
@@ -0,0 +1,172 @@
+// EpdPush.cpp
+#include "EpdPush.h"
+#include "AppConfig.h"
+#include "EPD.h"
+#include "DisplayBackend.h"
+#include "Metrics.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const int      kJobDepth  = kEpdPartBuffers + 2;  // uploads plus a refresh and a fence
+static const uint32_t kTaskStack = 3072;
+
+enum class JobKind : uint8_t { Upload, Refresh, Fence };
+
+struct PushJob {
+  JobKind kind;
+  UBYTE*  buf;             // Upload: buffer to send, back to the pool afterwards
+  int     x0, y0, x1, y1;  // Display_Part coordinates
+};
+
+static QueueHandle_t     gFree = nullptr;   // UBYTE* buffers ready to render into
+static QueueHandle_t     gJobs = nullptr;   // PushJob, in order
+static SemaphoreHandle_t gFenceDone = nullptr;
+static bool gBoxValid = false;              // uploaded, not yet refreshed (render side)
+static int  gBx0, gBy0, gBx1, gBy1;
+
+// ---- Controller access (same wire protocol as the Waveshare driver) ----
+
+static void sendCommand(UBYTE reg) {
+  DEV_Digital_Write(EPD_DC_PIN, 0);
+  DEV_Digital_Write(EPD_CS_PIN, 0);
+  DEV_SPI_WriteByte(reg);
+  DEV_Digital_Write(EPD_CS_PIN, 1);
+}
+
+static void sendData(UBYTE v) {
+  DEV_Digital_Write(EPD_DC_PIN, 1);
+  DEV_Digital_Write(EPD_CS_PIN, 0);
+  DEV_SPI_WriteByte(v);
+  DEV_Digital_Write(EPD_CS_PIN, 1);
+}
+
+static void waitUntilIdle() {
+  do { vTaskDelay(pdMS_TO_TICKS(5)); } while (!DEV_Digital_Read(EPD_BUSY_PIN));  // BUSY low = busy
+}
+
+// Enter partial mode with the window [x0, x1) x [y0, y1)
+static void partialWindow(int x0, int y0, int x1, int y1) {
+  sendCommand(0x50);  // VCOM / data interval: new data copied to old after a refresh
+  sendData(0xA9);
+  sendData(0x07);
+  sendCommand(0x91);  // partial in
+  sendCommand(0x90);  // partial window
+  sendData((UBYTE)(x0 / 256)); sendData((UBYTE)(x0 % 256));
+  sendData((UBYTE)((x1 - 1) / 256)); sendData((UBYTE)((x1 - 1) % 256));
+  sendData((UBYTE)(y0 / 256)); sendData((UBYTE)(y0 % 256));
+  sendData((UBYTE)((y1 - 1) / 256)); sendData((UBYTE)((y1 - 1) % 256));
+  sendData(0x01);
+}
+
+// Region data into the controller RAM only; the refresh comes once per batch
+static void upload(const PushJob& j) {
+  const int w = (j.x1 - j.x0 + 7) / 8, h = j.y1 - j.y0;
+  partialWindow(j.x0, j.y0, j.x1, j.y1);
+  sendCommand(0x13);
+  DEV_Digital_Write(EPD_DC_PIN, 1);
+  DEV_Digital_Write(EPD_CS_PIN, 0);  // one CS frame for the whole region
+  for (int i = 0; i < w * h; ++i) DEV_SPI_WriteByte((UBYTE)~j.buf[i]);
+  DEV_Digital_Write(EPD_CS_PIN, 1);
+  sendCommand(0x92);  // partial out
+}
+
+static void refresh(const PushJob& j) {
+  partialWindow(j.x0, j.y0, j.x1, j.y1);
+  sendCommand(0x12);
+  vTaskDelay(pdMS_TO_TICKS(100));
+  waitUntilIdle();
+  sendCommand(0x92);
+}
+
+static void pushTask(void*) {
+  PushJob j;
+  for (;;) {
+    if (xQueueReceive(gJobs, &j, portMAX_DELAY) != pdTRUE) continue;
+    const uint32_t t0 = (uint32_t)micros();
+    switch (j.kind) {
+      case JobKind::Upload:
+        upload(j);
+        xQueueSend(gFree, &j.buf, portMAX_DELAY);
+        metricsRecord(Phase::EpdPartial, (uint32_t)micros() - t0,
+                      (uint32_t)(((j.x1 - j.x0 + 7) / 8) * (j.y1 - j.y0)));
+        break;
+      case JobKind::Refresh:
+        refresh(j);
+        metricsRecord(Phase::EpdPartial, (uint32_t)micros() - t0);
+        break;
+      case JobKind::Fence:
+        xSemaphoreGive(gFenceDone);
+        break;
+    }
+  }
+}
+
+// ---- API ----
+
+bool epdPushBegin(size_t bufBytes) {
+  if (gFree) return true;
+  // Buffers are drawn into pixel by pixel: internal RAM first, PSRAM only as the fallback
+  const size_t total = bufBytes * kEpdPartBuffers;
+  UBYTE* arena = (UBYTE*)malloc(total);
+  if (!arena && psramFound()) arena = (UBYTE*)ps_malloc(total);
+  if (!arena) { DBG("[EPD] OOM partial buffers (%u bytes)\n", (unsigned)total); return false; }
+
+  gFree = xQueueCreate(kEpdPartBuffers, sizeof(UBYTE*));
+  for (int i = 0; i < kEpdPartBuffers; ++i) {
+    UBYTE* b = arena + i * bufBytes;
+    xQueueSend(gFree, &b, 0);
+  }
+#if EPD_PUSH_ASYNC
+  gJobs = xQueueCreate(kJobDepth, sizeof(PushJob));
+  gFenceDone = xSemaphoreCreateBinary();
+  if (xTaskCreatePinnedToCore(pushTask, "epdPush", kTaskStack, nullptr, 2, nullptr, 0) != pdPASS) {
+    DBG("[EPD] push task failed, blocking pushes\n");
+    gJobs = nullptr;
+  }
+#endif
+  return true;
+}
+
+UBYTE* epdPushAcquire() {
+  UBYTE* b = nullptr;
+  xQueueReceive(gFree, &b, portMAX_DELAY);
+  return b;
+}
+
+void epdPushSubmit(UBYTE* buf, int xStart, int yStart, int xEnd, int yEnd) {
+  if (!gJobs) {
+    PhaseTimer timer(Phase::EpdPartial);
+    gfx()->panelShowPart(buf, xStart, yStart, xEnd, yEnd);
+    xQueueSend(gFree, &buf, portMAX_DELAY);
+    return;
+  }
+  if (!gBoxValid) { gBx0 = xStart; gBy0 = yStart; gBx1 = xEnd; gBy1 = yEnd; gBoxValid = true; }
+  if (xStart < gBx0) gBx0 = xStart;
+  if (yStart < gBy0) gBy0 = yStart;
+  if (xEnd > gBx1) gBx1 = xEnd;
+  if (yEnd > gBy1) gBy1 = yEnd;
+  PushJob j{ JobKind::Upload, buf, xStart, yStart, xEnd, yEnd };
+  xQueueSend(gJobs, &j, portMAX_DELAY);
+}
+
+void epdPushRefresh() {
+  if (!gJobs || !gBoxValid) return;
+  PushJob j{ JobKind::Refresh, nullptr, gBx0 & ~7, gBy0, gBx1, gBy1 };
+  gBoxValid = false;
+  xQueueSend(gJobs, &j, portMAX_DELAY);
+}
+
+void epdPushFlush() {
+  if (!gJobs) return;
+  epdPushRefresh();  // never leave uploaded data unrefreshed behind a full update
+  PushJob j{ JobKind::Fence, nullptr, 0, 0, 0, 0 };
+  xQueueSend(gJobs, &j, portMAX_DELAY);
+  xSemaphoreTake(gFenceDone, portMAX_DELAY);
+}
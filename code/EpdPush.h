@@ -0,0 +1,28 @@
+// EpdPush.h
+// Pipelined partial pushes to the 7.5" V2 panel
+// - Pool of partial buffers carved from one arena (internal RAM, PSRAM if that does not fit)
+// - EPD_PUSH_ASYNC: a push task on core 0 uploads each submitted region into the
+//   controller RAM (window + data, no refresh) while the render loop draws the next one
+// - epdPushRefresh(): one partial refresh over the bounding box of every region uploaded
+//   since the last refresh, so a batch of dirty regions costs one panel update
+// - Without EPD_PUSH_ASYNC every submit is a blocking gfx()->panelShowPart
+// - Anything else that talks to the panel (full refresh, init, sleep) calls epdPushFlush() first
+#pragma once
+#include <stddef.h>
+#include "DEV_Config.h"
+
+// ---- Tunables ----
+static const int kEpdPartBuffers = 3;  // one being rendered, up to two queued/uploading
+
+// Allocate kEpdPartBuffers of bufBytes each and start the push task
+bool epdPushBegin(size_t bufBytes);
+
+// A free buffer to render into; blocks while every buffer is queued or uploading
+UBYTE* epdPushAcquire();
+// Hand a rendered buffer over (Display_Part coordinates); it returns to the pool once sent
+void epdPushSubmit(UBYTE* buf, int xStart, int yStart, int xEnd, int yEnd);
+
+// Refresh everything uploaded since the last refresh; returns without waiting for the panel
+void epdPushRefresh();
+// Wait until all uploads and refreshes are done
+void epdPushFlush();
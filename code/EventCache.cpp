@@ -0,0 +1,261 @@
+// EventCache.cpp
+#include "EventCache.h"
+#include "Fnv1a.h"
+#ifdef ARDUINO
+  #include <Arduino.h>
+#endif
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t kTitleMaxLen = 39;  // CalItem::title minus NUL
+static const uint32_t kBlobMagic = 0x45564331;  // "EVC1"
+
+// exportTo() layout: header, count_ events, poolUsed_ title bytes
+struct BlobHeader {
+  uint32_t magic;
+  uint32_t count;
+  uint32_t poolUsed;
+  uint32_t maxDurSec;
+  int64_t  winStart;
+  int64_t  winEnd;
+};
+
+static void* allocPreferPsram(size_t n) {
+#ifdef ARDUINO
+  void* p = psramFound() ? ps_malloc(n) : nullptr;
+  if (p) return p;
+#endif
+  return malloc(n);
+}
+
+EventCache::~EventCache() {
+  free(ev_); free(pool_); free(slots_); free(excl_);
+}
+
+bool EventCache::begin(size_t maxEvents, size_t poolBytes, size_t maxExclusions) {
+  if (ev_) return true;
+  if (poolBytes > 0xFFFF) poolBytes = 0xFFFF;  // 16-bit title offsets
+  slotCap_ = 1; while (slotCap_ < maxEvents * 2) slotCap_ <<= 1;
+
+  ev_    = (CachedEvent*)allocPreferPsram(sizeof(CachedEvent) * maxEvents);
+  pool_  = (char*)allocPreferPsram(poolBytes);
+  slots_ = (uint16_t*)allocPreferPsram(sizeof(uint16_t) * slotCap_);
+  excl_  = (Exclusion*)allocPreferPsram(sizeof(Exclusion) * (maxExclusions ? maxExclusions : 1));
+  if (!ev_ || !pool_ || !slots_ || !excl_) {
+    free(ev_); free(pool_); free(slots_); free(excl_);
+    ev_ = nullptr; pool_ = nullptr; slots_ = nullptr; excl_ = nullptr;
+    return false;
+  }
+  cap_ = maxEvents; poolCap_ = poolBytes; exclCap_ = maxExclusions;
+  clear(0, 0);
+  valid_ = false;
+  return true;
+}
+
+void EventCache::clear(time_t windowStart, time_t windowEnd) {
+  count_ = 0;
+  poolUsed_ = 1; if (pool_) pool_[0] = 0;
+  if (slots_) memset(slots_, 0, sizeof(uint16_t) * slotCap_);
+  exclCount_ = 0;
+  maxDurSec_ = 0;
+  winStart_ = windowStart; winEnd_ = windowEnd;
+  dropped_ = 0;
+  latest_ = (size_t)-1;
+  valid_ = false;
+}
+
+// Return the pool offset of s (truncated to the UI width), storing it on first sight.
+// A full pool is compacted once (evictions leave dead titles behind); if that is not
+// enough it degrades to the empty title rather than failing the event.
+uint16_t EventCache::intern(const char* s) {
+  size_t n = strnlen(s, kTitleMaxLen);
+  if (n == 0) return 0;
+
+  uint32_t h = fnv1a(s, n);
+  for (int pass = 0; pass < 2; ++pass) {
+    size_t mask = slotCap_ - 1;
+    size_t probes = 0;
+    for (size_t i = h & mask; probes < slotCap_; i = (i + 1) & mask, ++probes) {
+      uint16_t ofs = slots_[i];
+      if (ofs == 0) {
+        if (poolUsed_ + n + 1 > poolCap_) break;
+        ofs = (uint16_t)poolUsed_;
+        memcpy(pool_ + ofs, s, n); pool_[ofs + n] = 0;
+        poolUsed_ += n + 1;
+        slots_[i] = ofs;
+        return ofs;
+      }
+      if (strncmp(pool_ + ofs, s, n) == 0 && pool_[ofs + n] == 0) return ofs;
+    }
+    if (pass == 0 && !compactPool()) break;
+  }
+  return 0;
+}
+
+// Keep only titles live events point at: slide them down in pool order and rehash.
+// slots_ (>= 2 * cap_ entries) doubles as scratch for the old/new offset pairs.
+bool EventCache::compactPool() {
+  size_t k = 0;
+  for (size_t i = 0; i < count_; ++i) if (ev_[i].title) slots_[k++] = ev_[i].title;
+  std::sort(slots_, slots_ + k);
+  k = std::unique(slots_, slots_ + k) - slots_;
+
+  size_t used = 1;
+  for (size_t j = 0; j < k; ++j) {
+    const uint16_t from = slots_[j];
+    const size_t len = strlen(pool_ + from) + 1;
+    memmove(pool_ + used, pool_ + from, len);  // used <= from: ascending order never overwrites
+    slots_[k + j] = (uint16_t)used;
+    used += len;
+  }
+  if (used == poolUsed_) return false;  // nothing was dead
+  for (size_t i = 0; i < count_; ++i) {
+    if (!ev_[i].title) continue;
+    const size_t j = std::lower_bound(slots_, slots_ + k, ev_[i].title) - slots_;
+    ev_[i].title = slots_[k + j];
+  }
+
+  poolUsed_ = used;
+  rehash();
+  return true;
+}
+
+// Rebuild the intern table from the titles in pool_
+void EventCache::rehash() {
+  memset(slots_, 0, sizeof(uint16_t) * slotCap_);
+  const size_t mask = slotCap_ - 1;
+  for (size_t ofs = 1; ofs < poolUsed_; ofs += strlen(pool_ + ofs) + 1) {
+    size_t i = fnv1a(pool_ + ofs, strlen(pool_ + ofs)) & mask;
+    while (slots_[i]) i = (i + 1) & mask;
+    slots_[i] = (uint16_t)ofs;
+  }
+}
+
+// Index of the latest-starting entry; rescanned only after it was replaced
+size_t EventCache::latest() {
+  if (latest_ >= count_) {
+    latest_ = 0;
+    for (size_t i = 1; i < count_; ++i) if (ev_[i].start > ev_[latest_].start) latest_ = i;
+  }
+  return latest_;
+}
+
+bool EventCache::add(time_t startUTC, time_t endUTC, const char* title, uint8_t flags, uint32_t uid) {
+  if (cap_ == 0) return false;
+  uint32_t dur = (endUTC > startUTC) ? (uint32_t)(endUTC - startUTC) : 0;
+  uint32_t durMin = (dur + 59) / 60;
+  if (durMin > 0xFFFF) durMin = 0xFFFF;
+
+  size_t slot = count_;
+  if (count_ >= cap_) {
+    // Full: keep the earliest cap_ events whatever the feed order, evict the latest
+    dropped_++;
+    slot = latest();
+    if ((uint32_t)startUTC >= ev_[slot].start) return false;
+    latest_ = cap_;  // rescan on the next overflow
+    ev_[slot].title = 0;  // the evicted title is dead for a compaction in intern()
+  }
+  // Intern before the slot is counted: compactPool() walks ev_[0, count_) and must not see
+  // a fresh slot's uninitialized (or previous round's) title offset
+  const uint16_t titleOfs = intern(title ? title : "");
+  if (slot == count_) count_++;
+
+  CachedEvent& e = ev_[slot];
+  e.start = (uint32_t)startUTC;
+  e.durMin = (uint16_t)durMin;
+  e.title = titleOfs;
+  e.flags = flags;
+  e.reserved = 0;
+  e.uid = uid;
+  if (durMin * 60 > maxDurSec_) maxDurSec_ = durMin * 60;
+  return true;
+}
+
+void EventCache::excludeInstance(uint32_t uid, time_t startUTC) {
+  if (exclCount_ >= exclCap_) { dropped_++; return; }
+  excl_[exclCount_++] = Exclusion{ uid, (uint32_t)startUTC };
+}
+
+void EventCache::finalize() {
+  // Overrides and cancellations may come before or after their master in the feed
+  if (exclCount_) {
+    size_t w = 0;
+    for (size_t i = 0; i < count_; ++i) {
+      const CachedEvent& e = ev_[i];
+      bool drop = false;
+      if (e.flags & kEvRecurring)
+        for (size_t k = 0; k < exclCount_ && !drop; ++k)
+          drop = (excl_[k].uid == e.uid && excl_[k].start == e.start);
+      if (!drop) ev_[w++] = e;
+    }
+    count_ = w;
+  }
+  // Stable insertion sort: std::stable_sort would take a temporary buffer from the heap on
+  // every refresh; count_ is bounded by the cache size and feeds arrive mostly in order
+  for (size_t i = 1; i < count_; ++i) {
+    const CachedEvent e = ev_[i];
+    size_t j = i;
+    for (; j > 0 && ev_[j - 1].start > e.start; --j) ev_[j] = ev_[j - 1];
+    ev_[j] = e;
+  }
+  valid_ = true;
+}
+
+size_t EventCache::lowerBound(uint32_t t) const {
+  size_t lo = 0, hi = count_;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (ev_[mid].start < t) lo = mid + 1; else hi = mid;
+  }
+  return lo;
+}
+
+void EventCache::range(time_t fromUTC, time_t toUTC, size_t* first, size_t* last) const {
+  *first = *last = 0;
+  if (!valid_ || toUTC <= fromUTC) return;
+
+  // Anything starting before from - maxDur cannot reach into the range
+  uint32_t from = (uint32_t)fromUTC;
+  uint32_t scanFrom = (from > maxDurSec_) ? from - maxDurSec_ : 0;
+  size_t hi = lowerBound((uint32_t)toUTC);
+  size_t lo = lowerBound(scanFrom);
+
+  // Skip leading events already over before 'from'
+  while (lo < hi && !overlaps(ev_[lo], fromUTC, toUTC)) ++lo;
+  *first = lo; *last = hi;
+}
+
+size_t EventCache::exportTo(uint8_t* out, size_t cap) const {
+  if (!valid_) return 0;
+  const size_t need = sizeof(BlobHeader) + sizeof(CachedEvent) * count_ + poolUsed_;
+  if (!out) return need;
+  if (cap < need) return 0;
+  BlobHeader h{ kBlobMagic, (uint32_t)count_, (uint32_t)poolUsed_, maxDurSec_,
+                (int64_t)winStart_, (int64_t)winEnd_ };
+  memcpy(out, &h, sizeof(h));
+  memcpy(out + sizeof(h), ev_, sizeof(CachedEvent) * count_);
+  memcpy(out + sizeof(h) + sizeof(CachedEvent) * count_, pool_, poolUsed_);
+  return need;
+}
+
+bool EventCache::importFrom(const uint8_t* in, size_t n) {
+  clear(0, 0);
+  BlobHeader h;
+  if (!ev_ || !in || n < sizeof(h)) return false;
+  memcpy(&h, in, sizeof(h));
+  if (h.magic != kBlobMagic || h.count > cap_ || h.poolUsed < 1 || h.poolUsed > poolCap_) return false;
+  if (n != sizeof(h) + sizeof(CachedEvent) * h.count + h.poolUsed) return false;
+  const uint8_t* pool = in + sizeof(h) + sizeof(CachedEvent) * h.count;
+  if (pool[h.poolUsed - 1] != 0) return false;  // every title NUL-terminated
+
+  memcpy(ev_, in + sizeof(h), sizeof(CachedEvent) * h.count);
+  memcpy(pool_, pool, h.poolUsed);
+  for (size_t i = 0; i < h.count; ++i)
+    if (ev_[i].title >= h.poolUsed) { clear(0, 0); return false; }
+  count_ = h.count; poolUsed_ = h.poolUsed; maxDurSec_ = h.maxDurSec;
+  winStart_ = (time_t)h.winStart; winEnd_ = (time_t)h.winEnd;
+  rehash();
+  valid_ = true;
+  return true;
+}
@@ -0,0 +1,94 @@
+// EventCache.h
+// Compact, start-sorted event store covering a window of days (RAM or PSRAM)
+// - Packed records: UTC start + duration in minutes + offset of an interned title
+// - Bounded: on overflow the latest-starting entry is evicted, so the window keeps its earliest events
+// - Titles are truncated to the UI width and deduplicated (recurring meetings share one copy)
+// - Range queries by binary search on start, bounded look-back for long events
+// - Serializable (events + title pool) so a finalized cache survives a power cycle
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+struct CachedEvent {
+  uint32_t start;    // UTC epoch seconds
+  uint16_t durMin;   // duration in minutes (0 = instant)
+  uint16_t title;    // offset into the title pool
+  uint8_t  flags;    // kEvAllDay, ...
+  uint8_t  reserved;
+  uint32_t uid;      // hash of the UID, ties expanded instances to their overrides
+};
+
+static const uint8_t kEvAllDay     = 0x01;
+static const uint8_t kEvRecurring  = 0x02;  // expanded from an RRULE master
+
+class EventCache {
+public:
+  ~EventCache();
+
+  // Allocate storage once; prefers PSRAM when the board has it.
+  bool begin(size_t maxEvents, size_t poolBytes, size_t maxExclusions = 64);
+
+  // Start a rebuild for [windowStart, windowEnd)
+  void clear(time_t windowStart, time_t windowEnd);
+  // Add one event (any order). When full, the latest-starting event gives way to an
+  // earlier one, so the cache always holds the earliest events of the window.
+  // Returns false if the event was not kept.
+  bool add(time_t startUTC, time_t endUTC, const char* title, uint8_t flags, uint32_t uid = 0);
+  // Drop the expanded instance uid@startUTC (RECURRENCE-ID override/cancel), in any order vs. add()
+  void excludeInstance(uint32_t uid, time_t startUTC);
+  // Apply exclusions and sort by start; call once after the last add()
+  void finalize();
+
+  // Candidate indices [first, last) for [fromUTC, toUTC), start-sorted; filter with overlaps()
+  void range(time_t fromUTC, time_t toUTC, size_t* first, size_t* last) const;
+  // Half-open overlap; instants count at their start
+  bool overlaps(const CachedEvent& e, time_t fromUTC, time_t toUTC) const {
+    time_t s = (time_t)e.start;
+    return s < toUTC && (e.durMin ? endOf(e) > fromUTC : s >= fromUTC);
+  }
+
+  size_t count() const { return count_; }
+  const CachedEvent& at(size_t i) const { return ev_[i]; }
+  const char* title(const CachedEvent& e) const { return pool_ + e.title; }
+  time_t endOf(const CachedEvent& e) const { return (time_t)e.start + (time_t)e.durMin * 60; }
+
+  // Finalized cache as a flat blob; out == nullptr returns the bytes needed, 0 if not valid
+  size_t exportTo(uint8_t* out, size_t cap) const;
+  // Replace the contents with an exportTo() blob; false (cache left empty) if it does not fit
+  bool importFrom(const uint8_t* in, size_t n);
+
+  time_t windowStart() const { return winStart_; }
+  time_t windowEnd() const { return winEnd_; }
+  bool   valid() const { return valid_; }
+  uint32_t dropped() const { return dropped_; }
+
+private:
+  uint16_t intern(const char* s);
+  size_t   latest();
+  bool     compactPool();
+  void     rehash();
+  size_t   lowerBound(uint32_t t) const;
+
+  CachedEvent* ev_{nullptr};
+  size_t   cap_{0};
+  size_t   count_{0};
+
+  char*     pool_{nullptr};   // NUL-terminated titles, offset 0 is ""
+  size_t    poolCap_{0};
+  size_t    poolUsed_{0};
+  uint16_t* slots_{nullptr};  // open-addressing intern table: pool offset, 0 = empty
+  size_t    slotCap_{0};
+
+  struct Exclusion { uint32_t uid; uint32_t start; };
+  Exclusion* excl_{nullptr};
+  size_t    exclCap_{0};
+  size_t    exclCount_{0};
+
+  uint32_t maxDurSec_{0};     // longest event, bounds the look-back of range()
+  time_t   winStart_{0};
+  time_t   winEnd_{0};
+  bool     valid_{false};
+  uint32_t dropped_{0};
+  size_t   latest_{(size_t)-1};  // cached latest() while full, >= count_ = stale
+};
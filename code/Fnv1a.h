@@ -0,0 +1,24 @@
+// Fnv1a.h
+// 32-bit FNV-1a, the one hash behind event UIDs, the cache title table and cache keys
+// - Chainable: pass the previous value as h to hash a record in parts
+// - Header-only; the UID of a parsed event and the title intern table must never disagree
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint32_t kFnv1aBasis = 2166136261u;
+
+static inline uint32_t fnv1a(uint32_t h, const void* p, size_t n) {
+  const uint8_t* b = (const uint8_t*)p;
+  for (size_t i = 0; i < n; ++i) { h ^= b[i]; h *= 16777619u; }
+  return h;
+}
+
+static inline uint32_t fnv1a(const char* s, size_t n) { return fnv1a(kFnv1aBasis, s, n); }
+
+// NUL-terminated; null hashes like ""
+static inline uint32_t fnv1a(const char* s) {
+  uint32_t h = kFnv1aBasis;
+  while (s && *s) { h ^= (uint8_t)*s++; h *= 16777619u; }
+  return h;
+}
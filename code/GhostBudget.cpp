@@ -0,0 +1,74 @@
+// GhostBudget.cpp
+#include "GhostBudget.h"
+#include <stdio.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+static GhostRegion gRegions[kGhostMaxRegions];
+static int      gCount = 0;
+static uint32_t gLastFullS = 0;
+static uint32_t gCleansTotal = 0, gFullsTotal = 0;
+
+static bool overBudget(const GhostRegion& r) {
+  const uint32_t area = (uint32_t)(r.w * r.h);
+  return r.partials >= kGhostMaxPartials || r.flipped >= kGhostFlipAreas * area;
+}
+
+int ghostAddRegion(const char* name, int x, int y, int w, int h) {
+  if (gCount >= kGhostMaxRegions || w <= 0 || h <= 0) return -1;
+  gRegions[gCount] = GhostRegion{ name, x, y, w, h, 0, 0, 0 };
+  return gCount++;
+}
+
+void ghostNote(int x, int y, uint32_t flipped) {
+  if (!flipped) return;  // an unchanged pixel is not driven by the partial waveform
+  for (int i = 0; i < gCount; ++i) {
+    GhostRegion& r = gRegions[i];
+    if (x < r.x || y < r.y || x >= r.x + r.w || y >= r.y + r.h) continue;
+    r.partials++;
+    r.flipped += flipped;
+    return;
+  }
+}
+
+GhostAction ghostNext(uint32_t nowS, int* region) {
+  if (nowS - gLastFullS >= kGhostFullMaxAgeS) return GhostAction::Full;
+  int worst = -1;
+  for (int i = 0; i < gCount; ++i) {
+    const GhostRegion& r = gRegions[i];
+    if (!overBudget(r)) continue;
+    if (r.cleans >= kGhostMaxCleans) return GhostAction::Full;
+    if (worst < 0 || r.partials > gRegions[worst].partials) worst = i;
+  }
+  if (worst < 0) return GhostAction::None;
+  if (region) *region = worst;
+  return GhostAction::CleanRegion;
+}
+
+const GhostRegion& ghostRegion(int i) { return gRegions[i]; }
+
+void ghostCleaned(int region) {
+  if (region < 0 || region >= gCount) return;
+  GhostRegion& r = gRegions[region];
+  r.partials = r.flipped = 0;
+  r.cleans++;
+  gCleansTotal++;
+}
+
+void ghostFullDone(uint32_t nowS) {
+  for (int i = 0; i < gCount; ++i) gRegions[i].partials = gRegions[i].flipped = gRegions[i].cleans = 0;
+  gLastFullS = nowS;
+  gFullsTotal++;
+}
+
+void ghostDump() {
+  DBG("[EPD] ghost: %u full, %u local cleanups;", (unsigned)gFullsTotal, (unsigned)gCleansTotal);
+  for (int i = 0; i < gCount; ++i) {
+    const GhostRegion& r = gRegions[i];
+    DBG(" %s=%u/%u%%/%u", r.name, (unsigned)r.partials,
+        (unsigned)(100ULL * r.flipped / ((uint64_t)r.w * r.h)), (unsigned)r.cleans);
+  }
+  DBG(" (partials/flipped/cleans)\n");
+}
@@ -0,0 +1,41 @@
+// GhostBudget.h
+// Ghosting bookkeeping for partial refreshes, per screen region
+// - Regions are fixed rectangles; every partial render reports the pixels it flipped
+//   (MasterFrame diffs it against FBFull) and counts as one partial refresh
+// - A region over its budget (partials or flipped pixels per area) asks for a local
+//   cleanup: inverse + normal partial refresh of just that box
+// - A region cleaned kGhostMaxCleans times, or kGhostFullMaxAgeS without a full
+//   refresh, asks for one full refresh instead; a full refresh resets every region
+// - Bookkeeping only: the caller decides when to act (quiet window) and does the pushes
+#pragma once
+#include <stdint.h>
+
+// ---- Tunables ----
+static const int      kGhostMaxRegions  = 6;
+static const uint32_t kGhostMaxPartials = 120;   // partial refreshes of one region between cleanups
+static const uint32_t kGhostFlipAreas   = 4;     // flipped pixels between cleanups, in region areas
+static const uint32_t kGhostMaxCleans   = 3;     // local cleanups before a full refresh is due
+static const uint32_t kGhostFullMaxAgeS = 6 * 3600;  // full refresh at least this often
+
+enum class GhostAction : uint8_t { None, CleanRegion, Full };
+
+struct GhostRegion {
+  const char* name;
+  int      x, y, w, h;
+  uint32_t partials;   // partial refreshes that changed pixels, since the last cleanup
+  uint32_t flipped;    // pixels changed since the last cleanup
+  uint32_t cleans;     // local cleanups since the last full refresh
+};
+
+// Returns the region index, or -1 when the table is full
+int ghostAddRegion(const char* name, int x, int y, int w, int h);
+// A partial render at (x, y) changed flipped pixels; charged to the region containing the point
+void ghostNote(int x, int y, uint32_t flipped);
+
+// What is due now (monotonic seconds); *region is set for CleanRegion
+GhostAction ghostNext(uint32_t nowS, int* region);
+const GhostRegion& ghostRegion(int i);
+void ghostCleaned(int region);
+void ghostFullDone(uint32_t nowS);
+
+void ghostDump();
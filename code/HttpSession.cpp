@@ -0,0 +1,180 @@
+// HttpSession.cpp
+#include "HttpSession.h"
+#include "Metrics.h"
+#include <WiFi.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const uint32_t kIoTimeoutMs = 15000;  // max wait for the next body byte
+
+// Response headers any user of the session may need (HTTPClient keeps one list per client)
+static const char* kCollectHeaders[] = { "ETag", "Last-Modified", "Transfer-Encoding", "Content-Range",
+                                    "Content-Encoding", "Cache-Control" };
+
+// Split "https://host[:port]/path" into host + port
+static bool parseHostPort(const String& url, String& host, uint16_t& port) {
+  int scheme = url.indexOf("://");
+  if (scheme < 0) return false;
+  port = url.startsWith("https") ? 443 : 80;
+  int hs = scheme + 3;
+  int slash = url.indexOf('/', hs);
+  String hp = (slash < 0) ? url.substring(hs) : url.substring(hs, slash);
+  int colon = hp.indexOf(':');
+  if (colon >= 0) { port = (uint16_t)hp.substring(colon + 1).toInt(); hp = hp.substring(0, colon); }
+  host = hp;
+  return host.length() > 0;
+}
+
+HttpSession::HttpSession(bool insecureTLS) {
+  client_.setTimeout(15000);
+  if (insecureTLS) client_.setInsecure();
+  http_.setReuse(true);  // HTTP/1.1 keep-alive
+  http_.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+  http_.setUserAgent("ESP32-EPD/1.0");
+}
+
+bool HttpSession::begin(const String& url) {
+  String host; uint16_t port;
+  if (!parseHostPort(url, host, port)) return false;
+  if (host != host_ || port != port_) dropConnection();  // never reuse a socket for another origin
+  url_ = url; host_ = host; port_ = port;
+
+  if (!connectIfNeeded()) return false;
+  if (!http_.begin(client_, url_)) return false;
+  http_.collectHeaders(kCollectHeaders, sizeof(kCollectHeaders) / sizeof(kCollectHeaders[0]));
+  return true;
+}
+
+// Own the connect so we can count handshakes; HTTPClient then finds the socket
+// already connected and sends the request on it.
+bool HttpSession::connectIfNeeded() {
+  if (client_.connected()) {
+    // Leftovers from a previous response would be parsed as the next status line
+    while (client_.available() > 0) client_.read();
+    reused_ = true;
+    return true;
+  }
+  client_.stop();
+  reused_ = false;
+  {
+    // Resolve up front so DNS and the handshake are timed apart (connect() then hits the lwIP cache)
+    PhaseTimer t(Phase::Dns);
+    IPAddress ip;
+    WiFi.hostByName(host_.c_str(), ip);
+  }
+  {
+    PhaseTimer t(Phase::TlsHandshake);
+    if (!client_.connect(host_.c_str(), port_)) {
+      DBG("[HTTP] connect %s:%u failed\n", host_.c_str(), port_);
+      return false;
+    }
+  }
+  stats_.handshakes++;
+  return true;
+}
+
+void HttpSession::dropConnection() {
+  if (client_.connected()) stats_.drops++;
+  client_.stop();
+}
+
+int HttpSession::GET() {
+  const uint32_t t0 = (uint32_t)micros();
+  int code = http_.GET();
+  if (code < 0 && reused_) {
+    // Server closed the idle connection underneath us: one clean retry on a fresh handshake
+    DBG("[HTTP] reused connection failed (%d), reconnecting\n", code);
+    http_.end();
+    dropConnection();
+    if (!connectIfNeeded() || !http_.begin(client_, url_)) return code;
+    http_.collectHeaders(kCollectHeaders, sizeof(kCollectHeaders) / sizeof(kCollectHeaders[0]));
+    code = http_.GET();
+  } else if (code >= 0 && reused_) {
+    stats_.reuses++;
+  }
+  // Request sent to status line + headers parsed (includes a retry handshake, if any)
+  if (code > 0) metricsRecord(Phase::FirstByte, (uint32_t)micros() - t0);
+
+  String te = http_.header("Transfer-Encoding");
+  chunked_   = te.indexOf("chunked") >= 0;
+  remaining_ = chunked_ ? -1 : http_.getSize();
+  chunkLeft_ = 0;
+  // 304 and 204 never carry a body; errors keep theirs unread and end() closes the socket
+  bodyDone_  = (code == 304 || code == 204 || (!chunked_ && remaining_ == 0));
+  return code;
+}
+
+// Wait for at least one byte (or close/timeout), then take what is buffered
+int HttpSession::readRaw(uint8_t* dst, size_t n) {
+  uint32_t t0 = millis();
+  for (;;) {
+    int a = client_.available();
+    if (a > 0) return client_.read(dst, (size_t)a < n ? (size_t)a : n);
+    if (!client_.connected()) return 0;
+    if (millis() - t0 > kIoTimeoutMs) return -1;
+    delay(1);
+  }
+}
+
+int HttpSession::readByte() {
+  uint8_t b;
+  return (readRaw(&b, 1) == 1) ? b : -1;
+}
+
+// "<hex>[;ext]\r\n" → chunkLeft_; a zero chunk also consumes the (empty) trailer
+bool HttpSession::readChunkHeader() {
+  size_t len = 0; bool digits = true; int c;
+  while ((c = readByte()) >= 0 && c != '\n') {
+    if (!digits || c == '\r') continue;
+    if      (c >= '0' && c <= '9') len = len * 16 + (c - '0');
+    else if (c >= 'a' && c <= 'f') len = len * 16 + (c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F') len = len * 16 + (c - 'A' + 10);
+    else digits = false;  // chunk extensions are ignored
+  }
+  if (c < 0) return false;
+  chunkLeft_ = len;
+  if (len == 0) {
+    while ((c = readByte()) >= 0 && c != '\n') {}  // trailer terminator
+  }
+  return true;
+}
+
+int HttpSession::read(uint8_t* dst, size_t n) {
+  if (bodyDone_ || n == 0) return 0;
+
+  if (chunked_) {
+    if (chunkLeft_ == 0) {
+      if (!readChunkHeader()) return -1;
+      if (chunkLeft_ == 0) { bodyDone_ = true; return 0; }
+    }
+    if (n > chunkLeft_) n = chunkLeft_;
+  } else if (remaining_ >= 0) {
+    if ((long)n > remaining_) n = (size_t)remaining_;
+  }
+
+  int got = readRaw(dst, n);
+  if (got == 0) {
+    // Peer closed: only a clean end when the length was unknown
+    if (!chunked_ && remaining_ < 0) { bodyDone_ = true; return 0; }
+    return -1;
+  }
+  if (got < 0) return -1;
+
+  if (chunked_) {
+    chunkLeft_ -= got;
+    if (chunkLeft_ == 0) { readByte(); readByte(); }  // CRLF after chunk data
+  } else if (remaining_ >= 0) {
+    remaining_ -= got;
+    if (remaining_ == 0) bodyDone_ = true;
+  }
+  return got;
+}
+
+void HttpSession::end() {
+  if (!bodyDone_) dropConnection();
+  http_.end();  // keeps the socket open when the server allowed keep-alive
+  bodyDone_ = true;
+}
@@ -0,0 +1,59 @@
+// HttpSession.h
+// Long-lived HTTPS connection for ESP32 (Arduino)
+// - Owns one WiFiClientSecure + HTTPClient for the lifetime of a provider
+// - Keeps the TCP/TLS connection alive between requests, reconnects when the server closed it
+// - Reads the body exactly (Content-Length / chunked) so the connection stays reusable
+#pragma once
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+
+struct HttpSessionStats {
+  uint32_t handshakes{0};  // fresh TCP + TLS connects
+  uint32_t reuses{0};      // requests sent on an already open connection
+  uint32_t drops{0};       // connections we closed (early exit, error, stale socket)
+};
+
+class HttpSession {
+public:
+  explicit HttpSession(bool insecureTLS);
+
+  // Prepare a request for url on the persistent connection (handshakes only if needed).
+  // Add request headers via http() between begin() and GET().
+  bool begin(const String& url);
+  HTTPClient& http() { return http_; }
+
+  // Send the GET; retries once on a fresh connection if a reused socket turned out stale.
+  int GET();
+
+  // Read up to n body bytes. Returns >0 bytes, 0 at end of body, -1 on error/timeout.
+  int read(uint8_t* dst, size_t n);
+  bool bodyComplete() const { return bodyDone_; }
+
+  // Finish the request. An unread body forces a close, since it would poison the next response.
+  void end();
+
+  const HttpSessionStats& stats() const { return stats_; }
+
+private:
+  bool connectIfNeeded();
+  void dropConnection();
+  int  readRaw(uint8_t* dst, size_t n);
+  int  readByte();
+  bool readChunkHeader();
+
+  WiFiClientSecure client_;
+  HTTPClient http_;
+  String url_;
+  String host_;
+  uint16_t port_{443};
+  bool reused_{false};
+
+  // Body framing of the current response
+  bool    chunked_{false};
+  long    remaining_{-1};   // Content-Length left, -1 = unknown (read until close)
+  size_t  chunkLeft_{0};
+  bool    bodyDone_{true};
+
+  HttpSessionStats stats_;
+};
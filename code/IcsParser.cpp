@@ -0,0 +1,305 @@
+// IcsParser.cpp
+#include "IcsParser.h"
+#include "DateTimeFormatter.h"
+#include "Fnv1a.h"
+#include <string.h>
+
+// Drop a multi-byte UTF-8 sequence cut short by truncation at the end of s
+static void utf8TrimTail(char* s) {
+  size_t n = strlen(s);
+  size_t i = n;
+  while (i > 0 && ((unsigned char)s[i-1] & 0xC0) == 0x80) --i;  // continuation bytes
+  if (i == 0) return;
+  unsigned char lead = (unsigned char)s[i-1];
+  size_t need = (lead >= 0xF0) ? 4 : (lead >= 0xE0) ? 3 : (lead >= 0xC0) ? 2 : 1;
+  if (n - (i-1) < need) s[i-1] = 0;
+}
+
+// Unescape common ICS sequences (\, \n, \;) from src[0..n) into a fixed field (always NUL-terminated)
+static void icsUnescapeInto(char* dst, size_t cap, const char* src, size_t n) {
+  size_t o = 0;
+  for (size_t i=0; i<n && o+1<cap; ++i) {
+    char c = src[i];
+    if (c=='\\' && i+1<n) {
+      char nx = src[i+1];
+      if (nx=='n' || nx=='N') { dst[o++] = ' '; i++; continue; }               // replace \n with space (single-line UI)
+      if (nx=='\\' || nx==',' || nx==';') { dst[o++] = nx; i++; continue; } // unescape \\, \, and \;
+    }
+    dst[o++] = c;
+  }
+  dst[o] = 0;
+  utf8TrimTail(dst);
+}
+
+// Does [startUTC, endUTC) (or instant at startUTC if no end) overlap [winStart, winEnd)?
+static bool overlapsWindow(time_t startUTC, time_t endUTC, time_t winStart, time_t winEnd) {
+  if (endUTC <= startUTC) return startUTC >= winStart && startUTC < winEnd;  // zero-duration events
+  return startUTC < winEnd && endUTC > winStart;
+}
+
+static uint32_t uidHash(const char* s, size_t n) {
+  const uint32_t h = fnv1a(s, n);
+  return h ? h : 1;  // 0 means "no UID"
+}
+
+// Hash of the TZID parameter ("TZID=Europe/Berlin" or quoted), 0 if there is none
+static uint32_t tzidParam(const IcsLine& ln) {
+  const char* p = ln.params; const char* e = ln.params + ln.paramsLen;
+  for (; p + 5 <= e; ++p) {
+    if (memcmp(p, "TZID=", 5) != 0 || (p != ln.params && p[-1] != ';')) continue;
+    p += 5;
+    if (p < e && *p == '"') ++p;
+    const char* q = p;
+    while (q < e && *q != ';' && *q != '"') ++q;
+    return uidHash(p, (size_t)(q - p));
+  }
+  return 0;
+}
+
+// Parse DTSTART/DTEND/RECURRENCE-ID variants:
+// - "DTSTART:YYYYMMDDTHHMMSSZ"   (UTC)
+// - "DTSTART;TZID=Europe/Berlin:YYYYMMDDTHHMMSS" (local)
+// - "DTSTART;VALUE=DATE:YYYYMMDD" (all-day local)
+static bool parseICSTime(const IcsLine& ln, time_t* out, IcsDateTime* parts = nullptr) {
+  IcsDateTime dt;
+  if (!parseIcsDateTime(ln.value, ln.valueLen, &dt)) return false;
+  if (dt.kind == IcsDateTime::Local) dt.zone = tzFind(tzidParam(ln));
+  if (parts) *parts = dt;
+  *out = icsToUTC(dt);
+  return (*out > 0);
+}
+
+// Cached title: "Summary (Location)", truncated to the UI width on a UTF-8 boundary
+static void composeTitle(const CalendarEvent& ev, char* out, size_t n) {
+  if (!n) return;
+  FmtOut o(out, n);
+  o.u8(ev.summary, sizeof(ev.summary));
+  if (ev.location[0]) o.s(" (").u8(ev.location, sizeof(ev.location)).c(')');
+  o.end();
+}
+
+void IcsParser::beginWindow(EventCache* dst, time_t winStart, time_t winEnd) {
+  dst_ = dst; winStart_ = winStart; winEnd_ = winEnd;
+  dst_->clear(winStart, winEnd);
+  filled_ = 0;
+  stats_ = IcsParseStats();
+  lastKey_ = 0;
+}
+
+void IcsParser::beginRun(long base) {
+  inEvent_ = inAlarm_ = false;
+  base_ = base;
+  firstBegin_ = -1;
+  tok_.reset();
+}
+
+bool IcsParser::parse(IcsByteSource& src, bool last) {
+  return parseSome(src, last, SIZE_MAX) == IcsStep::Done;
+}
+
+IcsStep IcsParser::parseSome(IcsByteSource& src, bool last, size_t maxBytes) {
+  auto cb = [this](const IcsLine& ln) { return onLine(ln); };
+  const uint32_t lines0 = tok_.lines();
+  size_t used = 0;
+  int got = 1;  // > 0: src not known to have ended
+  while (used < maxBytes) {
+    const size_t want = (maxBytes - used < sizeof(chunk_)) ? maxBytes - used : sizeof(chunk_);
+    if ((got = src.read(chunk_, want)) <= 0) break;
+    used += (size_t)got;
+    stats_.bytes += (uint32_t)got;
+    if (!tok_.feed(chunk_, (size_t)got, cb)) break;
+  }
+  if (stats_.stoppedEarly) { stats_.lines += tok_.lines() - lines0; return IcsStep::Done; }
+  if (got > 0) { stats_.lines += tok_.lines() - lines0; return IcsStep::More; }  // slice used up
+  if (last) tok_.finish(cb);
+  stats_.lines += tok_.lines() - lines0;
+  return (got == 0) ? IcsStep::Done : IcsStep::Error;
+}
+
+bool IcsParser::onLine(const IcsLine& ln) {
+  // Dispatch on the first letter, then compare the name in place
+  switch (ln.name[0]) {
+    case 'B':
+      if (!ln.nameIs("BEGIN")) break;
+      if (ln.valueIs("VTIMEZONE")) { inZone_ = true; zone_ = ZoneDef(); }
+      else if (inZone_) {
+        zone_.sub = ln.valueIs("STANDARD") ? 1 : ln.valueIs("DAYLIGHT") ? 2 : 0;
+        zone_.hasRule = false; zone_.dtstart = IcsDateTime();
+      }
+      else if (ln.valueIs("VALARM")) inAlarm_ = true;
+      else if (ln.valueIs("VEVENT")) {
+        if (firstBegin_ < 0) firstBegin_ = base_ + (long)ln.offset;
+        inEvent_ = true; inAlarm_ = false; cur_ = CalendarEvent(); ser_ = Series();
+      }
+      return true;
+    case 'E':
+      if (!ln.nameIs("END")) break;
+      if (inZone_) {
+        if (ln.valueIs("VTIMEZONE")) endZone();
+        else endZoneSub();
+        return true;
+      }
+      if (ln.valueIs("VALARM")) { inAlarm_ = false; return true; }
+      if (!ln.valueIs("VEVENT")) return true;
+      return endEvent();
+    default:
+      break;
+  }
+  if (inZone_) { onZoneLine(ln); return true; }
+  // Lines before the first BEGIN of a range belong to an event cut off by the range start
+  if (!inEvent_ || inAlarm_) return true;
+
+  switch (ln.name[0]) {
+    case 'D':
+      if      (ln.nameIs("DTSTART"))  parseICSTime(ln, &cur_.start, &ser_.dtstart);
+      else if (ln.nameIs("DTEND"))    parseICSTime(ln, &cur_.end);
+      else if (ln.nameIs("DURATION")) { if (!parseIcsDuration(ln.value, ln.valueLen, &ser_.durSec)) ser_.durSec = -1; }
+      break;
+    case 'E':
+      if (ln.nameIs("EXDATE")) parseExdates(ln);
+      break;
+    case 'R':
+      if      (ln.nameIs("RRULE"))         ser_.hasRule = parseRRule(ln.value, ln.valueLen, &ser_.rule);
+      else if (ln.nameIs("RECURRENCE-ID")) parseICSTime(ln, &ser_.recurrenceId);
+      break;
+    case 'U':
+      if (ln.nameIs("UID")) ser_.uid = uidHash(ln.value, ln.valueLen);
+      break;
+    case 'S':
+      if      (ln.nameIs("STATUS"))  { if (ln.valueContains("CANCELLED")) cur_.cancelled = true; }
+      else if (ln.nameIs("SUMMARY")) icsUnescapeInto(cur_.summary, sizeof(cur_.summary), ln.value, ln.valueLen);
+      break;
+    case 'L':
+      if (ln.nameIs("LOCATION")) icsUnescapeInto(cur_.location, sizeof(cur_.location), ln.value, ln.valueLen);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+// Finish the VEVENT; false stops the parse (early exit)
+bool IcsParser::endEvent() {
+  if (!inEvent_) return true;
+  inEvent_ = false;
+  int n = addEvent();
+  filled_ += n;
+  stats_.events++;
+  stats_.added += (uint32_t)n;
+  if (ser_.hasRule) stats_.series++;
+
+  // Order key: an override also affects its original slot, so it counts at the earlier of both
+  if (cur_.start <= 0) return true;
+  time_t key = cur_.start;
+  if (ser_.recurrenceId && ser_.recurrenceId < key) key = ser_.recurrenceId;
+  if (key < lastKey_) stats_.ordered = false;
+  lastKey_ = key;
+  // Sorted so far: everything after this starts at/after winEnd (a series' instances
+  // never start before its DTSTART), so nothing further can land in the window
+  if (earlyExit_ && stats_.ordered && key >= winEnd_) { stats_.stoppedEarly = true; return false; }
+  return true;
+}
+
+// "+0100" / "-0530" / "+013045" -> seconds east of UTC
+static bool parseUtcOffset(const char* v, size_t n, int32_t* out) {
+  if (n < 5 || (v[0] != '+' && v[0] != '-')) return false;
+  int32_t s = ((v[1]-'0') * 10 + (v[2]-'0')) * 3600 + ((v[3]-'0') * 10 + (v[4]-'0')) * 60;
+  if (n >= 7) s += (v[5]-'0') * 10 + (v[6]-'0');
+  *out = (v[0] == '-') ? -s : s;
+  return true;
+}
+
+void IcsParser::onZoneLine(const IcsLine& ln) {
+  if (ln.nameIs("TZID") && !zone_.sub) { zone_.tzid = uidHash(ln.value, ln.valueLen); return; }
+  if (!zone_.sub) return;
+  if      (ln.nameIs("TZOFFSETTO")) parseUtcOffset(ln.value, ln.valueLen, &zone_.offsetTo);
+  else if (ln.nameIs("DTSTART"))    parseIcsDateTime(ln.value, ln.valueLen, &zone_.dtstart);
+  else if (ln.nameIs("RRULE"))      zone_.hasRule = parseRRule(ln.value, ln.valueLen, &zone_.rule);
+}
+
+// Keep a finished STANDARD/DAYLIGHT if it is the newest of its kind. Yearly
+// BYMONTH + BYDAY=nXX (or -1XX) rules map onto POSIX Mm.w.d.
+void IcsParser::endZoneSub() {
+  const int k = zone_.sub - 1;
+  zone_.sub = 0;
+  if (k < 0 || zone_.dtstart.day < zone_.latest[k]) return;
+  zone_.have[k] = true;
+  zone_.latest[k] = zone_.dtstart.day;
+  zone_.ofs[k] = zone_.offsetTo;
+
+  TzWhen w;
+  const RRule& rr = zone_.rule;
+  if (zone_.hasRule && rr.freq == RRule::Yearly && rr.byMonthMask && rr.nByDayOrd) {
+    int m = 1; while (!((rr.byMonthMask >> (m - 1)) & 1)) ++m;
+    const int ord = rr.byDayOrd[0];
+    w.kind  = TzWhen::MonthWeekDay;
+    w.month = (uint8_t)m;
+    w.week  = (uint8_t)((ord < 0 || ord > 5) ? 5 : ord);
+    w.wday  = rr.byDayOrdWd[0];
+    w.time  = zone_.dtstart.sec;
+  }
+  zone_.when[k] = w;
+}
+
+// DST only when both kinds recur yearly; a one-off sub-component fixes the offset
+void IcsParser::endZone() {
+  inZone_ = false;
+  if (!zone_.tzid || !(zone_.have[0] || zone_.have[1])) return;
+  TzRule r;
+  r.stdOfs = zone_.have[0] ? zone_.ofs[0] : zone_.ofs[1];
+  r.dstOfs = zone_.have[1] ? zone_.ofs[1] : r.stdOfs;
+  r.start = zone_.when[1];
+  r.end   = zone_.when[0];
+  if (!r.hasDst()) { r.start = TzWhen(); r.end = TzWhen(); r.dstOfs = r.stdOfs; }
+  tzRegister(zone_.tzid, r);
+}
+
+// EXDATE may hold a comma-separated list in the same format as DTSTART
+void IcsParser::parseExdates(const IcsLine& ln) {
+  const int8_t zone = tzFind(tzidParam(ln));
+  size_t i = 0;
+  while (i < ln.valueLen && ser_.nExdates < kIcsMaxExdates) {
+    size_t s0 = i; while (i < ln.valueLen && ln.value[i] != ',') ++i;
+    IcsDateTime dt;
+    if (parseIcsDateTime(ln.value + s0, i - s0, &dt)) {
+      if (dt.kind == IcsDateTime::Local) dt.zone = zone;
+      ser_.exdates[ser_.nExdates++] = icsToUTC(dt);
+    }
+    ++i;
+  }
+}
+
+bool IcsParser::isExdate(time_t t) const {
+  for (int i = 0; i < ser_.nExdates; ++i) if (ser_.exdates[i] == t) return true;
+  return false;
+}
+
+// Add the finished VEVENT: expanded occurrences for RRULE masters, the event itself otherwise.
+// Returns the number of cache entries added.
+int IcsParser::addEvent() {
+  const CalendarEvent& ev = cur_;
+  EventCache& dst = *dst_;
+  // An override (moved or cancelled instance) replaces its master's occurrence
+  if (ser_.recurrenceId) dst.excludeInstance(ser_.uid, ser_.recurrenceId);
+  if (ev.cancelled || ev.start <= 0 || !ev.summary[0]) return 0;
+
+  long dur = (ser_.durSec >= 0) ? ser_.durSec : ((ev.end > ev.start) ? (long)(ev.end - ev.start) : 0);
+  uint8_t flags = (ser_.dtstart.kind == IcsDateTime::Date) ? kEvAllDay : 0;
+  char title[sizeof(CalItem::title)];
+
+  if (ser_.hasRule && !ser_.recurrenceId) {
+    int n = expandRRule(ser_.rule, ser_.dtstart, dur, winStart_, winEnd_, starts_, kIcsMaxInstances);
+    if (n == 0) return 0;
+    composeTitle(ev, title, sizeof(title));
+    int added = 0;
+    for (int i = 0; i < n; ++i) {
+      if (isExdate(starts_[i])) continue;
+      if (dst.add(starts_[i], starts_[i] + dur, title, flags | kEvRecurring, ser_.uid)) added++;
+    }
+    return added;
+  }
+
+  if (!overlapsWindow(ev.start, ev.start + dur, winStart_, winEnd_)) return 0;
+  composeTitle(ev, title, sizeof(title));
+  return dst.add(ev.start, ev.start + dur, title, flags, ser_.uid) ? 1 : 0;
+}
@@ -0,0 +1,138 @@
+// IcsParser.h
+// VEVENT state machine of the ICS provider, free of HTTP and Arduino dependencies
+// - Pulls bytes from an IcsByteSource (HTTP body, file, memory) through IcsTokenizer
+// - Adds events overlapping [winStart, winEnd) to an EventCache, expanding RRULE series
+// - VTIMEZONE blocks register their zone (TimeZone); TZID= values convert in that zone
+// - A run is one contiguous stretch of the file (a full body or adjacent 206 ranges);
+//   firstBegin() reports where its first BEGIN:VEVENT sits for the backward Range walk
+// - parseSome(): bounded slices of a body; the open VEVENT, the partial line and the
+//   counts all live in the parser, so a slice can stop anywhere and the next one resumes
+// - Builds on the host as well, so parser changes can be timed off-device (stats())
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <limits.h>
+#include "IcsTokenizer.h"
+#include "IcsRecurrence.h"
+#include "EventCache.h"
+#include "TimeZone.h"
+#include "Calendar.h"
+
+// Stream-like pull source; read() returns bytes read (> 0), 0 at the end, < 0 on error
+class IcsByteSource {
+public:
+  virtual ~IcsByteSource() {}
+  virtual int read(uint8_t* dst, size_t n) = 0;
+};
+
+// Caller-owned source over a memory buffer (corpora, cached bodies)
+class IcsMemorySource : public IcsByteSource {
+public:
+  IcsMemorySource(const uint8_t* p, size_t n) : p_(p), n_(n) {}
+  int read(uint8_t* dst, size_t n) override {
+    if (n > n_ - off_) n = n_ - off_;
+    memcpy(dst, p_ + off_, n);
+    off_ += n;
+    return (int)n;
+  }
+
+private:
+  const uint8_t* p_;
+  size_t n_, off_{0};
+};
+
+// Counters since the last beginWindow()
+struct IcsParseStats {
+  uint32_t bytes{0};
+  uint32_t lines{0};
+  uint32_t events{0};   // END:VEVENT seen
+  uint32_t added{0};    // cache entries added (expanded instances included)
+  uint32_t series{0};   // VEVENTs with an RRULE (filed at their first DTSTART)
+  bool     ordered{true};      // VEVENTs so far came in non-decreasing start order
+  bool     stoppedEarly{false};
+};
+
+// Outcome of one parseSome() slice
+enum class IcsStep : uint8_t { More, Done, Error };
+
+static const int kIcsMaxExdates  = 16;  // EXDATEs kept per series
+static const int kIcsMaxInstances = 64; // occurrences of one series inside the window
+
+class IcsParser {
+public:
+  // Start filling dst (cleared) for [winStart, winEnd)
+  void beginWindow(EventCache* dst, time_t winStart, time_t winEnd);
+  // Same window again, e.g. when the feed changed mid-walk
+  void restartWindow() { beginWindow(dst_, winStart_, winEnd_); }
+  // Stop at the first VEVENT starting at/after winEnd while the feed has been in start
+  // order so far. Only sound for a forward parse of a feed known to be sorted.
+  void setEarlyExit(bool on) { earlyExit_ = on; }
+  // Start a run at file offset base (the first byte the next parse() sees)
+  void beginRun(long base);
+  // Parse src until it ends; last: the run ends with it (flush the final line).
+  // Returns false on a read error.
+  bool parse(IcsByteSource& src, bool last);
+  // Parse at most maxBytes of src (time-sliced callers). More: src has not ended yet,
+  // call again with the same src; Done/Error as parse() would have returned.
+  IcsStep parseSome(IcsByteSource& src, bool last, size_t maxBytes);
+
+  int  filled() const { return filled_; }
+  long firstBegin() const { return firstBegin_; }
+  const IcsParseStats& stats() const { return stats_; }
+
+private:
+  // Recurrence-related properties of the VEVENT being parsed
+  struct Series {
+    IcsDateTime dtstart;
+    long     durSec{-1};       // from DURATION; -1 = use DTEND
+    bool     hasRule{false};
+    RRule    rule;
+    int      nExdates{0};
+    time_t   exdates[kIcsMaxExdates];
+    uint32_t uid{0};
+    time_t   recurrenceId{0};  // set on overrides of a single instance
+  };
+
+  // VTIMEZONE being parsed: the latest STANDARD and DAYLIGHT sub-components win
+  struct ZoneDef {
+    uint32_t    tzid{0};
+    int         sub{0};         // 0 outside, 1 STANDARD, 2 DAYLIGHT
+    int32_t     offsetTo{0};
+    IcsDateTime dtstart;
+    RRule       rule;
+    bool        hasRule{false};
+    // Kept per kind (0 STANDARD, 1 DAYLIGHT)
+    bool        have[2]{false, false};
+    long        latest[2]{LONG_MIN, LONG_MIN};  // DTSTART day of the one kept
+    int32_t     ofs[2]{0, 0};
+    TzWhen      when[2];                       // None unless it recurs yearly
+  };
+
+  bool onLine(const IcsLine& ln);
+  bool endEvent();
+  void onZoneLine(const IcsLine& ln);
+  void endZoneSub();
+  void endZone();
+  int  addEvent();
+  void parseExdates(const IcsLine& ln);
+  bool isExdate(time_t t) const;
+
+  EventCache* dst_{nullptr};
+  time_t winStart_{0}, winEnd_{0};
+  bool   inEvent_{false}, inAlarm_{false}, inZone_{false};
+  int    filled_{0};
+  long   base_{0};         // file offset of the tokenizer's offset 0
+  long   firstBegin_{-1};  // file offset of the first BEGIN:VEVENT line in this run
+  bool   earlyExit_{false};
+  time_t lastKey_{0};      // order key of the previous VEVENT
+  IcsParseStats stats_;
+
+  // Working set, allocated once with the parser (heap use per fetch is flat)
+  IcsTokenizer  tok_;
+  uint8_t       chunk_[512];
+  CalendarEvent cur_;
+  Series        ser_;
+  ZoneDef       zone_;
+  time_t        starts_[kIcsMaxInstances];  // expansion scratch for one series
+};
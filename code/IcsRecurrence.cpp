@@ -0,0 +1,434 @@
+// IcsRecurrence.cpp
+#include "IcsRecurrence.h"
+#include "TimeZone.h"
+#include <string.h>
+
+// ---- Tunables ----
+static const int kMaxSteps = 4000;  // hard cap on candidate days per expansion
+
+static int digitsAt(const char* p, int n) {
+  int v = 0;
+  for (int i = 0; i < n; ++i) {
+    if (p[i] < '0' || p[i] > '9') return -1;
+    v = v * 10 + (p[i] - '0');
+  }
+  return v;
+}
+
+bool parseIcsDateTime(const char* v, size_t n, IcsDateTime* out) {
+  while (n && (v[n-1]==' ' || v[n-1]=='\t')) --n;
+  if (n < 8) return false;
+
+  bool zulu = (v[n-1]=='Z' || v[n-1]=='z');
+  if (zulu) --n;
+
+  int YY = digitsAt(v, 4), MO = digitsAt(v+4, 2), DD = digitsAt(v+6, 2);
+  int HH = 0, MM = 0, SS = 0;
+
+  // "YYYYMMDDTHHMMSS"; missing time digits count as zero, no 'T' → all-day (local midnight)
+  if (n > 8) {
+    if (v[8] != 'T') return false;
+    char td[6] = {'0','0','0','0','0','0'};
+    size_t k = 0;
+    for (size_t i = 9; i < n && k < 6; ++i) if (v[i]>='0' && v[i]<='9') td[k++] = v[i];
+    HH = digitsAt(td, 2); MM = digitsAt(td+2, 2); SS = digitsAt(td+4, 2);
+  }
+
+  if (YY < 0 || MO<1 || MO>12 || DD<1 || DD>31 || HH>23 || MM>59 || SS>60) return false;
+
+  out->zone = 0;
+  out->kind = (n == 8) ? IcsDateTime::Date : (zulu ? IcsDateTime::Utc : IcsDateTime::Local);
+  out->day  = daysFromCivil(YY, MO, DD);
+  out->sec  = HH * 3600 + MM * 60 + SS;
+  return true;
+}
+
+time_t icsToUTC(const IcsDateTime& dt) {
+  if (dt.kind == IcsDateTime::Utc) return (time_t)dt.day * 86400 + dt.sec;
+
+  return tzZone(dt.zone).localToUTC((time_t)dt.day * 86400 + dt.sec);
+}
+
+bool parseIcsDuration(const char* v, size_t n, long* outSec) {
+  size_t i = 0; long sign = 1;
+  if (i < n && (v[i] == '+' || v[i] == '-')) { if (v[i] == '-') sign = -1; ++i; }
+  if (i >= n || v[i] != 'P') return false;
+  ++i;
+  long total = 0, num = 0; bool haveNum = false;
+  for (; i < n; ++i) {
+    char c = v[i];
+    if (c >= '0' && c <= '9') { num = num * 10 + (c - '0'); haveNum = true; continue; }
+    if (c == 'T') continue;
+    if (!haveNum) return false;
+    switch (c) {
+      case 'W': total += num * 7 * 86400; break;
+      case 'D': total += num * 86400; break;
+      case 'H': total += num * 3600; break;
+      case 'M': total += num * 60; break;
+      case 'S': total += num; break;
+      default: return false;
+    }
+    num = 0; haveNum = false;
+  }
+  *outSec = sign * total;
+  return true;
+}
+
+// ---- RRULE parsing ----
+
+static int weekdayCode(const char* p) {
+  static const char* kCodes[7] = {"SU","MO","TU","WE","TH","FR","SA"};
+  for (int i = 0; i < 7; ++i) if (p[0] == kCodes[i][0] && p[1] == kCodes[i][1]) return i;
+  return -1;
+}
+
+static long parseSignedInt(const char* p, size_t n, size_t* used) {
+  size_t i = 0; long sign = 1, v = 0;
+  if (i < n && (p[i] == '+' || p[i] == '-')) { if (p[i] == '-') sign = -1; ++i; }
+  while (i < n && p[i] >= '0' && p[i] <= '9') v = v * 10 + (p[i++] - '0');
+  if (used) *used = i;
+  return sign * v;
+}
+
+static bool keyIs(const char* k, size_t kn, const char* lit) {
+  return strlen(lit) == kn && memcmp(k, lit, kn) == 0;
+}
+
+// BYDAY entries; ordinals only mean something once FREQ is known (rule parts come in any order)
+static void parseByDay(const char* val, size_t vn, RRule* r) {
+  size_t j = 0;
+  while (j < vn) {
+    size_t es = j; while (j < vn && val[j] != ',') ++j;
+    size_t used = 0;
+    long ord = parseSignedInt(val + es, j - es, &used);
+    int wd = (j - es >= used + 2) ? weekdayCode(val + es + used) : -1;
+    if (wd >= 0) {
+      if (ord == 0 || r->freq == RRule::Weekly) r->byDayMask |= (uint8_t)(1 << wd);
+      else if (r->nByDayOrd < 4) { r->byDayOrd[r->nByDayOrd] = (int8_t)ord; r->byDayOrdWd[r->nByDayOrd++] = (uint8_t)wd; }
+    }
+    ++j;
+  }
+}
+
+bool parseRRule(const char* v, size_t n, RRule* r) {
+  *r = RRule();
+  bool supported = true;
+  const char* byDay = nullptr;
+  size_t byDayN = 0;
+  size_t i = 0;
+  while (i < n) {
+    size_t ks = i; while (i < n && v[i] != '=' && v[i] != ';') ++i;
+    size_t kn = i - ks;
+    if (i >= n || v[i] != '=') { ++i; continue; }
+    size_t vs = ++i; while (i < n && v[i] != ';') ++i;
+    const char* val = v + vs; size_t vn = i - vs;
+    const char* key = v + ks;
+    ++i;
+
+    if (keyIs(key, kn, "FREQ")) {
+      if      (vn == 5 && !memcmp(val, "DAILY", 5))   r->freq = RRule::Daily;
+      else if (vn == 6 && !memcmp(val, "WEEKLY", 6))  r->freq = RRule::Weekly;
+      else if (vn == 7 && !memcmp(val, "MONTHLY", 7)) r->freq = RRule::Monthly;
+      else if (vn == 6 && !memcmp(val, "YEARLY", 6))  r->freq = RRule::Yearly;
+      else supported = false;  // HOURLY and finer are not shown on a day view
+    } else if (keyIs(key, kn, "INTERVAL")) {
+      long iv = parseSignedInt(val, vn, nullptr);
+      r->interval = (iv >= 1 && iv <= 1000) ? (uint16_t)iv : 1;
+    } else if (keyIs(key, kn, "COUNT")) {
+      long c = parseSignedInt(val, vn, nullptr);
+      r->count = (c > 0 && c < 65535) ? (uint16_t)c : 65535;
+    } else if (keyIs(key, kn, "UNTIL")) {
+      IcsDateTime u;
+      if (parseIcsDateTime(val, vn, &u)) {
+        if (u.kind == IcsDateTime::Date) { u.day += 1; r->until = icsToUTC(u) - 1; }  // whole day inclusive
+        else r->until = icsToUTC(u);
+      }
+    } else if (keyIs(key, kn, "WKST")) {
+      int wd = (vn >= 2) ? weekdayCode(val) : -1;
+      if (wd >= 0) r->wkst = (uint8_t)wd;
+    } else if (keyIs(key, kn, "BYDAY")) {
+      byDay = val; byDayN = vn;
+    } else if (keyIs(key, kn, "BYMONTHDAY")) {
+      size_t j = 0;
+      while (j < vn) {
+        size_t es = j; while (j < vn && val[j] != ',') ++j;
+        long md = parseSignedInt(val + es, j - es, nullptr);
+        if (md != 0 && md >= -31 && md <= 31 && r->nByMonthDay < 4) r->byMonthDay[r->nByMonthDay++] = (int8_t)md;
+        ++j;
+      }
+    } else if (keyIs(key, kn, "BYMONTH")) {
+      size_t j = 0;
+      while (j < vn) {
+        size_t es = j; while (j < vn && val[j] != ',') ++j;
+        long mo = parseSignedInt(val + es, j - es, nullptr);
+        if (mo >= 1 && mo <= 12) r->byMonthMask |= (uint16_t)(1 << (mo - 1));
+        ++j;
+      }
+    } else if (keyIs(key, kn, "BYSETPOS") || keyIs(key, kn, "BYWEEKNO") || keyIs(key, kn, "BYYEARDAY") ||
+               keyIs(key, kn, "BYHOUR")   || keyIs(key, kn, "BYMINUTE") || keyIs(key, kn, "BYSECOND")) {
+      supported = false;  // better to show only the master than wrong occurrences
+    }
+  }
+  if (byDay) parseByDay(byDay, byDayN, r);
+  if (!supported) r->freq = RRule::None;
+  return r->freq != RRule::None;
+}
+
+// ---- Expansion ----
+
+namespace {
+
+// Collects occurrences that overlap the window; take() returns false once no later one can qualify
+struct Emitter {
+  const RRule& r;
+  IcsDateTime base;
+  long dur;
+  time_t from, to;
+  time_t* out;
+  int maxOut;
+  int n{0};
+  int steps{0};
+
+  Emitter(const RRule& rule, const IcsDateTime& dtstart, long durSec, time_t fromUTC, time_t toUTC,
+          time_t* o, int maxN)
+  : r(rule), base(dtstart), dur(durSec), from(fromUTC), to(toUTC), out(o), maxOut(maxN) {}
+
+  bool take(long day, long idx) {
+    if (++steps > kMaxSteps) return false;
+    if (r.count && idx >= r.count) return false;
+    IcsDateTime o = base; o.day = day;
+    time_t s = icsToUTC(o);
+    if (r.until && s > r.until) return false;
+    if (s >= to) return false;
+    bool hit = (dur > 0) ? (s + dur > from) : (s >= from);
+    if (hit) { out[n++] = s; if (n >= maxOut) return false; }
+    return true;
+  }
+};
+
+inline bool hasBit(uint32_t mask, int bit) { return (mask >> bit) & 1u; }
+
+int popcount8(uint8_t v) { int c = 0; while (v) { c += v & 1; v >>= 1; } return c; }
+
+bool matchesDailyFilters(const RRule& r, long day) {
+  if (r.byDayMask && !hasBit(r.byDayMask, weekdayFromDays(day))) return false;
+  if (r.byMonthMask || r.nByMonthDay) {
+    int y, m, d; civilFromDays(day, &y, &m, &d);
+    if (r.byMonthMask && !hasBit(r.byMonthMask, m - 1)) return false;
+    if (r.nByMonthDay) {
+      int dim = daysInMonth(y, m); bool ok = false;
+      for (int i = 0; i < r.nByMonthDay; ++i) {
+        int md = r.byMonthDay[i] > 0 ? r.byMonthDay[i] : dim + r.byMonthDay[i] + 1;
+        if (md == d) ok = true;
+      }
+      if (!ok) return false;
+    }
+  }
+  return true;
+}
+
+// Occurrence days of one month (ascending, deduplicated) for MONTHLY/YEARLY rules
+int monthCandidates(const RRule& r, int y, int m, int dtDay, long* days) {
+  const int dim = daysInMonth(y, m);
+  const long first = daysFromCivil(y, m, 1);
+  const int wd1 = weekdayFromDays(first);
+  bool md[32] = {false};
+
+  if (r.nByDayOrd || r.byDayMask) {
+    for (int i = 0; i < r.nByDayOrd; ++i) {
+      int firstWd = 1 + (r.byDayOrdWd[i] - wd1 + 7) % 7;
+      int d;
+      if (r.byDayOrd[i] > 0) d = firstWd + 7 * (r.byDayOrd[i] - 1);
+      else { int lastWd = firstWd + 7 * ((dim - firstWd) / 7); d = lastWd + 7 * (r.byDayOrd[i] + 1); }
+      if (d >= 1 && d <= dim) md[d] = true;
+    }
+    for (int wd = 0; wd < 7; ++wd) {
+      if (!hasBit(r.byDayMask, wd)) continue;
+      for (int d = 1 + (wd - wd1 + 7) % 7; d <= dim; d += 7) md[d] = true;
+    }
+    if (r.nByMonthDay) {  // BYMONTHDAY limits BYDAY
+      bool keep[32] = {false};
+      for (int i = 0; i < r.nByMonthDay; ++i) {
+        int d = r.byMonthDay[i] > 0 ? r.byMonthDay[i] : dim + r.byMonthDay[i] + 1;
+        if (d >= 1 && d <= dim) keep[d] = true;
+      }
+      for (int d = 1; d <= dim; ++d) md[d] = md[d] && keep[d];
+    }
+  } else if (r.nByMonthDay) {
+    for (int i = 0; i < r.nByMonthDay; ++i) {
+      int d = r.byMonthDay[i] > 0 ? r.byMonthDay[i] : dim + r.byMonthDay[i] + 1;
+      if (d >= 1 && d <= dim) md[d] = true;
+    }
+  } else if (dtDay <= dim) {
+    md[dtDay] = true;  // months without that day (e.g. the 31st) are skipped
+  }
+
+  int n = 0;
+  for (int d = 1; d <= dim; ++d) if (md[d]) days[n++] = first + d - 1;
+  return n;
+}
+
+void expandDaily(const RRule& r, long d0, long fromDay, long toDay, Emitter& e) {
+  const long iv = r.interval;
+  const bool filtered = r.byDayMask || r.byMonthMask || r.nByMonthDay;
+  long k = 0;
+  if ((!filtered || !r.count) && fromDay > d0) k = (fromDay - d0 + iv - 1) / iv;  // jump to the window
+  long idx = k;
+  for (;; ++k) {
+    long day = d0 + k * iv;
+    if (day > toDay) break;
+    if (filtered && !matchesDailyFilters(r, day)) { if (e.steps++ > kMaxSteps) break; continue; }
+    if (!e.take(day, idx++)) break;
+  }
+}
+
+void expandWeekly(const RRule& r, long d0, long fromDay, long toDay, Emitter& e) {
+  const long iv = r.interval;
+  const uint8_t mask = r.byDayMask ? r.byDayMask : (uint8_t)(1 << weekdayFromDays(d0));
+  const int perWeek = popcount8(mask);
+  auto weekStart = [&](long d) { return d - (weekdayFromDays(d) - r.wkst + 7) % 7; };
+  const long w0 = weekStart(d0);
+
+  // Occurrence slots of the first week that precede DTSTART
+  int before = 0;
+  for (int off = 0; off < 7; ++off)
+    if (hasBit(mask, (r.wkst + off) % 7) && w0 + off < d0) before++;
+
+  // With BYMONTH the index is no longer arithmetic: count from the start when COUNT matters
+  const bool exactIdx = !(r.count && r.byMonthMask);
+  long w = 0;
+  if (exactIdx && fromDay > w0) {
+    w = (weekStart(fromDay) - w0) / 7;
+    w = ((w + iv - 1) / iv) * iv;
+  }
+  long running = 0;
+  for (;; w += iv) {
+    long base = w0 + 7 * w;
+    if (base > toDay) break;
+    int rank = 0;
+    for (int off = 0; off < 7; ++off) {
+      if (!hasBit(mask, (r.wkst + off) % 7)) continue;
+      long day = base + off;
+      long idx = (w / iv) * perWeek + rank - before;
+      rank++;
+      if (day < d0) continue;
+      if (r.byMonthMask) {
+        int y, m, d; civilFromDays(day, &y, &m, &d);
+        if (!hasBit(r.byMonthMask, m - 1)) continue;
+        if (!exactIdx) idx = running++;
+      }
+      if (!e.take(day, idx)) return;
+    }
+  }
+}
+
+void expandMonthly(const RRule& r, long d0, long fromDay, long toDay, Emitter& e) {
+  int y0, m0, dd0; civilFromDays(d0, &y0, &m0, &dd0);
+  const long iv = r.interval;
+  long mi = 0;
+  if (!r.count && fromDay > d0) {
+    int fy, fm, fd; civilFromDays(fromDay, &fy, &fm, &fd);
+    mi = (long)(fy - y0) * 12 + (fm - m0);
+    mi = ((mi + iv - 1) / iv) * iv;
+  }
+  long idx = 0;
+  long days[31];
+  for (;; mi += iv) {
+    long mAbs = (m0 - 1) + mi;
+    int y = y0 + (int)floorDiv(mAbs, 12), m = (int)(mAbs - floorDiv(mAbs, 12) * 12) + 1;
+    if (daysFromCivil(y, m, 1) > toDay) break;
+    if (++e.steps > kMaxSteps) break;
+    int nd = monthCandidates(r, y, m, dd0, days);
+    for (int i = 0; i < nd; ++i) {
+      if (days[i] < d0) continue;
+      if (!e.take(days[i], idx++)) return;
+    }
+  }
+}
+
+// BYDAY of a YEARLY rule without BYMONTH/BYMONTHDAY: every such weekday of the year,
+// ordinals counted within the year (20MO = 20th Monday). Marks day-of-year offsets.
+int yearCandidates(const RRule& r, int y, bool* mark) {
+  const long first = daysFromCivil(y, 1, 1);
+  const int diy = (int)(daysFromCivil(y + 1, 1, 1) - first);
+  const int wd1 = weekdayFromDays(first);
+  memset(mark, 0, 366);
+  for (int wd = 0; wd < 7; ++wd) {
+    if (!hasBit(r.byDayMask, wd)) continue;
+    for (int off = (wd - wd1 + 7) % 7; off < diy; off += 7) mark[off] = true;
+  }
+  for (int i = 0; i < r.nByDayOrd; ++i) {
+    const int firstOff = (r.byDayOrdWd[i] - wd1 + 7) % 7;
+    int off;
+    if (r.byDayOrd[i] > 0) off = firstOff + 7 * (r.byDayOrd[i] - 1);
+    else off = firstOff + 7 * ((diy - 1 - firstOff) / 7) + 7 * (r.byDayOrd[i] + 1);
+    if (off >= 0 && off < diy) mark[off] = true;
+  }
+  return diy;
+}
+
+void expandYearly(const RRule& r, long d0, long fromDay, long toDay, Emitter& e) {
+  int y0, m0, dd0; civilFromDays(d0, &y0, &m0, &dd0);
+  const long iv = r.interval;
+  const bool byDay = r.byDayMask || r.nByDayOrd;
+  // Without BYMONTH: BYMONTHDAY expands over every month, BYDAY over the whole year
+  const bool yearScope = byDay && !r.byMonthMask && !r.nByMonthDay;
+  const uint16_t months = r.byMonthMask ? r.byMonthMask
+                        : r.nByMonthDay ? (uint16_t)0x0FFF : (uint16_t)(1 << (m0 - 1));
+  long yi = 0;
+  if (!r.count && fromDay > d0) {
+    int fy, fm, fd; civilFromDays(fromDay, &fy, &fm, &fd);
+    yi = fy - y0;
+    yi = ((yi + iv - 1) / iv) * iv;
+  }
+  long idx = 0;
+  long days[31];
+  bool mark[366];
+  for (;; yi += iv) {
+    int y = y0 + (int)yi;
+    const long first = daysFromCivil(y, 1, 1);
+    if (first > toDay) break;
+    if (yearScope) {
+      if (++e.steps > kMaxSteps) return;
+      const int diy = yearCandidates(r, y, mark);
+      for (int off = 0; off < diy; ++off) {
+        if (!mark[off] || first + off < d0) continue;
+        if (!e.take(first + off, idx++)) return;
+      }
+      continue;
+    }
+    for (int m = 1; m <= 12; ++m) {
+      if (!hasBit(months, m - 1)) continue;
+      if (++e.steps > kMaxSteps) return;
+      int nd = monthCandidates(r, y, m, dd0, days);  // Feb 29 series skip non-leap years
+      for (int i = 0; i < nd; ++i) {
+        if (days[i] < d0) continue;
+        if (!e.take(days[i], idx++)) return;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int expandRRule(const RRule& r, const IcsDateTime& dtstart, long durSec,
+                time_t fromUTC, time_t toUTC, time_t* out, int maxOut) {
+  if (r.freq == RRule::None || maxOut <= 0 || toUTC <= fromUTC) return 0;
+  if (durSec < 0) durSec = 0;
+
+  Emitter e(r, dtstart, durSec, fromUTC, toUTC, out, maxOut);
+
+  // Civil-day bounds with a day of margin for zone offsets
+  long fromDay = floorDiv((long)(fromUTC - durSec), 86400) - 1;
+  long toDay   = floorDiv((long)toUTC, 86400) + 1;
+  const long d0 = dtstart.day;
+
+  switch (r.freq) {
+    case RRule::Daily:   expandDaily(r, d0, fromDay, toDay, e);   break;
+    case RRule::Weekly:  expandWeekly(r, d0, fromDay, toDay, e);  break;
+    case RRule::Monthly: expandMonthly(r, d0, fromDay, toDay, e); break;
+    case RRule::Yearly:  expandYearly(r, d0, fromDay, toDay, e);  break;
+    default: break;
+  }
+  return e.n;
+}
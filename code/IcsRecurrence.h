@@ -0,0 +1,89 @@
+// IcsRecurrence.h
+// RFC 5545 date-time values and RRULE expansion for the ICS provider
+// - Civil-day arithmetic (days since 1970-01-01), no TZ rewriting
+// - Occurrences are computed straight from the rule for a bounded window:
+//   the expander jumps to the window instead of iterating from DTSTART
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+// ---- Civil calendar arithmetic (proleptic Gregorian) ----
+
+inline long floorDiv(long a, long b) { return (a >= 0) ? a / b : -((-a + b - 1) / b); }
+
+// Days since 1970-01-01 for y-m-d (m 1..12)
+inline long daysFromCivil(int y, int m, int d) {
+  y -= (m <= 2);
+  const long era = floorDiv(y, 400);
+  const long yoe = y - era * 400;
+  const long doy = (153L * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+inline void civilFromDays(long z, int* y, int* m, int* d) {
+  z += 719468;
+  const long era = floorDiv(z, 146097);
+  const long doe = z - era * 146097;
+  const long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const long mp  = (5 * doy + 2) / 153;
+  *d = (int)(doy - (153 * mp + 2) / 5 + 1);
+  *m = (int)(mp < 10 ? mp + 3 : mp - 9);
+  *y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+// 0 = Sunday .. 6 = Saturday (1970-01-01 was a Thursday)
+inline int weekdayFromDays(long z) { return (int)((z % 7 + 11) % 7); }
+
+inline int daysInMonth(int y, int m) {
+  static const uint8_t kDays[12] = {31,28,31,30,31,30,31,31,30,31,30,31};
+  bool leap = (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0);
+  return (m == 2 && leap) ? 29 : kDays[m - 1];
+}
+
+// ---- Date-time values ----
+
+// A DTSTART/DTEND/EXDATE/RECURRENCE-ID/UNTIL value split into civil parts
+struct IcsDateTime {
+  enum Kind : uint8_t { Utc, Local, Date };
+  Kind    kind{Local};
+  int8_t  zone{0};  // Local/Date: TimeZone index (0 = device zone, from TZID otherwise)
+  long    day{0};   // days since 1970-01-01 in the value's own zone
+  int32_t sec{0};   // seconds since midnight
+};
+
+// "YYYYMMDD", "YYYYMMDDTHHMMSS" or "YYYYMMDDTHHMMSSZ"
+bool parseIcsDateTime(const char* v, size_t n, IcsDateTime* out);
+// UTC: pure arithmetic; Local/Date: wall clock of dt.zone (TimeZone table, no mktime)
+time_t icsToUTC(const IcsDateTime& dt);
+// "P1W", "PT1H30M", "P1DT2H", "-PT15M" → seconds; false if malformed
+bool parseIcsDuration(const char* v, size_t n, long* outSec);
+
+// ---- Recurrence rules ----
+
+struct RRule {
+  enum Freq : uint8_t { None, Daily, Weekly, Monthly, Yearly };
+  Freq     freq{None};
+  uint16_t interval{1};
+  uint16_t count{0};        // 0 = unbounded
+  time_t   until{0};        // UTC, 0 = none
+  uint8_t  wkst{1};         // week start, 0 = SU .. 6 = SA (default MO)
+  uint8_t  byDayMask{0};    // BYDAY without ordinal, bit n = weekday n
+  uint8_t  nByDayOrd{0};
+  int8_t   byDayOrd[4]{};   // BYDAY=2TU / -1SU: ordinal ...
+  uint8_t  byDayOrdWd[4]{}; // ... and its weekday
+  uint8_t  nByMonthDay{0};
+  int8_t   byMonthDay[4]{}; // 1..31 or -1..-31
+  uint16_t byMonthMask{0};  // bit n = month n+1
+};
+
+// Parse the RRULE value; unsupported frequencies (HOURLY, ...) leave freq == None
+bool parseRRule(const char* v, size_t n, RRule* r);
+
+// Starts (UTC) of the occurrences of a series beginning at dtstart whose
+// [start, start + durSec) overlaps [fromUTC, toUTC), ascending, at most maxOut.
+// Returns the number written.
+int expandRRule(const RRule& r, const IcsDateTime& dtstart, long durSec,
+                time_t fromUTC, time_t toUTC, time_t* out, int maxOut);
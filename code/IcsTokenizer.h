@@ -0,0 +1,122 @@
+// IcsTokenizer.h
+// Allocation-free RFC 5545 content-line tokenizer
+// - Push-based: feed() arbitrary byte chunks, get one callback per logical line
+// - Unfolds continuation lines (leading space/tab) straight into one fixed line buffer
+// - Splits NAME;PARAMS:VALUE in place; callers dispatch on the name without copying
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+static const size_t kIcsLineMax = 1024;  // longest logical line kept (longer lines are truncated)
+
+// One logical content line; all pointers reference the tokenizer's buffer and are
+// only valid during the callback.
+struct IcsLine {
+  uint32_t    offset;                     // stream offset of the line's first byte (since reset)
+  const char* name;   size_t nameLen;
+  const char* params; size_t paramsLen;   // text between the first ';' and ':' (may be empty)
+  const char* value;  size_t valueLen;
+
+  template<size_t N> bool nameIs(const char (&lit)[N]) const {
+    return nameLen == N - 1 && memcmp(name, lit, N - 1) == 0;
+  }
+  template<size_t N> bool valueIs(const char (&lit)[N]) const {
+    return valueLen == N - 1 && memcmp(value, lit, N - 1) == 0;
+  }
+  bool valueContains(const char* needle) const {
+    size_t n = strlen(needle);
+    for (size_t i = 0; i + n <= valueLen; ++i)
+      if (memcmp(value + i, needle, n) == 0) return true;
+    return false;
+  }
+  bool paramsContain(const char* needle) const {
+    size_t n = strlen(needle);
+    for (size_t i = 0; i + n <= paramsLen; ++i)
+      if (memcmp(params + i, needle, n) == 0) return true;
+    return false;
+  }
+};
+
+class IcsTokenizer {
+public:
+  void reset() { len_ = 0; pendingEol_ = false; lines_ = 0; consumed_ = 0; lineStart_ = 0; }
+
+  // Consume n bytes. onLine(const IcsLine&) returns false to stop; feed() then returns false.
+  template<typename Fn>
+  bool feed(const uint8_t* p, size_t n, Fn onLine) {
+    size_t i = 0;
+    while (i < n) {
+      if (pendingEol_) {
+        // Previous physical line ended: a leading space/tab folds the next one onto it
+        pendingEol_ = false;
+        if (p[i] == ' ' || p[i] == '\t') { ++i; continue; }
+        bool more = emit(onLine);
+        lineStart_ = consumed_ + (uint32_t)i;
+        if (!more) { consumed_ += (uint32_t)i; return false; }
+      }
+      const uint8_t* nl = (const uint8_t*)memchr(p + i, '\n', n - i);
+      size_t span = nl ? (size_t)(nl - (p + i)) : (n - i);
+      append(p + i, span);
+      i += span;
+      if (nl) {
+        ++i;
+        if (len_ > 0 && line_[len_ - 1] == '\r') --len_;
+        pendingEol_ = true;
+      }
+    }
+    consumed_ += (uint32_t)n;
+    return true;
+  }
+
+  // Flush the last line at end of input.
+  template<typename Fn>
+  bool finish(Fn onLine) {
+    pendingEol_ = false;
+    return emit(onLine);
+  }
+
+  uint32_t lines() const { return lines_; }
+
+private:
+  void append(const uint8_t* p, size_t n) {
+    size_t room = (kIcsLineMax - 1) - len_;
+    if (n > room) n = room;  // truncate overlong lines (e.g. DESCRIPTION), keep the head
+    memcpy(line_ + len_, p, n);
+    len_ += n;
+  }
+
+  template<typename Fn>
+  bool emit(Fn onLine) {
+    if (len_ == 0) return true;
+    line_[len_] = 0;
+    IcsLine ln;
+    ln.offset = lineStart_;
+    split(ln);
+    len_ = 0;
+    lines_++;
+    return onLine((const IcsLine&)ln);
+  }
+
+  // NAME[;PARAM=...[;...]]:VALUE — a ':' inside a quoted parameter value does not end params
+  void split(IcsLine& ln) const {
+    size_t i = 0;
+    while (i < len_ && line_[i] != ':' && line_[i] != ';') ++i;
+    ln.name = line_; ln.nameLen = i;
+    ln.params = line_ + i; ln.paramsLen = 0;
+    if (i < len_ && line_[i] == ';') {
+      size_t ps = ++i; bool quoted = false;
+      while (i < len_ && (quoted || line_[i] != ':')) { if (line_[i] == '"') quoted = !quoted; ++i; }
+      ln.params = line_ + ps; ln.paramsLen = i - ps;
+    }
+    if (i < len_) ++i;  // skip ':'
+    ln.value = line_ + i; ln.valueLen = len_ - i;
+  }
+
+  char     line_[kIcsLineMax];
+  size_t   len_{0};
+  bool     pendingEol_{false};
+  uint32_t lines_{0};
+  uint32_t consumed_{0};   // bytes fed before the current feed() call
+  uint32_t lineStart_{0};  // offset of the line being collected
+};
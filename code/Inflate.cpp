@@ -0,0 +1,155 @@
+// Inflate.cpp
+#include "Inflate.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef ARDUINO
+  #include <Arduino.h>
+#endif
+#ifdef ESP32
+  #include <rom/miniz.h>   // tinfl lives in the ESP32 ROM
+#else
+  #include <miniz.h>
+#endif
+
+static const size_t kDictSize = TINFL_LZ_DICT_SIZE;  // tinfl needs a power of two >= 32 KB to wrap
+static const size_t kTailDrainMax = 64;  // after the stream: gzip trailer (8) plus slack
+
+// gzip FLG bits
+static const uint8_t kGzExtra = 0x04, kGzName = 0x08, kGzComment = 0x10, kGzHcrc = 0x02;
+
+ContentCoding parseContentCoding(const char* h) {
+  if (!h || !*h) return ContentCoding::Identity;
+  if (strstr(h, "gzip")) return ContentCoding::Gzip;   // also "x-gzip"
+  if (strstr(h, "deflate")) return ContentCoding::Deflate;
+  return ContentCoding::Identity;
+}
+
+// Internal RAM first (back references hit the dictionary randomly), PSRAM as fallback
+static void* allocWork(size_t n) {
+  void* p = malloc(n);
+#ifdef ARDUINO
+  if (!p && psramFound()) p = ps_malloc(n);
+#endif
+  return p;
+}
+
+InflateSource::~InflateSource() {
+  free(decomp_); free(dict_);
+}
+
+bool InflateSource::begin(IcsByteSource* src, ContentCoding coding) {
+  if (!decomp_) decomp_ = allocWork(sizeof(tinfl_decompressor));
+  if (!dict_)   dict_   = (uint8_t*)allocWork(kDictSize);
+  if (!decomp_ || !dict_) return false;
+
+  src_ = src;
+  tinfl_init((tinfl_decompressor*)decomp_);
+  dictOfs_ = outPos_ = outLen_ = 0;
+  inPos_ = inLen_ = 0;
+  srcEnd_ = done_ = failed_ = false;
+  inTotal_ = 0;
+  flags_ = 0;
+  hdrStage_ = 0;
+  if (coding == ContentCoding::Gzip) { hdrStage_ = 1; hdrLeft_ = 10; }
+  sniff_ = (coding == ContentCoding::Deflate);
+  return true;
+}
+
+bool InflateSource::fill() {
+  inPos_ = inLen_ = 0;
+  int got = src_->read(in_, sizeof(in_));
+  if (got < 0) return false;
+  if (got == 0) { srcEnd_ = true; return true; }
+  inLen_ = (size_t)got;
+  inTotal_ += (uint32_t)got;
+  return true;
+}
+
+int InflateSource::takeByte() {
+  if (inPos_ == inLen_ && (srcEnd_ || !fill() || inLen_ == 0)) return -1;
+  return in_[inPos_++];
+}
+
+// Read past the end of the deflate stream (gzip CRC32 + ISIZE, the chunked terminator) up
+// to the end of the body, so the session sees it complete and keeps the connection.
+// More than kTailDrainMax bytes is left unread: the session drops that connection instead.
+void InflateSource::drainTail() {
+  size_t left = kTailDrainMax;
+  while (!srcEnd_ && left > 0) {
+    const int got = src_->read(in_, left < sizeof(in_) ? left : sizeof(in_));
+    if (got <= 0) break;
+    inTotal_ += (uint32_t)got;
+    left -= (size_t)got;
+  }
+  inPos_ = inLen_ = 0;
+}
+
+// RFC 1952 member header; false when it is malformed or the body ends inside it
+bool InflateSource::skipGzipHeader() {
+  while (hdrStage_) {
+    int c = takeByte();
+    if (c < 0) return false;
+    switch (hdrStage_) {
+      case 1:  // ID1 ID2 CM FLG MTIME(4) XFL OS
+        if ((hdrLeft_ == 10 && c != 0x1f) || (hdrLeft_ == 9 && c != 0x8b) || (hdrLeft_ == 8 && c != 8)) return false;
+        if (hdrLeft_ == 7) hdrFlags_ = (uint8_t)c;
+        if (--hdrLeft_ == 0) { hdrStage_ = 2; hdrLeft_ = 2; xlen_ = 0; }
+        break;
+      case 2:  // XLEN (little endian), only with FEXTRA
+        if (!(hdrFlags_ & kGzExtra)) { hdrStage_ = 4; inPos_--; break; }
+        xlen_ |= (uint16_t)(c << (hdrLeft_ == 2 ? 0 : 8));
+        if (--hdrLeft_ == 0) { hdrStage_ = 3; hdrLeft_ = xlen_; if (!hdrLeft_) hdrStage_ = 4; }
+        break;
+      case 3:
+        if (--hdrLeft_ == 0) hdrStage_ = 4;
+        break;
+      case 4:  // zero-terminated name
+        if (!(hdrFlags_ & kGzName) || c == 0) hdrStage_ = 5;
+        if (!(hdrFlags_ & kGzName)) inPos_--;
+        break;
+      case 5:  // zero-terminated comment
+        if (!(hdrFlags_ & kGzComment) || c == 0) { hdrStage_ = 6; hdrLeft_ = 2; }
+        if (!(hdrFlags_ & kGzComment)) inPos_--;
+        break;
+      case 6:  // header CRC16
+        if (!(hdrFlags_ & kGzHcrc)) { inPos_--; hdrStage_ = 0; break; }
+        if (--hdrLeft_ == 0) hdrStage_ = 0;
+        break;
+    }
+  }
+  return true;
+}
+
+int InflateSource::read(uint8_t* dst, size_t n) {
+  while (outLen_ == 0) {
+    if (done_) return 0;
+    if (failed_) return -1;
+    if (hdrStage_ && !skipGzipHeader()) { failed_ = true; continue; }
+    if (inPos_ == inLen_ && !srcEnd_ && !fill()) { failed_ = true; continue; }
+    if (sniff_ && inPos_ < inLen_) {
+      // "deflate" is meant to be zlib-wrapped, but some servers send raw deflate
+      const uint8_t cmf = in_[inPos_];
+      if ((cmf & 0x0F) == 8 && (cmf >> 4) <= 7) flags_ |= TINFL_FLAG_PARSE_ZLIB_HEADER;
+      sniff_ = false;
+    }
+
+    size_t inAvail = inLen_ - inPos_;
+    size_t outAvail = kDictSize - dictOfs_;  // one call never wraps, so the output is contiguous
+    const uint32_t fl = flags_ | (srcEnd_ ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+    tinfl_status st = tinfl_decompress((tinfl_decompressor*)decomp_, in_ + inPos_, &inAvail,
+                                       dict_, dict_ + dictOfs_, &outAvail, fl);
+    inPos_ += inAvail;
+    outPos_ = dictOfs_;
+    outLen_ = outAvail;
+    dictOfs_ = (dictOfs_ + outAvail) & (kDictSize - 1);
+
+    if (st == TINFL_STATUS_DONE) { done_ = true; drainTail(); }  // trailer is not checked
+    else if (st < 0) failed_ = true;
+    else if (st == TINFL_STATUS_NEEDS_MORE_INPUT && srcEnd_) failed_ = true;  // truncated stream
+  }
+  if (n > outLen_) n = outLen_;
+  memcpy(dst, dict_ + outPos_, n);
+  outPos_ += n;
+  outLen_ -= n;
+  return (int)n;
+}
@@ -0,0 +1,51 @@
+// Inflate.h
+// Streaming gzip / zlib / raw-deflate decoder as an IcsByteSource filter
+// - ROM tinfl on the ESP32 (miniz), one 32 KB wrapping dictionary, no per-body allocation
+// - Parses the gzip member header itself (FEXTRA/FNAME/FCOMMENT/FHCRC); the trailer is read
+//   to the body end unchecked, so the connection stays reusable
+// - Decoded bytes come out in whatever chunk sizes the caller asks for
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "IcsParser.h"
+
+enum class ContentCoding : uint8_t { Identity, Gzip, Deflate };
+
+// "gzip", "x-gzip", "deflate"; anything else (or empty) is identity
+ContentCoding parseContentCoding(const char* header);
+
+class InflateSource : public IcsByteSource {
+public:
+  ~InflateSource();
+  // Working memory (~43 KB) is taken on first use and kept; false when it cannot be had
+  bool begin(IcsByteSource* src, ContentCoding coding);
+  int  read(uint8_t* dst, size_t n) override;
+
+  uint32_t inBytes() const { return inTotal_; }    // compressed bytes pulled from src
+
+private:
+  bool fill();
+  int  takeByte();
+  bool skipGzipHeader();
+  void drainTail();
+
+  IcsByteSource* src_{nullptr};
+  void*    decomp_{nullptr};  // tinfl_decompressor
+  uint8_t* dict_{nullptr};    // TINFL_LZ_DICT_SIZE, wraps
+  size_t   dictOfs_{0};       // next write position in dict_
+  size_t   outPos_{0}, outLen_{0};  // undelivered output inside dict_
+  uint8_t  in_[512];
+  size_t   inPos_{0}, inLen_{0};
+  bool     srcEnd_{false};
+  bool     done_{false};
+  bool     failed_{false};
+  bool     sniff_{false};     // deflate: zlib header or raw?
+  uint32_t flags_{0};
+  uint32_t inTotal_{0};
+
+  // gzip member header, skipped byte by byte (it may straddle reads)
+  uint8_t  hdrStage_{0};      // 0 done, 1 fixed, 2 xlen, 3 extra, 4 name, 5 comment, 6 hcrc
+  uint32_t hdrLeft_{0};
+  uint8_t  hdrFlags_{0};
+  uint16_t xlen_{0};
+};
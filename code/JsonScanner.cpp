@@ -0,0 +1,160 @@
+// JsonScanner.cpp
+#include "JsonScanner.h"
+#include <string.h>
+
+static const int kNestMax = 32;  // one bit of arrays_ per level
+
+static bool isWs(uint8_t c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+static bool isScalarChar(uint8_t c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+void JsonScanner::begin(OnValue cb, void* ctx) {
+  cb_ = cb; ctx_ = ctx;
+  st_ = St::Value;
+  depth_ = 0; arrays_ = 0;
+  klen_ = 0; vlen_ = 0; hex_ = 0;
+}
+
+bool JsonScanner::feed(const uint8_t* p, size_t n) {
+  for (size_t i = 0; i < n && st_ != St::Error; ++i)
+    if (!step(p[i])) st_ = St::Error;
+  return st_ != St::Error;
+}
+
+const char* JsonScanner::key(int level) const {
+  return (level >= 0 && level < depth_ && level < kJsonMaxDepth) ? lv_[level].key : "";
+}
+
+int JsonScanner::index(int level) const {
+  return (level >= 0 && level < depth_ && level < kJsonMaxDepth) ? lv_[level].index : -1;
+}
+
+bool JsonScanner::keyIs(int level, const char* k) const {
+  return strcmp(key(level), k) == 0;
+}
+
+bool JsonScanner::push(bool array) {
+  if (depth_ >= kNestMax) return false;
+  if (array) arrays_ |= (1u << depth_); else arrays_ &= ~(1u << depth_);
+  if (depth_ < kJsonMaxDepth) { lv_[depth_].key[0] = 0; lv_[depth_].index = array ? 0 : -1; }
+  depth_++;
+  return true;
+}
+
+bool JsonScanner::pop(bool array) {
+  if (depth_ == 0 || (((arrays_ >> (depth_ - 1)) & 1u) != 0) != array) return false;
+  depth_--;
+  endValue();  // the closed container was a value of its parent
+  return true;
+}
+
+void JsonScanner::endValue() {
+  st_ = depth_ ? St::After : St::Done;
+}
+
+void JsonScanner::append(uint8_t c) {
+  if (vlen_ + 1 < kJsonValueLen) val_[vlen_++] = (char)c;
+}
+
+void JsonScanner::emit(bool isString) {
+  val_[vlen_] = 0;
+  if (cb_) cb_(ctx_, *this, val_, isString);
+}
+
+bool JsonScanner::step(uint8_t c) {
+  switch (st_) {
+    case St::Value:
+      if (isWs(c)) return true;
+      if (c == '{') { if (!push(false)) return false; st_ = St::KeyOrEnd; return true; }
+      if (c == '[') { if (!push(true)) return false; st_ = St::ValueOrEnd; return true; }
+      vlen_ = 0;
+      if (c == '"') { st_ = St::Str; return true; }
+      if (!isScalarChar(c)) return false;
+      append(c);
+      st_ = St::Scalar;
+      return true;
+
+    case St::ValueOrEnd:  // right after '['
+      if (isWs(c)) return true;
+      if (c == ']') return pop(true);
+      st_ = St::Value;
+      return step(c);
+
+    case St::KeyOrEnd:  // right after '{' or ','
+      if (isWs(c)) return true;
+      if (c == '}') return pop(false);
+      if (c != '"') return false;
+      klen_ = 0;
+      if (depth_ - 1 < kJsonMaxDepth) lv_[depth_ - 1].key[0] = 0;
+      st_ = St::Key;
+      return true;
+
+    case St::Key:
+    case St::KeyEsc: {
+      if (st_ == St::Key && c == '\\') { st_ = St::KeyEsc; return true; }
+      if (st_ == St::Key && c == '"') { st_ = St::Colon; return true; }
+      st_ = St::Key;
+      const int d = depth_ - 1;
+      if (d < kJsonMaxDepth && klen_ + 1 < kJsonKeyLen) {
+        lv_[d].key[klen_++] = (char)c;
+        lv_[d].key[klen_] = 0;
+      }
+      return true;
+    }
+
+    case St::Colon:
+      if (isWs(c)) return true;
+      if (c != ':') return false;
+      st_ = St::Value;
+      return true;
+
+    case St::Str:
+      if (c == '\\') { st_ = St::StrEsc; return true; }
+      if (c == '"') { emit(true); endValue(); return true; }
+      append(c);
+      return true;
+
+    case St::StrEsc:
+      st_ = St::Str;
+      switch (c) {
+        case 'n': append('\n'); break;
+        case 't': append('\t'); break;
+        case 'r': case 'b': case 'f': break;
+        case 'u': append('?'); hex_ = 4; st_ = St::StrHex; break;
+        default:  append(c); break;  // \" \\ \/
+      }
+      return true;
+
+    case St::StrHex:
+      if (--hex_ == 0) st_ = St::Str;
+      return true;
+
+    case St::Scalar:
+      if (isScalarChar(c)) { append(c); return true; }
+      emit(false);
+      endValue();
+      return step(c);  // the terminator belongs to the container
+
+    case St::After:
+      if (isWs(c)) return true;
+      if (c == ',') {
+        const int d = depth_ - 1;
+        const bool array = (arrays_ >> d) & 1u;
+        if (array && d < kJsonMaxDepth) lv_[d].index++;
+        st_ = array ? St::Value : St::KeyOrEnd;
+        return true;
+      }
+      if (c == '}') return pop(false);
+      if (c == ']') return pop(true);
+      return false;
+
+    case St::Done:
+      return isWs(c);
+
+    case St::Error:
+      return false;
+  }
+  return false;
+}
@@ -0,0 +1,58 @@
+// JsonScanner.h
+// Streaming, allocation-free JSON scanner (pull only the fields you need)
+// - Fed in arbitrary chunks straight from the socket; never holds the document
+// - Tracks the member key / array index of the first kJsonMaxDepth levels
+// - Calls back once per scalar (string, number, true/false/null) with its text;
+//   strings are unescaped (\uXXXX becomes '?'), values longer than the buffer truncated
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// ---- Tunables ----
+static const int    kJsonMaxDepth = 4;   // levels with key/index tracking (nesting itself may go to 32)
+static const size_t kJsonKeyLen   = 32;  // member key bytes per level, incl. NUL
+static const size_t kJsonValueLen = 48;  // scalar text bytes, incl. NUL
+
+class JsonScanner {
+public:
+  // v is NUL-terminated; isString tells "null" from null
+  typedef void (*OnValue)(void* ctx, const JsonScanner& at, const char* v, bool isString);
+
+  void begin(OnValue cb, void* ctx);
+  // false once the input is malformed (the scanner then ignores the rest)
+  bool feed(const uint8_t* p, size_t n);
+  bool done() const { return st_ == St::Done; }  // root value complete
+  bool failed() const { return st_ == St::Error; }
+
+  // Path of the current value: level 0 is the root container
+  int depth() const { return depth_; }
+  const char* key(int level) const;  // "" for arrays and untracked levels
+  int index(int level) const;        // array position, -1 for objects
+  bool keyIs(int level, const char* k) const;
+
+private:
+  enum class St : uint8_t { Value, ValueOrEnd, KeyOrEnd, Key, KeyEsc, Colon, Str, StrEsc, StrHex,
+                            Scalar, After, Done, Error };
+  struct Level {
+    char    key[kJsonKeyLen];
+    int16_t index;  // -1: object
+  };
+
+  bool step(uint8_t c);
+  bool push(bool array);
+  bool pop(bool array);
+  void endValue();
+  void emit(bool isString);
+  void append(uint8_t c);
+
+  OnValue cb_{nullptr};
+  void*   ctx_{nullptr};
+  St      st_{St::Value};
+  int     depth_{0};
+  uint32_t arrays_{0};  // bit d: container at depth d is an array
+  Level   lv_[kJsonMaxDepth];
+  size_t  klen_{0};
+  char    val_[kJsonValueLen];
+  size_t  vlen_{0};
+  uint8_t hex_{0};
+};
@@ -0,0 +1,35 @@
+// MasterFrame.cpp
+#include "MasterFrame.h"
+#include "GhostBudget.h"
+#include <string.h>
+
+static UBYTE* gFrame = nullptr;
+static UWORD  gFrameW = 0, gFrameH = 0;
+static bool   gComposeOnly = false;
+
+void masterFrameAttach(UBYTE* fb, UWORD w, UWORD h) {
+  gFrame = fb; gFrameW = w; gFrameH = h;
+}
+
+UBYTE* masterFrame() { return gFrame; }
+
+void masterFrameBlit(const UBYTE* src, int x, int y, int w, int h) {
+  if (!gFrame || !src || x < 0 || y < 0 || x >= gFrameW || y >= gFrameH) return;
+  const int dstRow = (gFrameW + 7) / 8;
+  const int srcRow = (w + 7) / 8;
+  const int bx = x / 8;
+  const int n = (bx + srcRow > dstRow) ? dstRow - bx : srcRow;
+  if (y + h > gFrameH) h = gFrameH - y;
+  uint32_t flipped = 0;
+  for (int r = 0; r < h; ++r) {
+    UBYTE* d = gFrame + (size_t)(y + r) * dstRow + bx;
+    const UBYTE* s = src + (size_t)r * srcRow;
+    if (!gComposeOnly)  // a composed frame goes out as a full refresh: no ghosting to count
+      for (int i = 0; i < n; ++i) flipped += (uint32_t)__builtin_popcount((unsigned)(d[i] ^ s[i]));
+    memcpy(d, s, n);
+  }
+  ghostNote(x, y, flipped);
+}
+
+void masterFrameSetComposeOnly(bool on) { gComposeOnly = on; }
+bool masterFrameComposeOnly() { return gComposeOnly; }
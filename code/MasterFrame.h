@@ -0,0 +1,17 @@
+// MasterFrame.h
+// Composited full-screen frame (FBFull): every partial render is also copied into it,
+// so a full refresh pushes one finished frame instead of chrome + partial passes
+#pragma once
+#include "DEV_Config.h"
+
+void masterFrameAttach(UBYTE* fb, UWORD w, UWORD h);
+UBYTE* masterFrame();
+
+// Copy a rendered region (rows of ceil(w/8) bytes) to screen position (x, y).
+// x is taken down to a byte boundary: the panel places partial windows the same way.
+// Outside composition the pixels it changes are charged to the region (GhostBudget).
+void masterFrameBlit(const UBYTE* src, int x, int y, int w, int h);
+
+// While composing, regions only update the master frame and skip their partial push
+void masterFrameSetComposeOnly(bool on);
+bool masterFrameComposeOnly();
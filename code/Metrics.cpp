@@ -0,0 +1,152 @@
+// Metrics.cpp
+#include "Metrics.h"
+#include "AppConfig.h"
+#include <Arduino.h>
+#include <stdarg.h>
+
+#if METRICS_HTTP
+  #include <WiFi.h>
+  #include <WebServer.h>
+#endif
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// Network phases are recorded by every calendar source task at once (CompositeCalendar)
+#ifdef ESP32
+  #include <freertos/FreeRTOS.h>
+  static portMUX_TYPE gMetricsLock = portMUX_INITIALIZER_UNLOCKED;
+  #define METRICS_LOCK()   portENTER_CRITICAL(&gMetricsLock)
+  #define METRICS_UNLOCK() portEXIT_CRITICAL(&gMetricsLock)
+#else
+  #define METRICS_LOCK()
+  #define METRICS_UNLOCK()
+#endif
+
+// ---- Tunables ----
+static const size_t   kJsonMax      = 1536;  // /metrics response buffer
+static const uint16_t kMetricsPort  = 80;
+
+static const char* kPhaseNames[(int)Phase::Count] = {
+  "wifi_connect", "ntp_sync",
+  "dns", "tls_handshake", "first_byte", "transfer", "parse",
+  "render_clock", "render_weather", "render_calendar", "render_plants",
+  "epd_partial", "epd_full",
+};
+
+static PhaseStats gPhases[(int)Phase::Count];
+static uint32_t gMinFreeHeap = 0xFFFFFFFFu;
+static uint32_t gMinLargestBlock = 0xFFFFFFFFu;
+
+void metricsRecord(Phase p, uint32_t us, uint32_t bytes) {
+  METRICS_LOCK();
+  PhaseStats& s = gPhases[(int)p];
+  if (s.n == 0 || us < s.minUs) s.minUs = us;
+  if (us > s.maxUs) s.maxUs = us;
+  s.lastUs = us;
+  s.sumUs += us;
+  s.bytes += bytes;
+  s.n++;
+  METRICS_UNLOCK();
+  metricsSampleHeap();
+}
+
+PhaseStats metricsPhase(Phase p) {
+  METRICS_LOCK();
+  PhaseStats s = gPhases[(int)p];
+  METRICS_UNLOCK();
+  return s;
+}
+const char* metricsPhaseName(Phase p) { return kPhaseNames[(int)p]; }
+
+void metricsSampleHeap() {
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t largest  = ESP.getMaxAllocHeap();
+  METRICS_LOCK();
+  if (freeHeap < gMinFreeHeap) gMinFreeHeap = freeHeap;
+  if (largest < gMinLargestBlock) gMinLargestBlock = largest;
+  METRICS_UNLOCK();
+}
+
+// bytes/s over all recorded runs of a data phase
+static uint32_t throughput(const PhaseStats& s) {
+  return s.sumUs ? (uint32_t)(s.bytes * 1000000ULL / s.sumUs) : 0;
+}
+
+void metricsDump() {
+  metricsSampleHeap();
+  DBG("[MET] %-16s %6s %9s %9s %9s %9s %10s\n", "phase", "n", "last_ms", "min_ms", "avg_ms", "max_ms", "B/s");
+  for (int i = 0; i < (int)Phase::Count; ++i) {
+    const PhaseStats s = metricsPhase((Phase)i);
+    if (!s.n) continue;
+    DBG("[MET] %-16s %6u %9.1f %9.1f %9.1f %9.1f %10u\n", kPhaseNames[i], (unsigned)s.n,
+        s.lastUs / 1000.0, s.minUs / 1000.0, (double)s.sumUs / s.n / 1000.0, s.maxUs / 1000.0,
+        (unsigned)throughput(s));
+  }
+  DBG("[MET] heap free=%u (min %u) largest=%u (min %u)\n", (unsigned)ESP.getFreeHeap(),
+      (unsigned)gMinFreeHeap, (unsigned)ESP.getMaxAllocHeap(), (unsigned)gMinLargestBlock);
+}
+
+// Appends printf-style into a fixed buffer; output past the end is dropped
+struct JsonOut {
+  char*  out;
+  size_t n, o;
+  void put(const char* fmt, ...) {
+    if (o >= n) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(out + o, n - o, fmt, ap);
+    va_end(ap);
+    if (w > 0) o = (o + (size_t)w < n) ? o + (size_t)w : n - 1;
+  }
+};
+
+size_t metricsJson(char* out, size_t n) {
+  if (!out || n == 0) return 0;
+  metricsSampleHeap();
+  JsonOut j{ out, n, 0 };
+  j.put("{\"uptime_ms\":%lu,\"heap\":{\"free\":%u,\"min_free\":%u,\"largest\":%u,\"min_largest\":%u},\"phases\":{",
+      (unsigned long)millis(), (unsigned)ESP.getFreeHeap(), (unsigned)gMinFreeHeap,
+      (unsigned)ESP.getMaxAllocHeap(), (unsigned)gMinLargestBlock);
+  bool first = true;
+  for (int i = 0; i < (int)Phase::Count; ++i) {
+    const PhaseStats s = metricsPhase((Phase)i);
+    if (!s.n) continue;
+    j.put("%s\"%s\":{\"n\":%u,\"last_us\":%u,\"min_us\":%u,\"avg_us\":%u,\"max_us\":%u,\"bytes\":%llu,\"bps\":%u}",
+        first ? "" : ",", kPhaseNames[i], (unsigned)s.n, (unsigned)s.lastUs, (unsigned)s.minUs,
+        (unsigned)(s.sumUs / s.n), (unsigned)s.maxUs, (unsigned long long)s.bytes, (unsigned)throughput(s));
+    first = false;
+  }
+  j.put("}}");
+  return j.o;
+}
+
+#if METRICS_HTTP
+static WebServer* gServer = nullptr;
+
+static void serveMetrics() {
+  static char buf[kJsonMax];
+  metricsJson(buf, sizeof(buf));
+  gServer->send(200, "application/json", buf);
+}
+#endif
+
+void metricsPoll() {
+  // 'm' on the serial console dumps the table
+  while (Serial.available() > 0) {
+    if (Serial.read() == 'm') metricsDump();
+  }
+#if METRICS_HTTP
+  if (!gServer && WiFi.status() == WL_CONNECTED) {
+    gServer = new WebServer(kMetricsPort);
+    gServer->on("/metrics", serveMetrics);
+    gServer->begin();
+    DBG("[MET] serving http://%s/metrics\n", WiFi.localIP().toString().c_str());
+  }
+  if (gServer) gServer->handleClient();
+#endif
+}
+
+PhaseTimer::PhaseTimer(Phase p) : p_(p), t0_((uint32_t)micros()) {}
+PhaseTimer::~PhaseTimer() { metricsRecord(p_, (uint32_t)micros() - t0_, bytes_); }
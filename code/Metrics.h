@@ -0,0 +1,53 @@
+// Metrics.h
+// Always-on phase timing and heap watermarks
+// - Fixed phase table: count / last / min / avg / max in microseconds, no allocation
+// - Byte counters for phases that move data (transfer, parse) give throughput
+// - Dump over serial ('m' on the console or metricsDump()), optional JSON on
+//   http://<ip>/metrics (METRICS_HTTP in AppConfig.h)
+// Records and reads go through a spinlock: the calendar source tasks record the
+// network phases concurrently, the loop records render/EPD and dumps.
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+enum class Phase : uint8_t {
+  WifiConnect, NtpSync,
+  Dns, TlsHandshake, FirstByte, Transfer, Parse,
+  RenderClock, RenderWeather, RenderCalendar, RenderPlants,
+  EpdPartial, EpdFull,
+  Count
+};
+
+struct PhaseStats {
+  uint32_t n{0};
+  uint32_t lastUs{0}, minUs{0}, maxUs{0};
+  uint64_t sumUs{0};
+  uint64_t bytes{0};  // data moved inside the phase (0 for pure timing phases)
+};
+
+void metricsRecord(Phase p, uint32_t us, uint32_t bytes = 0);
+PhaseStats metricsPhase(Phase p);  // consistent copy
+const char* metricsPhaseName(Phase p);
+
+// Heap: sampled at every record and on demand
+void metricsSampleHeap();
+
+void metricsDump();
+// JSON snapshot into out (always NUL-terminated); returns the length written
+size_t metricsJson(char* out, size_t n);
+
+// Call periodically from the render loop: serial command + HTTP endpoint
+void metricsPoll();
+
+// Times the enclosing scope
+class PhaseTimer {
+public:
+  explicit PhaseTimer(Phase p);
+  ~PhaseTimer();
+  void addBytes(uint32_t n) { bytes_ += n; }
+
+private:
+  Phase    p_;
+  uint32_t t0_;
+  uint32_t bytes_{0};
+};
@@ -0,0 +1,14 @@
+// Panel.h
+// Common interface of everything that owns a screen region (clock, weather, calendar, plants)
+#pragma once
+#include "DirtyRegion.h"
+
+class IPanel {
+public:
+  virtual ~IPanel() {}
+  // Render and push unconditionally (after a clear or a full refresh)
+  virtual void begin() = 0;
+  // Refresh from current data; nothing is pushed when the content did not change
+  virtual void tick() = 0;
+  virtual RegionStats stats() const { return RegionStats(); }
+};
@@ -0,0 +1,275 @@
+// PanelRender.cpp
+#include "PanelRender.h"
+#include "DisplayBackend.h"
+#include "TextRenderer.h"
+#include "fonts.h"
+#include <stdio.h>
+#include "UiLayout.h"
+
+// ---- Weather icon helpers ----
+static void drawSunIcon(int x, int y, int size) {
+  int cx = x + size / 2;
+  int cy = y + size / 2;
+  int r = size / 3;
+  int ray = r + size / 6;
+
+  gfx()->circle(cx, cy, r, kGfxBlack, kGfxDot1, GfxFill::Empty);
+
+  // cardinal rays (thin rectangles)
+  gfx()->rect(cx - 1, cy - ray, cx + 1, cy - r - 2, kGfxBlack, kGfxDot1,
+              GfxFill::Full);
+  gfx()->rect(cx - 1, cy + r + 2, cx + 1, cy + ray, kGfxBlack, kGfxDot1,
+              GfxFill::Full);
+  gfx()->rect(cx - ray, cy - 1, cx - r - 2, cy + 1, kGfxBlack, kGfxDot1,
+              GfxFill::Full);
+  gfx()->rect(cx + r + 2, cy - 1, cx + ray, cy + 1, kGfxBlack, kGfxDot1,
+              GfxFill::Full);
+
+  // diagonal rays (small squares)
+  int diag = (ray * 7) / 10;
+  gfx()->rect(cx - diag, cy - diag, cx - diag + 2, cy - diag + 2, kGfxBlack,
+              kGfxDot1, GfxFill::Full);
+  gfx()->rect(cx + diag - 2, cy - diag, cx + diag, cy - diag + 2, kGfxBlack,
+              kGfxDot1, GfxFill::Full);
+  gfx()->rect(cx - diag, cy + diag - 2, cx - diag + 2, cy + diag, kGfxBlack,
+              kGfxDot1, GfxFill::Full);
+  gfx()->rect(cx + diag - 2, cy + diag - 2, cx + diag, cy + diag, kGfxBlack,
+              kGfxDot1, GfxFill::Full);
+}
+
+static void drawCloudIcon(int x, int y, int size) {
+  int baseY = y + size / 2 + 6;
+  int rSmall = size / 5;
+  int rMed = rSmall + 4;
+  int rLarge = rMed + 4;
+  int left = x + 8;
+
+  gfx()->circle(left, baseY, rMed, kGfxBlack, kGfxDot1, GfxFill::Empty);
+  gfx()->circle(left + rMed + rSmall, baseY - rSmall, rLarge, kGfxBlack,
+                kGfxDot1, GfxFill::Empty);
+  gfx()->circle(left + rMed + rSmall + rLarge, baseY, rMed, kGfxBlack,
+                kGfxDot1, GfxFill::Empty);
+  gfx()->rect(left - rSmall, baseY, left + rMed + rSmall + rLarge + rMed,
+              baseY + rSmall, kGfxBlack, kGfxDot1, GfxFill::Empty);
+}
+
+static void drawWeatherConditionIcon(int x, int y, int size, WeatherIcon icon) {
+  switch (icon) {
+    case WeatherIcon_Sun:
+      drawSunIcon(x, y, size);
+      break;
+    case WeatherIcon_Partly:
+      drawSunIcon(x + size / 5, y, size * 3 / 4);
+      drawCloudIcon(x, y + size / 4, size);
+      break;
+    case WeatherIcon_Rain:
+      drawCloudIcon(x, y + size / 5, size);
+      for (int i = 0; i < 3; i++) {
+        int dropX = x + 16 + i * 12;
+        int top = y + size - 28;
+        gfx()->rect(dropX, top, dropX + 2, top + 10, kGfxBlack,
+                    kGfxDot1, GfxFill::Full);
+      }
+      break;
+    case WeatherIcon_Storm:
+      drawCloudIcon(x, y + size / 5, size);
+      gfx()->line(x + size / 2, y + size - 26, x + size / 2 - 10,
+                  y + size - 10, kGfxBlack, kGfxDot1, GfxStyle::Solid);
+      gfx()->line(x + size / 2 - 10, y + size - 10, x + size / 2 + 2,
+                  y + size - 10, kGfxBlack, kGfxDot1, GfxStyle::Solid);
+      gfx()->line(x + size / 2 + 2, y + size - 10, x + size / 2 - 8,
+                  y + size, kGfxBlack, kGfxDot1, GfxStyle::Solid);
+      break;
+  }
+}
+
+static void drawThermometerSymbol(int x, int y) {
+  int bulbR = 6;
+  int stemTop = y;
+  int stemBottom = y + 16;
+  int cx = x + bulbR;
+
+  gfx()->rect(cx - 2, stemTop, cx + 2, stemBottom, kGfxBlack, kGfxDot1,
+              GfxFill::Empty);
+  gfx()->circle(cx, stemBottom + bulbR, bulbR, kGfxBlack, kGfxDot1,
+                GfxFill::Empty);
+  gfx()->rect(cx - 4, stemBottom - 4, cx + 4, stemBottom, kGfxBlack,
+              kGfxDot1, GfxFill::Full);
+}
+
+static void drawWindSymbol(int x, int y) {
+  for (int i = 0; i < 3; i++) {
+    int yLine = y + 4 + i * 6;
+    gfx()->line(x, yLine, x + 16, yLine, kGfxBlack, kGfxDot1,
+                GfxStyle::Solid);
+    gfx()->line(x + 16, yLine, x + 20, yLine - 2, kGfxBlack, kGfxDot1,
+                GfxStyle::Solid);
+  }
+}
+
+static void drawHumiditySymbol(int x, int y) {
+  int cx = x + 8;
+  gfx()->line(cx, y, cx - 6, y + 10, kGfxBlack, kGfxDot1, GfxStyle::Solid);
+  gfx()->line(cx, y, cx + 6, y + 10, kGfxBlack, kGfxDot1, GfxStyle::Solid);
+  gfx()->circle(cx, y + 16, 6, kGfxBlack, kGfxDot1, GfxFill::Empty);
+}
+
+static void drawPrecipSymbol(int x, int y) {
+  int top = y + 6;
+  gfx()->line(x + 2, top, x + 20, top, kGfxBlack, kGfxDot1,
+              GfxStyle::Solid);
+  gfx()->line(x + 2, top, x + 6, top - 6, kGfxBlack, kGfxDot1,
+              GfxStyle::Solid);
+  gfx()->line(x + 16, top - 6, x + 20, top, kGfxBlack, kGfxDot1,
+              GfxStyle::Solid);
+  gfx()->line(x + 11, top, x + 11, top + 14, kGfxBlack, kGfxDot1,
+              GfxStyle::Solid);
+  gfx()->line(x + 8, top + 4, x + 8, top + 10, kGfxBlack, kGfxDot1,
+              GfxStyle::Solid);
+  gfx()->line(x + 14, top + 4, x + 14, top + 10, kGfxBlack, kGfxDot1,
+              GfxStyle::Solid);
+}
+
+static void drawUvSymbol(int x, int y) {
+  drawSunIcon(x, y, 22);
+  drawText(x + 4, y + 24, "UV", &Font16, kGfxWhite, kGfxBlack);
+}
+
+// ---- UI drawing ----
+static void drawSectionTitle(int x, int y, const char* txt) {
+  drawText(x, y, txt, &Font20, kGfxWhite, kGfxBlack);
+}
+
+void renderStaticUI(uint8_t* image) {
+  gfx()->select(image, W, H);
+  gfx()->clear(kGfxWhite);
+
+  // Header bar
+  gfx()->rect(HDR_X, HDR_Y, HDR_X + HDR_W - 1, HDR_Y + HDR_H - 1,
+              kGfxBlack, kGfxDot1, GfxFill::Empty);
+  drawText(HDR_X + 10, HDR_Y + 12, "Niklas Dathe", &Font20, kGfxWhite, kGfxBlack);
+  // Clock box outline
+  gfx()->rect(PRT_CLK_X - 6, PRT_CLK_Y - 4, PRT_CLK_X + PRT_CLK_W + 6, PRT_CLK_Y + PRT_CLK_H + 4,
+              kGfxBlack, kGfxDot1, GfxFill::Empty);
+
+  // Left column
+  gfx()->rect(COL_L_X, COL_L_Y, COL_L_X + COL_L_W, COL_L_Y + COL_L_H,
+              kGfxBlack, kGfxDot1, GfxFill::Empty);
+  drawSectionTitle(COL_L_X + 10, COL_L_Y + 4, "TODAY'S WEATHER");
+
+  // Right column
+  gfx()->rect(COL_R_X, COL_R_Y, COL_R_X + COL_R_W, COL_R_Y + COL_R_H,
+              kGfxBlack, kGfxDot1, GfxFill::Empty);
+  drawSectionTitle(COL_R_X + 10, COL_R_Y + 4, "GOOGLE CALENDAR");
+
+  // Bottom
+  gfx()->rect(BOT_X, BOT_Y, BOT_X + BOT_W, BOT_Y + BOT_H,
+              kGfxBlack, kGfxDot1, GfxFill::Empty);
+  drawSectionTitle(BOT_X + 10, BOT_Y + 4, "PLANT STATUS");
+}
+
+// Clock widget (partial, its own w x h canvas)
+void renderClock(uint8_t* image, int w, int h, const char* date, const char* time) {
+  gfx()->select(image, w, h);
+  gfx()->clear(kGfxWhite);
+  drawText(kClockDateX, kClockDateY, date, &Font16, kGfxWhite, kGfxBlack);
+  drawText(kClockTimeX, kClockTimeY, time, &Font20, kGfxWhite, kGfxBlack, TextLayout::Fixed, kClockTimeCellW);
+}
+
+// Weather block (partial)
+void renderWeather(uint8_t* image, const WeatherData* w) {
+  gfx()->select(image, PRT_WTH_W, PRT_WTH_H);
+  gfx()->clear(kGfxWhite);
+
+  const int iconSize = 64;
+  drawWeatherConditionIcon(4, 4, iconSize, w->icon);
+
+  char buf[64];
+  int textX = iconSize + 16;
+
+  drawText(textX, 6, w->condition, &Font20, kGfxWhite, kGfxBlack);
+  snprintf(buf, sizeof(buf), "Now %d%cC", w->tempNow, 0xB0);
+  drawText(textX, 34, buf, &Font16, kGfxWhite, kGfxBlack);
+
+  snprintf(buf, sizeof(buf), "Feels like %d%cC", w->feelsLike, 0xB0);
+  drawText(textX, 52, buf, &Font16, kGfxWhite, kGfxBlack);
+
+  int rowY = 84;
+  const int rowStep = 32;
+  const int metricTextX = 48;
+
+  drawThermometerSymbol(8, rowY - 18);
+  snprintf(buf, sizeof(buf), "Temperature  High %d%c / Low %d%c", w->tempHigh, 0xB0, w->tempLow, 0xB0);
+  drawText(metricTextX, rowY, buf, &Font16, kGfxWhite, kGfxBlack);
+
+  rowY += rowStep;
+  drawWindSymbol(8, rowY - 16);
+  snprintf(buf, sizeof(buf), "Wind  %d km/h %s", w->windKph, w->windDir);
+  drawText(metricTextX, rowY, buf, &Font16, kGfxWhite, kGfxBlack);
+
+  rowY += rowStep;
+  drawHumiditySymbol(8, rowY - 18);
+  snprintf(buf, sizeof(buf), "Humidity  %d%%", w->humidity);
+  drawText(metricTextX, rowY, buf, &Font16, kGfxWhite, kGfxBlack);
+
+  rowY += rowStep;
+  drawPrecipSymbol(6, rowY - 18);
+  snprintf(buf, sizeof(buf), "Precipitation  %d%% chance", w->precipChance);
+  drawText(metricTextX, rowY, buf, &Font16, kGfxWhite, kGfxBlack);
+
+  rowY += rowStep;
+  drawUvSymbol(4, rowY - 24);
+  snprintf(buf, sizeof(buf), "UV Index  %d", w->uvIndex);
+  drawText(metricTextX, rowY, buf, &Font16, kGfxWhite, kGfxBlack);
+}
+
+// Calendar (partial) — fed by ICalendarProvider
+void renderCalendar(uint8_t* image, const CalItem* items, int n) {
+  gfx()->select(image, PRT_CAL_W, PRT_CAL_H);
+  gfx()->clear(kGfxWhite);
+
+  int y = 0;
+  const int rowH = 26;
+
+  // optional thin separator before title block (visual cue)
+  // gfx()->line(CAL_TITLE_X - 8, 0, CAL_TITLE_X - 8, PRT_CAL_H - 1, kGfxBlack, kGfxDot1, GfxStyle::Solid);
+
+  for (int i = 0; i < n && i < 6; i++) {
+    // time (e.g., "20:00 - 21:00")
+    drawText(CAL_TIME_X, y, items[i].time, &Font16, kGfxWhite, kGfxBlack);
+    // title pushed further right so it never overlaps time
+    drawText(CAL_TITLE_X, y, items[i].title, &Font16, kGfxWhite, kGfxBlack);
+    y += rowH;
+  }
+  if (n == 0) {
+    drawText(CAL_TIME_X, 0, "No events", &Font16, kGfxWhite, kGfxBlack);
+  }
+}
+
+// Plants (partial)
+void renderPlants(uint8_t* image, const PlantItem* p, int n) {
+  gfx()->select(image, PRT_PLT_W, PRT_PLT_H);
+  gfx()->clear(kGfxWhite);
+
+  int y = 0;
+  for (int i = 0; i < n && i < 5; i++) {
+    int needs = p[i].needsWater;  // threshold with hysteresis (PlantSensors)
+    // Bullet: filled if needs water
+    if (needs) {
+      gfx()->circle(6, y + 10, 6, kGfxBlack, kGfxDot1, GfxFill::Full);
+    } else {
+      gfx()->circle(6, y + 10, 6, kGfxBlack, kGfxDot1, GfxFill::Empty);
+    }
+    drawText(20, y, p[i].name, &Font16, kGfxWhite, kGfxBlack);
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%d %%", p[i].moisture_pct);
+    int px = PRT_PLT_W - 60;  // right align %
+    drawText(px, y, buf, &Font16, kGfxWhite, kGfxBlack);
+
+    if (needs) {
+      drawText(px + 44, y, "!", &Font16, kGfxWhite, kGfxBlack);
+    }
+    y += 28;
+  }
+}
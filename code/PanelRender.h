@@ -0,0 +1,25 @@
+// PanelRender.h
+// What each region of the dashboard shows, drawn through the display backend
+// - One call renders a whole region into its buffer (select, clear, draw); dirty checks,
+//   pushes and timing stay with the caller
+// - No Arduino or Waveshare headers: the host render benchmark draws the same panels
+#pragma once
+#include <stdint.h>
+#include "Calendar.h"
+#include "Weather.h"
+#include "Plant.h"
+
+// Clock widget layout (tuned for PRT_CLK_H): Font16 date line, Font20 time in fixed cells
+static const int kClockDateX = 4, kClockDateY = 2;
+static const int kClockTimeX = 4, kClockTimeY = 22;
+// Monospace cells avoid digit overlap/jitter on some font packs (~Font20 width per char)
+static const int kClockTimeCellW = 14;
+
+// Chrome of the full frame (W x H): header, column boxes, section titles
+void renderStaticUI(uint8_t* image);
+
+// Partial regions, each into a buffer of its own size (PRT_*_W x PRT_*_H)
+void renderClock(uint8_t* image, int w, int h, const char* date, const char* time);
+void renderWeather(uint8_t* image, const WeatherData* w);
+void renderCalendar(uint8_t* image, const CalItem* items, int n);
+void renderPlants(uint8_t* image, const PlantItem* p, int n);
@@ -0,0 +1,9 @@
+// Plant.h
+// One row of the plants panel, as PlantSensors publishes it (no ADC or task dependencies)
+#pragma once
+
+typedef struct {
+  char name[18];
+  int moisture_pct;  // 0..100
+  bool needsWater;   // moisture_pct below the threshold, with hysteresis
+} PlantItem;
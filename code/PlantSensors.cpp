@@ -0,0 +1,118 @@
+// PlantSensors.cpp
+#include "PlantSensors.h"
+#include <Arduino.h>
+#include <string.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+  #define PLANT_ADC_CONTINUOUS 1
+#else
+  #define PLANT_ADC_CONTINUOUS 0
+#endif
+
+// ---- Tunables ----
+static const uint32_t kConvPerPin  = 32;     // DMA conversions averaged into one frame value
+static const uint32_t kSampleHz    = 20000;  // lowest rate ADC1 continuous mode accepts
+static const int      kOneShotReps = 4;      // core 2.x: one-shot reads averaged per pass
+static const uint32_t kFrameWaitMs = 50;     // sampleBurst(): wait for a fresh DMA frame
+
+static int medianOf(const uint16_t* v, int n) {
+  uint16_t s[kPlantRing];
+  memcpy(s, v, sizeof(uint16_t) * n);
+  for (int i = 1; i < n; ++i)  // insertion sort, n <= kPlantRing
+    for (int j = i; j > 0 && s[j] < s[j - 1]; --j) { uint16_t t = s[j]; s[j] = s[j - 1]; s[j - 1] = t; }
+  return s[n / 2];
+}
+
+bool PlantSensors::begin(const PlantChannel* ch, int n) {
+  ch_ = ch;
+  n_ = (n > kPlantMax) ? kPlantMax : n;
+  for (int i = 0; i < n_; ++i) { f_[i] = Filter(); f_[i].shown = -1; }
+#if PLANT_ADC_CONTINUOUS
+  uint8_t pins[kPlantMax];
+  for (int i = 0; i < n_; ++i) pins[i] = ch_[i].pin;
+  continuous_ = analogContinuous(pins, n_, kConvPerPin, kSampleHz, nullptr) && analogContinuousStart();
+  if (!continuous_) DBG("[PLT] continuous ADC unavailable, one-shot reads\n");
+#endif
+  publish();  // names show up right away, values once the filters have data
+  return n_ > 0;
+}
+
+bool PlantSensors::startTask() {
+  // The drain only shuffles a few ints: a small stack is enough
+  return task_.start("plants", &PlantSensors::job, this, kPlantPeriodMs, 0, 3072);
+}
+
+void PlantSensors::job(void* self) {
+  PlantSensors* s = (PlantSensors*)self;
+  if (s->pass(0)) s->publish();
+}
+
+void PlantSensors::sampleBurst() {
+  for (int k = 0; k < kPlantRing; ++k) pass(kFrameWaitMs);
+  publish();
+}
+
+bool PlantSensors::pass(uint32_t timeoutMs) {
+  bool changed = false;
+#if PLANT_ADC_CONTINUOUS
+  if (continuous_) {
+    adc_continuous_data_t* frame = nullptr;
+    if (!analogContinuousRead(&frame, timeoutMs) || !frame) return false;  // no new frame yet
+    for (int i = 0; i < n_; ++i) changed |= feed(i, frame[i].avg_read_mvolts);
+    return changed;
+  }
+#endif
+  (void)timeoutMs;
+  for (int i = 0; i < n_; ++i) {
+    uint32_t mv = 0;
+    for (int r = 0; r < kOneShotReps; ++r) mv += analogReadMilliVolts(ch_[i].pin);
+    changed |= feed(i, (int)(mv / kOneShotReps));
+  }
+  return changed;
+}
+
+// Median of the ring, EMA over medians, then percent with dead band and threshold band
+bool PlantSensors::feed(int i, int mv) {
+  Filter& f = f_[i];
+  f.ring[f.head] = (uint16_t)mv;
+  f.head = (uint8_t)((f.head + 1) % kPlantRing);
+  if (f.count < kPlantRing) f.count++;
+
+  const int32_t med = (int32_t)medianOf(f.ring, f.count) << 4;
+  if (f.shown < 0 && f.count == 1) f.ema = med;
+  else f.ema += (med - f.ema) >> kPlantEmaShift;
+
+  const PlantChannel& c = ch_[i];
+  const int span = (int)c.dryMv - (int)c.wetMv;
+  int pct = span ? (int)(((int32_t)c.dryMv * 16 - f.ema) * 100 / (span * 16)) : 0;
+  if (pct < 0) pct = 0;
+  if (pct > 100) pct = 100;
+
+  if (f.shown >= 0 && abs(pct - f.shown) < kPlantDeadbandPct) return false;
+  f.shown = pct;
+  if (!f.thirsty && pct < kPlantThirstyPct) f.thirsty = true;
+  else if (f.thirsty && pct >= kPlantThirstyPct + kPlantThirstyHyst) f.thirsty = false;
+  return true;
+}
+
+void PlantSensors::publish() {
+  PlantSnapshot& s = feed_.writeBuffer();
+  s.n = n_;
+  for (int i = 0; i < n_; ++i) {
+    snprintf(s.items[i].name, sizeof(s.items[i].name), "%s", ch_[i].name);
+    s.items[i].moisture_pct = (f_[i].shown < 0) ? 0 : f_[i].shown;
+    s.items[i].needsWater = f_[i].thirsty;
+  }
+  feed_.publish();
+}
+
+int PlantSensors::read(PlantItem* out, int maxn) {
+  if (feed_.consume()) shown_ = feed_.front();
+  int n = (shown_.n < maxn) ? shown_.n : maxn;
+  for (int i = 0; i < n; ++i) out[i] = shown_.items[i];
+  return n;
+}
@@ -0,0 +1,72 @@
+// PlantSensors.h
+// Capacitive soil-moisture probes sampled off the render loop
+// - ESP32 ADC1 in continuous (DMA) mode on Arduino core 3.x: one frame holds an
+//   averaged reading per probe, drained by a small background task
+// - Core 2.x fallback: the same task takes one-shot readings (no settle delays in loop())
+// - Per probe: ring of recent readings → median (spikes) → EMA (noise) → percent
+// - Hysteresis: the shown percent moves in steps of kPlantDeadbandPct, the
+//   needs-water flag has a band around kPlantThirstyPct, so jitter does not repaint
+// - read() copies the latest published snapshot: O(1), never touches the ADC
+#pragma once
+#include <stdint.h>
+#include "BackgroundTask.h"
+#include "SnapshotChannel.h"
+#include "Plant.h"
+
+// ---- Tunables ----
+static const int      kPlantMax          = 5;    // probes on the panel
+static const int      kPlantRing         = 7;    // readings per median (odd)
+static const int      kPlantEmaShift     = 2;    // EMA alpha = 1 / 2^shift
+static const int      kPlantDeadbandPct  = 2;    // shown percent changes by at least this much
+static const int      kPlantThirstyPct   = 40;   // needs water below this ...
+static const int      kPlantThirstyHyst  = 3;    // ... until back at threshold + hyst
+static const uint32_t kPlantPeriodMs     = 250;  // background drain / sample period
+
+// One probe: ADC1 pin plus its two-point calibration (probe in air / in water)
+struct PlantChannel {
+  const char* name;
+  uint8_t  pin;
+  uint16_t dryMv;
+  uint16_t wetMv;
+};
+
+struct PlantSnapshot {
+  int n{0};
+  PlantItem items[kPlantMax];
+};
+
+class PlantSensors {
+public:
+  // Configure the ADC; the table must outlive the object. true if sampling runs.
+  bool begin(const PlantChannel* ch, int n);
+  // Start the background drain task (after begin(); skip it for a one-shot wake cycle)
+  bool startTask();
+  // Fill the filters synchronously, e.g. right after a deep-sleep wakeup (blocks ~kPlantRing passes)
+  void sampleBurst();
+
+  // Latest filtered values (render side); returns the number of probes
+  int read(PlantItem* out, int maxn);
+
+private:
+  struct Filter {
+    uint16_t ring[kPlantRing];
+    uint8_t  count;
+    uint8_t  head;
+    int32_t  ema;   // mV << 4
+    int      shown; // -1 until the first reading
+    bool     thirsty;
+  };
+
+  static void job(void* self);
+  bool pass(uint32_t timeoutMs);  // one reading per probe into the filters
+  bool feed(int i, int mv);       // true if the shown value changed
+  void publish();
+
+  const PlantChannel* ch_{nullptr};
+  int  n_{0};
+  bool continuous_{false};
+  Filter f_[kPlantMax]{};
+  BackgroundTask task_;
+  SnapshotChannel<PlantSnapshot> feed_;
+  PlantSnapshot shown_;  // render side copy
+};
@@ -0,0 +1,133 @@
+// Raster1bpp.cpp
+#include "Raster1bpp.h"
+#include <string.h>
+
+static inline void paintByte(uint8_t& b, uint8_t mask, bool black) {
+  if (black) b &= (uint8_t)~mask;
+  else       b |= mask;
+}
+
+void rasterClear(const GfxCanvas& cv, uint16_t color) {
+  memset(cv.image, (uint8_t)color, (size_t)cv.rowBytes * cv.height);
+}
+
+void rasterSpan(const GfxCanvas& cv, int x0, int x1, int y, uint16_t color) {
+  const bool black = (color == kGfxBlack);
+  uint8_t* row = cv.image + (size_t)y * cv.rowBytes;
+  const int b0 = x0 >> 3, b1 = x1 >> 3;
+  const uint8_t m0 = (uint8_t)(0xFF >> (x0 & 7));
+  const uint8_t m1 = (uint8_t)(0xFF << (7 - (x1 & 7)));
+  if (b0 == b1) { paintByte(row[b0], m0 & m1, black); return; }
+  paintByte(row[b0], m0, black);
+  if (b1 - b0 > 1) memset(row + b0 + 1, black ? 0x00 : 0xFF, b1 - b0 - 1);
+  paintByte(row[b1], m1, black);
+}
+
+// Dots a..b of dot row py (Paint_DrawPoint coordinates), clipped the way Paint_* drops them
+static void hrun(const GfxCanvas& cv, int a, int b, int py, uint16_t color) {
+  if (py < 1 || py > cv.height) return;
+  if (a < 1) a = 1;
+  if (b > cv.width) b = cv.width;
+  if (a <= b) rasterSpan(cv, a - 1, b - 1, py - 1, color);
+}
+
+static void vrun(const GfxCanvas& cv, int px, int a, int b, uint16_t color) {
+  if (px < 1 || px > cv.width) return;
+  if (a < 1) a = 1;
+  if (b > cv.height) b = cv.height;
+  if (a > b) return;
+  const uint8_t mask = (uint8_t)(0x80 >> ((px - 1) & 7));
+  uint8_t* p = cv.image + (size_t)(a - 1) * cv.rowBytes + ((px - 1) >> 3);
+  for (int y = a; y <= b; ++y, p += cv.rowBytes) paintByte(*p, mask, color == kGfxBlack);
+}
+
+static inline void dot(const GfxCanvas& cv, int px, int py, uint16_t color) {
+  if (px < 1 || py < 1 || px > cv.width || py > cv.height) return;
+  paintByte(cv.image[(size_t)(py - 1) * cv.rowBytes + ((px - 1) >> 3)],
+            (uint8_t)(0x80 >> ((px - 1) & 7)), color == kGfxBlack);
+}
+
+void rasterLine(const GfxCanvas& cv, int x0, int y0, int x1, int y1, uint16_t color) {
+  // UWORD like Paint_DrawLine: negative coordinates wrap and fail the bounds test
+  const uint16_t xs = (uint16_t)x0, ys = (uint16_t)y0, xe = (uint16_t)x1, ye = (uint16_t)y1;
+  if (xs > cv.width || ys > cv.height || xe > cv.width || ye > cv.height) return;
+  if (ys == ye) { hrun(cv, xs < xe ? xs : xe, xs < xe ? xe : xs, ys, color); return; }
+  if (xs == xe) { vrun(cv, xs, ys < ye ? ys : ye, ys < ye ? ye : ys, color); return; }
+
+  // Paint_DrawLine's stepping; dots of one row are consecutive, so each row is one run
+  int x = xs, y = ys;
+  const int dx = xe > xs ? xe - xs : xs - xe;
+  const int dy = ye > ys ? ys - ye : ye - ys;
+  const int xAdd = xs < xe ? 1 : -1, yAdd = ys < ye ? 1 : -1;
+  int esp = dx + dy;
+  int runA = x, runB = x;
+  for (;;) {
+    if (2 * esp >= dy) {
+      if (x == xe) break;
+      esp += dy;
+      x += xAdd;
+    }
+    if (2 * esp <= dx) {
+      if (y == ye) break;
+      esp += dx;
+      hrun(cv, runA, runB, y, color);
+      y += yAdd;
+      runA = runB = x;
+      continue;
+    }
+    if (x < runA) runA = x;
+    if (x > runB) runB = x;
+  }
+  hrun(cv, runA, runB, y, color);
+}
+
+void rasterRect(const GfxCanvas& cv, int x0, int y0, int x1, int y1, uint16_t color, bool fill) {
+  const uint16_t xs = (uint16_t)x0, ys = (uint16_t)y0, xe = (uint16_t)x1, ye = (uint16_t)y1;
+  if (xs > cv.width || ys > cv.height || xe > cv.width || ye > cv.height) return;
+  const int xa = xs < xe ? xs : xe, xb = xs < xe ? xe : xs;
+  if (fill) {
+    for (int y = ys; y < ye; ++y) hrun(cv, xa, xb, y, color);  // Paint_* leaves out row ye
+    return;
+  }
+  const int ya = ys < ye ? ys : ye, yb = ys < ye ? ye : ys;
+  hrun(cv, xa, xb, ys, color);
+  hrun(cv, xa, xb, ye, color);
+  vrun(cv, xs, ya, yb, color);
+  vrun(cv, xe, ya, yb, color);
+}
+
+void rasterCircle(const GfxCanvas& cv, int cx, int cy, int r, uint16_t color, bool fill) {
+  const uint16_t xc = (uint16_t)cx, yc = (uint16_t)cy;
+  if (xc > cv.width || yc >= cv.height) return;
+  int16_t xi = 0, yi = (int16_t)(uint16_t)r;
+  int16_t esp = (int16_t)(3 - ((uint16_t)r << 1));
+  while (xi <= yi) {
+    if (fill) {
+      // Paint_* fills with the octant dots for every s in xi..yi: four columns, four rows
+      vrun(cv, xc + xi, yc + xi, yc + yi, color);
+      vrun(cv, xc - xi, yc + xi, yc + yi, color);
+      vrun(cv, xc + xi, yc - yi, yc - xi, color);
+      vrun(cv, xc - xi, yc - yi, yc - xi, color);
+      hrun(cv, xc - yi, xc - xi, yc + xi, color);
+      hrun(cv, xc - yi, xc - xi, yc - xi, color);
+      hrun(cv, xc + xi, xc + yi, yc + xi, color);
+      hrun(cv, xc + xi, xc + yi, yc - xi, color);
+    } else {
+      dot(cv, xc + xi, yc + yi, color);
+      dot(cv, xc - xi, yc + yi, color);
+      dot(cv, xc - yi, yc + xi, color);
+      dot(cv, xc - yi, yc - xi, color);
+      dot(cv, xc - xi, yc - yi, color);
+      dot(cv, xc + xi, yc - yi, color);
+      dot(cv, xc + yi, yc - xi, color);
+      dot(cv, xc + yi, yc + xi, color);
+    }
+    if (esp < 0) {
+      esp += 4 * xi + 6;
+    } else {
+      esp += 10 + 4 * (xi - yi);
+      yi--;
+    }
+    xi++;
+  }
+}
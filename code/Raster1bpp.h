@@ -0,0 +1,18 @@
+// Raster1bpp.h
+// Run-based drawing on a plain 1bpp canvas, same pixels as Paint_*
+// - Clears are one memset; a horizontal run is two edge-masked bytes around a memset
+// - Lines, rectangles and circles walk Paint_*'s own algorithms but hand out whole runs
+//   (rows of a filled shape, flat stretches of a line) instead of one SetPixel per dot
+// - Covers 1x1 dots and solid lines only; the backend keeps Paint_* for everything else
+// - Coordinates as in Paint_*: a 1x1 dot at (x, y) is pixel (x-1, y-1), and x or y 0 drop it
+#pragma once
+#include "DisplayBackend.h"
+
+void rasterClear(const GfxCanvas& cv, uint16_t color);
+// Pixels x0..x1 of row y, already inside the canvas
+void rasterSpan(const GfxCanvas& cv, int x0, int x1, int y, uint16_t color);
+
+// Paint_DrawLine / Paint_DrawRectangle / Paint_DrawCircle with DOT_PIXEL_1X1, LINE_STYLE_SOLID
+void rasterLine(const GfxCanvas& cv, int x0, int y0, int x1, int y1, uint16_t color);
+void rasterRect(const GfxCanvas& cv, int x0, int y0, int x1, int y1, uint16_t color, bool fill);
+void rasterCircle(const GfxCanvas& cv, int cx, int cy, int r, uint16_t color, bool fill);
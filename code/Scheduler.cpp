@@ -0,0 +1,99 @@
+// Scheduler.cpp
+#include "Scheduler.h"
+#include <Arduino.h>
+#include <sys/time.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const uint32_t kCoalesceMs  = 300;  // periodic entries this close to due join the batch
+static const uint32_t kWallMarginMs = 20;  // run wall entries just after the boundary
+
+static inline int32_t diffMs(uint32_t a, uint32_t b) { return (int32_t)(a - b); }
+
+// ms until the next multiple of periodSec in wall-clock time
+uint32_t Scheduler::msToWall(uint32_t periodSec) {
+  struct timeval tv; gettimeofday(&tv, nullptr);
+  uint32_t into = (uint32_t)(tv.tv_sec % periodSec) * 1000u + (uint32_t)(tv.tv_usec / 1000);
+  return periodSec * 1000u - into + kWallMarginMs;
+}
+
+int Scheduler::add(const Entry& e) {
+  if (n_ >= kMaxEntries) { DBG("[SCHED] table full, '%s' dropped\n", e.name); return -1; }
+  e_[n_] = e;
+  return n_++;
+}
+
+int Scheduler::every(const char* name, uint32_t periodMs, IPanel* panel, bool runNow) {
+  return add(Entry{ name, Kind::Period, periodMs, (uint32_t)millis() + (runNow ? 0 : periodMs),
+                    panel, nullptr, nullptr, true, 0, 0 });
+}
+
+int Scheduler::every(const char* name, uint32_t periodMs, Job job, void* arg, bool display, bool runNow) {
+  return add(Entry{ name, Kind::Period, periodMs, (uint32_t)millis() + (runNow ? 0 : periodMs),
+                    nullptr, job, arg, display, 0, 0 });
+}
+
+int Scheduler::onWall(const char* name, uint32_t periodSec, IPanel* panel) {
+  return add(Entry{ name, Kind::Wall, periodSec, (uint32_t)millis() + msToWall(periodSec),
+                    panel, nullptr, nullptr, true, 0, 0 });
+}
+
+void Scheduler::runEntry(Entry& e, uint32_t nowMs) {
+  int32_t late = diffMs(nowMs, e.dueMs);
+  if (late > 0 && (uint32_t)late > e.maxLateMs) e.maxLateMs = (uint32_t)late;
+  if (e.panel) e.panel->tick(); else e.job(e.arg);
+  e.runs++;
+
+  // Next deadline from the schedule, not from when this run finished (no drift)
+  const uint32_t after = millis();
+  if (e.kind == Kind::Wall) {
+    e.dueMs = after + msToWall(e.period);
+  } else {
+    e.dueMs += e.period;
+    if (diffMs(e.dueMs, after) < 0) e.dueMs = after + e.period;  // stalled: skip, don't replay
+  }
+}
+
+uint32_t Scheduler::run(uint32_t maxWaitMs) {
+  const uint32_t now = millis();
+
+  // Batch: everything due, plus periodic entries close enough to share the EPD session.
+  // Wall entries never run early (the clock would show the old minute).
+  bool inBatch[kMaxEntries] = {};
+  int nBatch = 0, nDisplay = 0;
+  for (int i = 0; i < n_; ++i) {
+    int32_t d = diffMs(e_[i].dueMs, now);
+    if (d <= 0 || (e_[i].kind == Kind::Period && d <= (int32_t)kCoalesceMs)) {
+      inBatch[i] = true; nBatch++;
+      if (e_[i].display) nDisplay++;
+    }
+  }
+
+  if (nBatch) {
+    if (nDisplay && batchBegin_) batchBegin_();
+    for (int i = 0; i < n_; ++i) if (inBatch[i] && e_[i].display)  runEntry(e_[i], now);
+    if (nDisplay && batchEnd_) batchEnd_(nDisplay);
+    for (int i = 0; i < n_; ++i) if (inBatch[i] && !e_[i].display) runEntry(e_[i], now);
+  }
+
+  const uint32_t after = millis();
+  int32_t wait = (int32_t)maxWaitMs;
+  for (int i = 0; i < n_; ++i) {
+    int32_t d = diffMs(e_[i].dueMs, after);
+    if (d < wait) wait = d;
+  }
+  return wait > 0 ? (uint32_t)wait : 0;
+}
+
+void Scheduler::runAndWait(uint32_t maxWaitMs) {
+  uint32_t wait = run(maxWaitMs);
+  if (wait) delay(wait);
+}
+
+void Scheduler::dumpStats() const {
+  for (int i = 0; i < n_; ++i)
+    DBG("[SCHED] %-10s runs=%u maxLate=%u ms\n", e_[i].name, (unsigned)e_[i].runs, (unsigned)e_[i].maxLateMs);
+}
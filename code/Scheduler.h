@@ -0,0 +1,56 @@
+// Scheduler.h
+// Deadline scheduler for panels and periodic jobs, replacing per-region tick counters
+// - every(): monotonic period (millis), missed periods are skipped rather than replayed
+// - onWall(): wall-clock multiples, e.g. 60 s = right after each minute boundary
+// - run() executes what is due and returns the time to the earliest deadline
+// - Periodic entries due within kCoalesceMs run early together with the current batch;
+//   display entries of one batch share one EPD session (batch hooks)
+#pragma once
+#include <stdint.h>
+#include "Panel.h"
+
+class Scheduler {
+public:
+  typedef void (*Job)(void* arg);
+  typedef void (*BatchBegin)();
+  typedef void (*BatchEnd)(int displayEntries);
+
+  // Returns the entry id, or -1 when the table is full
+  int every(const char* name, uint32_t periodMs, IPanel* panel, bool runNow = false);
+  int every(const char* name, uint32_t periodMs, Job job, void* arg, bool display, bool runNow = false);
+  int onWall(const char* name, uint32_t periodSec, IPanel* panel);
+
+  void setBatchHooks(BatchBegin begin, BatchEnd end) { batchBegin_ = begin; batchEnd_ = end; }
+
+  // Run everything due; returns ms until the next deadline (at most maxWaitMs)
+  uint32_t run(uint32_t maxWaitMs = 1000);
+  // run(), then sleep exactly until the next deadline
+  void runAndWait(uint32_t maxWaitMs = 1000);
+
+  void dumpStats() const;
+
+private:
+  enum class Kind : uint8_t { Period, Wall };
+  struct Entry {
+    const char* name;
+    Kind     kind;
+    uint32_t period;    // ms (Period) or s (Wall)
+    uint32_t dueMs;
+    IPanel*  panel;
+    Job      job;
+    void*    arg;
+    bool     display;   // touches the panel: runs inside a batch
+    uint32_t runs;
+    uint32_t maxLateMs; // worst start delay past the deadline
+  };
+  static const int kMaxEntries = 8;
+
+  int add(const Entry& e);
+  void runEntry(Entry& e, uint32_t nowMs);
+  static uint32_t msToWall(uint32_t periodSec);
+
+  Entry      e_[kMaxEntries];
+  int        n_{0};
+  BatchBegin batchBegin_{nullptr};
+  BatchEnd   batchEnd_{nullptr};
+};
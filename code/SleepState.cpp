@@ -0,0 +1,32 @@
+// SleepState.cpp
+#include "SleepState.h"
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <sys/time.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const uint32_t kSleepMagic   = 0x5A454947;  // "ZEIG"
+static const uint32_t kWakeMarginUs = 50000;      // wake a bit after :00 so the minute has flipped
+
+RTC_DATA_ATTR SleepState gSleep;
+
+bool sleepResumed() {
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && gSleep.magic == kSleepMagic;
+}
+
+void sleepCommit() {
+  gSleep.magic = kSleepMagic;
+}
+
+void sleepUntilNextMinute() {
+  struct timeval tv; gettimeofday(&tv, nullptr);
+  uint64_t us = (uint64_t)(59 - tv.tv_sec % 60) * 1000000ULL + (1000000ULL - tv.tv_usec) + kWakeMarginUs;
+  DBG("[SLEEP] %u ms (wakes=%u refreshes=%u)\n", (unsigned)(us / 1000),
+      (unsigned)gSleep.wakes, (unsigned)gSleep.refreshes);
+  esp_sleep_enable_timer_wakeup(us);
+  esp_deep_sleep_start();
+}
@@ -0,0 +1,44 @@
+// SleepState.h
+// Deep-sleep duty cycle: state that survives a timer wakeup in RTC slow memory
+// - Written before every sleep, validated by a magic word on wake
+// - Holds what the wake path needs to avoid setup(): clock state, last pushed
+//   region content, the calendar rows and weather on screen and refresh bookkeeping
+#pragma once
+#include <stdint.h>
+#include <time.h>
+#include <type_traits>
+#include "Calendar.h"
+#include "Clock.h"
+#include "DirtyRegion.h"
+#include "Weather.h"
+
+static const int kSleepCalRows = 6;  // calendar rows on screen
+
+// Trivially constructible on purpose: a constructor (member initializers anywhere inside)
+// would run on every boot, wakeups included, and wipe the magic. Cold boot resets it
+// explicitly with gSleep = SleepState().
+struct SleepState {
+  uint32_t   magic;
+  uint32_t   wakes;             // timer wakeups since cold boot
+  uint32_t   refreshes;         // WiFi refresh cycles since cold boot
+  time_t     lastRefreshUTC;    // last calendar/weather refresh
+  time_t     lastFullUTC;       // last full (anti-ghosting) refresh
+  ClockState clock;
+  DirtyRegion weather, calendar, plants;
+  int        ncal;
+  CalItem    cal[kSleepCalRows];
+  bool       hasWeather;        // weatherData holds a fetched forecast
+  WeatherData weatherData;
+};
+
+static_assert(std::is_trivially_default_constructible<SleepState>::value,
+              "SleepState lives in RTC memory and must not have a constructor");
+
+extern SleepState gSleep;
+
+// True after a timer wakeup with intact RTC state (false on cold boot / reset)
+bool sleepResumed();
+// Mark gSleep as valid; call right before sleeping
+void sleepCommit();
+// Deep sleep until just past the next minute boundary (does not return)
+void sleepUntilNextMinute();
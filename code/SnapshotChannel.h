@@ -0,0 +1,37 @@
+// SnapshotChannel.h
+// Lock-free single-producer/single-consumer handoff of the latest value (triple buffer)
+// - Producer fills writeBuffer() in place, then publish() swaps it into the middle slot
+// - Consumer calls consume(): true if a newer snapshot arrived; read it via front()
+// - Neither side ever blocks or waits; intermediate snapshots are simply overwritten
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+template<typename T>
+class SnapshotChannel {
+public:
+  // ---- Producer side (one task) ----
+  T& writeBuffer() { return buf_[back_]; }
+  void publish() {
+    uint8_t prev = middle_.exchange((uint8_t)(back_ | kFresh), std::memory_order_acq_rel);
+    back_ = prev & kIndex;
+  }
+
+  // ---- Consumer side (one task) ----
+  bool consume() {
+    if (!(middle_.load(std::memory_order_acquire) & kFresh)) return false;
+    uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+    front_ = prev & kIndex;
+    return true;
+  }
+  const T& front() const { return buf_[front_]; }
+
+private:
+  static const uint8_t kIndex = 0x03;
+  static const uint8_t kFresh = 0x04;  // middle slot holds an unread snapshot
+
+  T buf_[3]{};
+  uint8_t back_{0};                // producer-owned
+  std::atomic<uint8_t> middle_{1};
+  uint8_t front_{2};               // consumer-owned
+};
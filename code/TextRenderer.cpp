@@ -0,0 +1,136 @@
+// TextRenderer.cpp
+#include "TextRenderer.h"
+#include "DisplayBackend.h"
+#include "fonts.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ---- Tunables ----
+static const int kMaxAtlases     = 4;  // fonts packed at the same time
+static const int kPropSpacing    = 1;  // blank columns after a proportional glyph
+
+bool GlyphAtlas::build(const sFONT* font) {
+  if (!font || font->Width == 0 || font->Width > 32) return false;
+  const int w = font->Width, h = font->Height;
+  const int rowBytes = w / 8 + (w % 8 ? 1 : 0);
+  rows_ = (uint32_t*)malloc(sizeof(uint32_t) * kGlyphs * h);
+  if (!rows_) return false;
+
+  for (int g = 0; g < kGlyphs; ++g) {
+    const uint8_t* src = &font->table[g * h * rowBytes];
+    uint32_t ink = 0;
+    for (int y = 0; y < h; ++y) {
+      uint32_t r = 0;
+      for (int b = 0; b < rowBytes; ++b) r |= (uint32_t)src[y * rowBytes + b] << (24 - 8 * b);
+      r &= ~0u << (32 - w);  // padding bits of the last byte are not ink
+      rows_[g * h + y] = r;
+      ink |= r;
+    }
+    if (!ink) { lsb_[g] = 0; adv_[g] = (uint8_t)(w / 2); continue; }  // space and blanks
+    int first = 0, last = w - 1;
+    while (!(ink & (0x80000000u >> first))) ++first;
+    while (!(ink & (0x80000000u >> last)))  --last;
+    lsb_[g] = (uint8_t)first;
+    adv_[g] = (uint8_t)(last - first + 1 + kPropSpacing);
+  }
+  font_ = font; width_ = (uint8_t)w; height_ = (uint8_t)h;
+  return true;
+}
+
+const GlyphAtlas* glyphAtlas(const sFONT* font) {
+  static GlyphAtlas atlases[kMaxAtlases];
+  for (int i = 0; i < kMaxAtlases; ++i) {
+    if (atlases[i].font() == font) return &atlases[i];
+    if (!atlases[i].font()) return atlases[i].build(font) ? &atlases[i] : nullptr;
+  }
+  return nullptr;
+}
+
+// Blit one glyph with its ink starting at column 'shift' of the atlas row
+static void blitGlyph(const GfxCanvas& cv, const GlyphAtlas& a, char c, int x, int y, int shift, int cellW,
+                      uint16_t bg, uint16_t fg) {
+  const int W = cv.width, H = cv.height;
+  if (x >= W || y >= H) return;
+  int visW = cellW;
+  if (x + visW > W) visW = W - x;
+  const uint32_t cell = (visW >= 32) ? ~0u : ~(~0u >> visW);  // columns inside the image
+  const bool opaque = (bg != kGfxFontBackground);
+  const bool inkBlack = (fg == kGfxBlack);
+  const int sh = x & 7;
+  const int nBytes = (sh + visW + 7) >> 3;
+  uint8_t* line = cv.image + (x >> 3) + (size_t)y * cv.rowBytes;
+
+  for (int r = 0; r < a.height() && y + r < H; ++r, line += cv.rowBytes) {
+    uint32_t bits = (a.has(c) ? (a.row(c, r) << shift) : 0) & cell;
+    uint32_t back = opaque ? (cell & ~bits) : 0;
+    if (!bits && !back) continue;
+    // Column 0 of the glyph lands at bit (63 - sh) of a 64-bit window over the destination bytes
+    uint64_t ink = ((uint64_t)bits << 32) >> sh;
+    uint64_t bgm = ((uint64_t)back << 32) >> sh;
+    for (int k = 0; k < nBytes; ++k) {
+      uint8_t mi = (uint8_t)(ink >> (56 - 8 * k));
+      uint8_t mb = (uint8_t)(bgm >> (56 - 8 * k));
+      if (inkBlack) { line[k] &= (uint8_t)~mi; line[k] |= mb; }
+      else          { line[k] |= mi; line[k] &= (uint8_t)~mb; }
+    }
+  }
+}
+
+// Slow path for rotated/mirrored images: same layout, the backend's drawChar per glyph
+static void drawTextPaint(int x, int y, const char* s, const sFONT* font, uint16_t bg, uint16_t fg,
+                          TextLayout layout, int cellW, const GlyphAtlas* a) {
+  if (layout == TextLayout::Fixed && cellW == 0) {
+    gfx()->drawString(x, y, s, font, bg, fg);
+    return;
+  }
+  int pen = x;
+  for (; *s; ++s) {
+    bool prop = (layout == TextLayout::Proportional && a);
+    int lsb = prop && a->has(*s) ? a->lsb(*s) : 0;
+    if (GlyphAtlas::has(*s)) gfx()->drawChar(pen - lsb, y, *s, font, bg, fg);
+    pen += prop ? (a->has(*s) ? a->advance(*s) : a->width() / 2) : (cellW ? cellW : font->Width);
+  }
+}
+
+void drawText(int x, int y, const char* s, const sFONT* font, uint16_t bg, uint16_t fg,
+              TextLayout layout, int cellW) {
+  if (!s || !font || x < 0 || y < 0) return;
+  const GlyphAtlas* a = glyphAtlas(font);
+  const GfxCanvas cv = gfx()->canvas();
+  if (!a || !cv.plain) {
+    drawTextPaint(x, y, s, font, bg, fg, layout, cellW, a);
+    return;
+  }
+  if (x > cv.width || y > cv.height) return;
+
+  const int fw = a->width(), fh = a->height();
+  const int step = cellW ? cellW : fw;
+  int px = x, py = y;
+  for (; *s; ++s) {
+    const char c = *s;
+    if (layout == TextLayout::Proportional) {
+      int adv = a->has(c) ? a->advance(c) : fw / 2;
+      blitGlyph(cv, *a, c, px, py, a->has(c) ? a->lsb(c) : 0, adv - kPropSpacing, bg, fg);
+      px += adv;
+      continue;
+    }
+    // Paint_DrawString_EN: wrap to the next line at the right edge, back to the start at the bottom
+    if (px + fw > cv.width)  { px = x; py += fh; }
+    if (py + fh > cv.height) { px = x; py = y; }
+    blitGlyph(cv, *a, c, px, py, 0, fw, bg, fg);
+    px += step;
+  }
+}
+
+int textWidth(const char* s, const sFONT* font, TextLayout layout, int cellW) {
+  if (!s || !font) return 0;
+  int w = 0;
+  if (layout == TextLayout::Fixed) {
+    int n = (int)strlen(s);
+    return n * (cellW ? cellW : font->Width);
+  }
+  const GlyphAtlas* a = glyphAtlas(font);
+  if (!a) return (int)strlen(s) * font->Width;
+  for (; *s; ++s) w += a->has(*s) ? a->advance(*s) : a->width() / 2;
+  return w > 0 ? w - kPropSpacing : 0;  // no trailing gap after the last glyph
+}
@@ -0,0 +1,48 @@
+// TextRenderer.h
+// Fast 1bpp text for the image selected on the display backend (FBPart/FBFull)
+// - Waveshare fonts packed once into a glyph atlas: one left-aligned 32-bit word per glyph row
+// - Blits a glyph row with one 64-bit shift and 1..5 byte ANDs/ORs instead of SetPixel per pixel
+// - Fixed layout follows Paint_DrawString_EN exactly (cell = font width, same wrap rules);
+//   Proportional layout advances by each glyph's ink width
+// - Rotated/mirrored images fall back to the backend's drawChar/drawString
+#pragma once
+#include <stdint.h>
+#include "DisplayBackend.h"
+
+enum class TextLayout : uint8_t { Fixed, Proportional };
+
+class GlyphAtlas {
+public:
+  static const uint8_t kFirst = 0x20, kLast = 0x7E;  // glyphs in the Waveshare tables
+  static const int kGlyphs = kLast - kFirst + 1;
+
+  bool build(const sFONT* font);
+  const sFONT* font() const { return font_; }
+  int width() const  { return width_; }
+  int height() const { return height_; }
+
+  static bool has(char c) { return (uint8_t)c >= kFirst && (uint8_t)c <= kLast; }
+  // Row y of c, bit 31 = leftmost column
+  uint32_t row(char c, int y) const { return rows_[((uint8_t)c - kFirst) * height_ + y]; }
+  // Proportional metrics: first inked column and advance to the next glyph
+  uint8_t lsb(char c) const     { return lsb_[(uint8_t)c - kFirst]; }
+  uint8_t advance(char c) const { return adv_[(uint8_t)c - kFirst]; }
+
+private:
+  const sFONT* font_{nullptr};
+  uint8_t   width_{0}, height_{0};
+  uint32_t* rows_{nullptr};
+  uint8_t   lsb_[kGlyphs];
+  uint8_t   adv_[kGlyphs];
+};
+
+// Atlas for font, packed on first use (nullptr if out of memory or wider than 32 px)
+const GlyphAtlas* glyphAtlas(const sFONT* font);
+
+// Drop-in for Paint_DrawString_EN(x, y, s, font, bg, fg): bg == kGfxFontBackground draws ink only.
+// cellW > 0 places Fixed glyphs in cells of that width (monospace digits).
+void drawText(int x, int y, const char* s, const sFONT* font, uint16_t bg = kGfxWhite, uint16_t fg = kGfxBlack,
+              TextLayout layout = TextLayout::Fixed, int cellW = 0);
+
+// Width in pixels of one line of s as drawText() would lay it out (no wrapping)
+int textWidth(const char* s, const sFONT* font, TextLayout layout = TextLayout::Fixed, int cellW = 0);
@@ -0,0 +1,241 @@
+// TimeZone.cpp
+#include "TimeZone.h"
+#include "IcsRecurrence.h"
+#include "Fnv1a.h"
+#include <string.h>
+
+// Zones are registered by whichever task parses a feed (CompositeCalendar runs several)
+#ifdef ESP32
+  #include <freertos/FreeRTOS.h>
+  static portMUX_TYPE gZoneLock = portMUX_INITIALIZER_UNLOCKED;
+  #define ZONE_LOCK()   portENTER_CRITICAL(&gZoneLock)
+  #define ZONE_UNLOCK() portEXIT_CRITICAL(&gZoneLock)
+#else
+  #define ZONE_LOCK()
+  #define ZONE_UNLOCK()
+#endif
+
+// ---- Tunables ----
+static const int kTzMaxZones = 6;  // device zone + VTIMEZONEs kept
+
+// ---- POSIX TZ parsing ----
+
+static const char* parseName(const char* s) {
+  if (*s == '<') { while (*s && *s != '>') ++s; return *s ? s + 1 : nullptr; }
+  const char* b = s;
+  while ((*s >= 'A' && *s <= 'Z') || (*s >= 'a' && *s <= 'z')) ++s;
+  return (s - b >= 3) ? s : nullptr;
+}
+
+static int parseNum(const char** ps) {
+  int v = 0; const char* s = *ps;
+  while (*s >= '0' && *s <= '9') v = v * 10 + (*s++ - '0');
+  *ps = s;
+  return v;
+}
+
+// [+-]hh[:mm[:ss]] in seconds
+static bool parseHms(const char** ps, int32_t* out) {
+  const char* s = *ps; int sign = 1;
+  if (*s == '+' || *s == '-') { if (*s == '-') sign = -1; ++s; }
+  if (*s < '0' || *s > '9') return false;
+  int32_t v = parseNum(&s) * 3600;
+  if (*s == ':') { ++s; v += parseNum(&s) * 60; }
+  if (*s == ':') { ++s; v += parseNum(&s); }
+  *out = sign * v; *ps = s;
+  return true;
+}
+
+static bool parseWhen(const char** ps, TzWhen* w) {
+  const char* s = *ps;
+  if (*s == 'M') {
+    ++s; w->kind = TzWhen::MonthWeekDay;
+    w->month = (uint8_t)parseNum(&s); if (*s++ != '.') return false;
+    w->week  = (uint8_t)parseNum(&s); if (*s++ != '.') return false;
+    w->wday  = (uint8_t)parseNum(&s);
+    if (w->month < 1 || w->month > 12 || w->week < 1 || w->week > 5 || w->wday > 6) return false;
+  } else if (*s == 'J') {
+    ++s; w->kind = TzWhen::Julian1; w->yday = (int16_t)parseNum(&s);
+  } else if (*s >= '0' && *s <= '9') {
+    w->kind = TzWhen::Julian0; w->yday = (int16_t)parseNum(&s);
+  } else {
+    return false;
+  }
+  w->time = 7200;
+  if (*s == '/' && (++s, !parseHms(&s, &w->time))) return false;
+  *ps = s;
+  return true;
+}
+
+bool tzParsePosix(const char* s, TzRule* out) {
+  *out = TzRule();
+  if (!s || !(s = parseName(s))) return false;
+  int32_t west;
+  if (!parseHms(&s, &west)) return false;
+  out->stdOfs = out->dstOfs = -west;  // POSIX offsets count west of Greenwich
+  if (!*s) return true;
+
+  if (!(s = parseName(s))) return false;
+  out->dstOfs = out->stdOfs + 3600;
+  if (*s && *s != ',') {
+    if (!parseHms(&s, &west)) return false;
+    out->dstOfs = -west;
+  }
+  if (!*s) {
+    // DST without rules: POSIX leaves it to the implementation, newlib uses the US rules
+    const char* us = "M3.2.0,M11.1.0";
+    parseWhen(&us, &out->start); ++us;
+    return parseWhen(&us, &out->end);
+  }
+  if (*s++ != ',' || !parseWhen(&s, &out->start)) return false;
+  if (*s++ != ',' || !parseWhen(&s, &out->end)) return false;
+  return *s == 0;
+}
+
+// ---- Transitions ----
+
+static bool isLeap(int y) { return (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0); }
+
+// Local wall time (seconds since 1970 local) of the switch in year y
+static time_t whenLocal(const TzWhen& w, int y) {
+  long day;
+  if (w.kind == TzWhen::MonthWeekDay) {
+    const long first = daysFromCivil(y, w.month, 1);
+    int d = 1 + (w.wday - weekdayFromDays(first) + 7) % 7 + 7 * (w.week - 1);
+    const int dim = daysInMonth(y, w.month);
+    while (d > dim) d -= 7;  // week 5 = last
+    day = first + d - 1;
+  } else if (w.kind == TzWhen::Julian1) {
+    day = daysFromCivil(y, 1, 1) + w.yday - 1 + ((isLeap(y) && w.yday >= 60) ? 1 : 0);
+  } else {
+    day = daysFromCivil(y, 1, 1) + w.yday;
+  }
+  return (time_t)day * 86400 + w.time;
+}
+
+// The two switches of year y as UTC instants, plus the offset each one leads to
+static void yearTransitions(const TzRule& r, int y, time_t at[2], int32_t to[2]) {
+  time_t s = whenLocal(r.start, y) - r.stdOfs;
+  time_t e = whenLocal(r.end, y) - r.dstOfs;
+  if (s <= e) { at[0] = s; to[0] = r.dstOfs; at[1] = e; to[1] = r.stdOfs; }
+  else        { at[0] = e; to[0] = r.stdOfs; at[1] = s; to[1] = r.dstOfs; }  // southern hemisphere
+}
+
+static int yearOfUTC(time_t t) {
+  int y, m, d; civilFromDays(floorDiv((long)(t / 60), 1440), &y, &m, &d);
+  return y;
+}
+
+void TzZone::set(const TzRule& r, int fromYear) {
+  rule_ = r; fromYear_ = fromYear; n_ = 0;
+  ofs_[0] = r.stdOfs;
+  if (!r.hasDst()) return;
+
+  for (int y = fromYear; y < fromYear + kTzYears; ++y) {
+    time_t at[2]; int32_t to[2];
+    yearTransitions(r, y, at, to);
+    for (int k = 0; k < 2; ++k) { at_[n_] = at[k]; ofs_[n_ + 1] = to[k]; n_++; }
+  }
+  // Before the first switch of the span: the offset the year's last switch leads to
+  ofs_[0] = ofs_[n_];
+  // A day inside the span on both ends: switches near New Year may fall across it in UTC
+  lo_ = (time_t)(daysFromCivil(fromYear, 1, 1) + 1) * 86400;
+  hi_ = (time_t)(daysFromCivil(fromYear + kTzYears, 1, 1) - 1) * 86400;
+}
+
+int32_t TzZone::offsetAt(time_t utc) const {
+  if (!rule_.hasDst()) return rule_.stdOfs;
+  if (utc < lo_ || utc >= hi_) return ruleOffset(utc);
+  int i = 0;
+  for (int k = 0; k < n_; ++k) i += (utc >= at_[k]);
+  return ofs_[i];
+}
+
+int32_t TzZone::ruleOffset(time_t utc) const {
+  const int y = yearOfUTC(utc);
+  time_t at[2]; int32_t to[2];
+  yearTransitions(rule_, y, at, to);
+  if (utc >= at[1]) return to[1];
+  if (utc >= at[0]) return to[0];
+  return to[1];  // before the year's first switch: state left by last year's second one
+}
+
+time_t TzZone::localToUTC(time_t local) const {
+  time_t u = local - rule_.stdOfs;
+  u = local - offsetAt(u);
+  return local - offsetAt(u);
+}
+
+// ---- Zone registry ----
+
+static TzZone   gZones[kTzMaxZones];   // feed zones from slot 1
+static uint32_t gZoneIds[kTzMaxZones];  // TZID hash, 0 = free (slot 0: device)
+
+// Device zone, double-buffered: a rebuild fills the copy readers do not use and then
+// publishes it with one pointer store, so a worker converting a time never sees a table
+// half rebuilt; the copy it replaces stays intact until the next TZ or year change.
+// Keyed on the TZ string's length + hash, so a string of any length is recognized.
+static TzZone           gDeviceZones[2];
+static TzZone* volatile gDevice = &gDeviceZones[0];
+static size_t           gDevicePosixLen = (size_t)-1;
+static uint32_t         gDevicePosixHash = 0;
+static bool             gDeviceRebuilding = false;
+
+void tzSetDevice(const char* posix, time_t nowUTC) {
+  if (!posix) posix = "UTC0";
+  const int y = yearOfUTC(nowUTC) - 1;
+  const size_t len = strlen(posix);
+  const uint32_t hash = fnv1a(posix, len);
+
+  ZONE_LOCK();
+  const bool current = len == gDevicePosixLen && hash == gDevicePosixHash && y == gDevice->fromYear();
+  const bool build = !current && !gDeviceRebuilding;  // one rebuild at a time; it publishes for all
+  if (build) gDeviceRebuilding = true;
+  TzZone* spare = (gDevice == &gDeviceZones[0]) ? &gDeviceZones[1] : &gDeviceZones[0];
+  ZONE_UNLOCK();
+  if (!build) return;
+
+  // The transition table takes a while: built outside the critical section
+  TzRule r;
+  tzParsePosix(posix, &r);
+  spare->set(r, y);
+
+  ZONE_LOCK();
+  gDevice = spare;
+  gDevicePosixLen = len;
+  gDevicePosixHash = hash;
+  gDeviceRebuilding = false;
+  ZONE_UNLOCK();
+}
+
+const TzZone& tzDevice() { return *gDevice; }
+
+time_t tzDayStartUTC(time_t refUTC, int addDays) {
+  const TzZone& z = *gDevice;
+  const long day = floorDiv((long)(z.utcToLocal(refUTC) / 60), 1440) + addDays;
+  return z.localToUTC((time_t)day * 86400);
+}
+
+int8_t tzRegister(uint32_t tzidHash, const TzRule& r) {
+  if (!tzidHash) return 0;
+  ZONE_LOCK();
+  int8_t slot = tzFind(tzidHash);
+  if (slot == 0) {
+    for (int i = 1; i < kTzMaxZones; ++i) if (!gZoneIds[i]) { slot = (int8_t)i; break; }
+  }
+  if (slot != 0) {  // table full: the device zone is the best guess
+    gZoneIds[slot] = tzidHash;
+    gZones[slot].set(r, gDevice->fromYear());
+  }
+  ZONE_UNLOCK();
+  return slot;
+}
+
+int8_t tzFind(uint32_t tzidHash) {
+  for (int i = 1; i < kTzMaxZones; ++i) if (gZoneIds[i] == tzidHash) return (int8_t)i;
+  return 0;
+}
+
+const TzZone& tzZone(int8_t idx) {
+  return (idx > 0 && idx < kTzMaxZones) ? gZones[idx] : *gDevice;
+}
@@ -0,0 +1,66 @@
+// TimeZone.h
+// Local <-> UTC conversion without libc TZ state (no mktime/localtime/tzset per value)
+// - Zones come from a POSIX TZ rule ("CET-1CEST,M3.5.0,M10.5.0/3") or a feed's VTIMEZONE
+// - DST transitions for a few years around "now" are precomputed into a sorted table;
+//   an offset is a fixed-length compare-and-count over it (outside: same rule, computed)
+// - Zone 0 is the device zone; feed zones are registered under a hash of their TZID
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+// One yearly switch: POSIX Mm.w.d (week 5 = last), Jn (1..365, no Feb 29) or n (0..365)
+struct TzWhen {
+  enum Kind : uint8_t { None, MonthWeekDay, Julian1, Julian0 };
+  Kind    kind{None};
+  uint8_t month{0}, week{0}, wday{0};
+  int16_t yday{0};
+  int32_t time{7200};  // local wall time of the switch, in the offset in effect before it
+};
+
+struct TzRule {
+  int32_t stdOfs{0};  // seconds east of UTC
+  int32_t dstOfs{0};  // == stdOfs without DST
+  TzWhen  start;      // std -> dst
+  TzWhen  end;        // dst -> std
+  bool hasDst() const { return start.kind != TzWhen::None && end.kind != TzWhen::None; }
+};
+
+// false on syntax the rule cannot express (the zone then stays at UTC)
+bool tzParsePosix(const char* s, TzRule* out);
+
+static const int kTzYears = 4;  // years covered by a zone's transition table
+
+class TzZone {
+public:
+  // Precompute transitions for [fromYear, fromYear + kTzYears)
+  void set(const TzRule& r, int fromYear);
+  const TzRule& rule() const { return rule_; }
+  int  fromYear() const { return fromYear_; }
+
+  int32_t offsetAt(time_t utc) const;
+  time_t  utcToLocal(time_t utc) const { return utc + offsetAt(utc); }
+  // Wall clock (seconds since 1970-01-01 local) to UTC; gaps and repeated hours read as standard time
+  time_t  localToUTC(time_t local) const;
+
+private:
+  int32_t ruleOffset(time_t utc) const;
+
+  TzRule  rule_;
+  int     fromYear_{1970};
+  int     n_{0};
+  time_t  at_[2 * kTzYears]{};     // transition instants (UTC), ascending
+  int32_t ofs_[2 * kTzYears + 1]{};  // ofs_[i]: offset after i transitions
+  time_t  lo_{0}, hi_{0};          // table span (UTC)
+};
+
+// Device zone from a POSIX TZ string; rebuilt when the string or the covered years change
+void tzSetDevice(const char* posix, time_t nowUTC);
+const TzZone& tzDevice();
+// UTC epoch of local midnight (device zone), addDays after the day containing refUTC
+time_t tzDayStartUTC(time_t refUTC, int addDays = 0);
+
+// Feed zones (VTIMEZONE). Index 0 is the device zone; unknown TZIDs map to it.
+int8_t tzRegister(uint32_t tzidHash, const TzRule& r);
+int8_t tzFind(uint32_t tzidHash);
+const TzZone& tzZone(int8_t idx);
@@ -0,0 +1,59 @@
+// UiLayout.h
+// Geometry of the 800x480 dashboard: the header, the three columns and every partial region
+// - Shared by the sketch (buffers, pushes) and PanelRender (what is drawn where)
+// - Plain macros with short names (W, H): include it after the library headers
+#pragma once
+
+#define W 800  // EPD_7IN5_V2_WIDTH
+#define H 480  // EPD_7IN5_V2_HEIGHT
+
+// Calendar row layout (time + title)
+#define CAL_TIME_X 0
+#define CAL_TITLE_X 140
+
+
+// Header
+#define HDR_X 0
+#define HDR_Y 0
+#define HDR_W W
+#define HDR_H 46
+
+// Left column (Weather)
+#define GUTTER 8
+#define COL_L_X GUTTER
+#define COL_L_Y (HDR_Y + HDR_H + 4)
+#define COL_L_W 360
+#define COL_L_H 260
+
+// Right column (Calendar)
+#define COL_R_X (COL_L_X + COL_L_W + 12)
+#define COL_R_Y COL_L_Y
+#define COL_R_W (W - COL_R_X - GUTTER)
+#define COL_R_H COL_L_H
+
+// Bottom row (Plants)
+#define BOT_X GUTTER
+#define BOT_Y (COL_L_Y + COL_L_H + 12)
+#define BOT_W (W - 2 * GUTTER)
+#define BOT_H (H - BOT_Y - GUTTER)
+
+// Partial update rectangles
+#define PRT_CLK_X (W - 270)
+#define PRT_CLK_Y (HDR_Y + 6)
+#define PRT_CLK_W 260
+#define PRT_CLK_H (HDR_H - 12)
+
+#define PRT_WTH_X (COL_L_X + 6)
+#define PRT_WTH_Y (COL_L_Y + 26)
+#define PRT_WTH_W (COL_L_W - 12)
+#define PRT_WTH_H (COL_L_H - 36)
+
+#define PRT_CAL_X (COL_R_X + 6)
+#define PRT_CAL_Y (COL_R_Y + 26)
+#define PRT_CAL_W (COL_R_W - 12)
+#define PRT_CAL_H (COL_R_H - 36)
+
+#define PRT_PLT_X (BOT_X + 6)
+#define PRT_PLT_Y (BOT_Y + 26)
+#define PRT_PLT_W (BOT_W - 12)
+#define PRT_PLT_H (BOT_H - 36)
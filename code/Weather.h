@@ -0,0 +1,52 @@
+// Weather.h
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+typedef enum {
+  WeatherIcon_Sun = 0,
+  WeatherIcon_Partly,
+  WeatherIcon_Rain,
+  WeatherIcon_Storm,
+} WeatherIcon;
+
+typedef struct {
+  WeatherIcon icon;
+  char condition[24];
+  int tempNow;       // °C
+  int feelsLike;     // °C
+  int tempHigh;      // °C
+  int tempLow;       // °C
+  int humidity;      // %
+  int precipChance;  // %
+  int windKph;       // km/h
+  char windDir[4];
+  int uvIndex;
+} WeatherData;
+
+// Network counters of the weather fetch
+struct WeatherNetStats {
+  uint32_t fetches{0};    // responses parsed into the cache
+  uint32_t failures{0};   // failed fetches (the previous data is kept)
+  uint32_t cacheHits{0};  // reads answered without touching the network
+};
+
+class IWeatherProvider {
+public:
+  virtual ~IWeatherProvider() {}
+  virtual bool begin() = 0;
+  virtual void setLocation(float lat, float lon) = 0;
+  // Current conditions and today's range; refreshes from the network only when the
+  // cached response expired (Cache-Control max-age, else a default TTL).
+  // false until the first fetch succeeded.
+  virtual bool read(WeatherData* out) = 0;
+  // Force a network refresh of the cache (normally driven by read's TTL)
+  virtual bool refresh() { return false; }
+  // UTC time the cached response goes stale
+  virtual time_t expiresAt() const { return 0; }
+  virtual WeatherNetStats netStats() const { return WeatherNetStats(); }
+};
+
+// Open-Meteo forecast API (no key); the JSON is scanned as it streams in, only the
+// fields WeatherData needs are kept.
+IWeatherProvider* makeOpenMeteoWeatherProvider(bool insecureTLS = true);
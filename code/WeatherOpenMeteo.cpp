@@ -0,0 +1,203 @@
+// WeatherOpenMeteo.cpp
+// Open-Meteo weather provider for ESP32 (Arduino)
+// - One small GET for current conditions + today's daily range, no API key
+// - Streams the body through JsonScanner: no document buffer, no heap per field
+// - Caches the parsed WeatherData; read() only fetches once the TTL ran out
+//   (Cache-Control max-age, clamped; a default TTL when the server sends none)
+// - A failed fetch keeps serving the last good data and retries after kRetrySec
+// - Own persistent HttpSession (different origin than the calendar); meant to be
+//   driven from the calendar's fetch task so the render loop never blocks on it
+
+#include "Weather.h"
+#include "HttpSession.h"
+#include "JsonScanner.h"
+#include "Metrics.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+// ---- Tunables ----
+static const uint32_t kDefaultTtlSec = 15 * 60;  // no Cache-Control max-age
+static const uint32_t kMinTtlSec     = 5 * 60;   // floor, also for no-cache / no-store
+static const uint32_t kMaxTtlSec     = 3 * 3600; // ceiling for generous max-age values
+static const uint32_t kRetrySec      = 2 * 60;   // back-off after a failed fetch
+static const char*    kBaseUrl       = "https://api.open-meteo.com/v1/forecast";
+static const char*    kFields =
+  "&current=temperature_2m,apparent_temperature,relative_humidity_2m,weather_code,"
+  "wind_speed_10m,wind_direction_10m"
+  "&daily=temperature_2m_max,temperature_2m_min,uv_index_max,precipitation_probability_max"
+  "&timezone=auto&forecast_days=1&wind_speed_unit=kmh";
+
+// ---- Small helpers ----
+
+// TTL from a Cache-Control header; kDefaultTtlSec when it carries no max-age
+static uint32_t ttlFromCacheControl(const String& cc) {
+  if (cc.indexOf("no-store") >= 0 || cc.indexOf("no-cache") >= 0) return kMinTtlSec;
+  int p = cc.indexOf("max-age=");
+  if (p < 0) return kDefaultTtlSec;
+  long s = atol(cc.c_str() + p + 8);
+  if (s < (long)kMinTtlSec) return kMinTtlSec;
+  if (s > (long)kMaxTtlSec) return kMaxTtlSec;
+  return (uint32_t)s;
+}
+
+// WMO weather interpretation code → panel icon + short text
+static void applyWeatherCode(int code, WeatherData* w) {
+  struct Row { int upTo; WeatherIcon icon; const char* text; };
+  static const Row kRows[] = {
+    { 0,  WeatherIcon_Sun,    "Clear" },
+    { 2,  WeatherIcon_Partly, "Partly Cloudy" },
+    { 3,  WeatherIcon_Partly, "Overcast" },
+    { 48, WeatherIcon_Partly, "Fog" },
+    { 57, WeatherIcon_Rain,   "Drizzle" },
+    { 67, WeatherIcon_Rain,   "Rain" },
+    { 77, WeatherIcon_Rain,   "Snow" },
+    { 82, WeatherIcon_Rain,   "Showers" },
+    { 86, WeatherIcon_Rain,   "Snow Showers" },
+    { 99, WeatherIcon_Storm,  "Thunderstorm" },
+  };
+  for (const Row& r : kRows) {
+    if (code > r.upTo) continue;
+    w->icon = r.icon;
+    snprintf(w->condition, sizeof(w->condition), "%s", r.text);
+    return;
+  }
+  w->icon = WeatherIcon_Partly;
+  snprintf(w->condition, sizeof(w->condition), "Unknown");
+}
+
+// Degrees (direction the wind comes from) → 8-point compass
+static void compass8(double deg, char* out, size_t n) {
+  static const char* kDirs[] = { "N", "NE", "E", "SE", "S", "SW", "W", "NW" };
+  int i = (int)lround(fmod(fmod(deg, 360.0) + 360.0, 360.0) / 45.0) % 8;
+  snprintf(out, n, "%s", kDirs[i]);
+}
+
+// ---- Provider implementation ----
+
+class OpenMeteoWeatherProvider : public IWeatherProvider {
+public:
+  explicit OpenMeteoWeatherProvider(bool insecure) : session_(insecure) {}
+
+  bool begin() override { return true; }
+
+  void setLocation(float lat, float lon) override {
+    char q[64];
+    snprintf(q, sizeof(q), "?latitude=%.4f&longitude=%.4f", lat, lon);
+    url_ = String(kBaseUrl) + q + kFields;
+    valid_ = false; expires_ = 0;  // cached data belongs to the old place
+  }
+
+  bool read(WeatherData* out) override {
+    if (!out) return false;
+    time_t now; time(&now);
+    if (!url_.length() || now < expires_) stats_.cacheHits++;
+    else refresh();
+    if (!valid_) return false;
+    *out = cache_;
+    return true;
+  }
+
+  bool refresh() override {
+    time_t now; time(&now);
+    uint32_t ttl = 0;
+    const bool ok = fetch(&ttl);
+    if (ok) stats_.fetches++; else stats_.failures++;
+    expires_ = now + (time_t)(ok ? ttl : kRetrySec);
+    DBG("[WTH] refresh %s, next in %us\n", ok ? "ok" : "failed", (unsigned)(expires_ - now));
+    return ok;
+  }
+
+  time_t expiresAt() const override { return expires_; }
+  WeatherNetStats netStats() const override { return stats_; }
+
+private:
+  // Field bits; a response must carry at least kNeed to replace the cache
+  enum : uint16_t {
+    kTemp = 1, kFeels = 2, kHum = 4, kCode = 8, kWind = 16, kWindDir = 32,
+    kHigh = 64, kLow = 128, kUv = 256, kPrecip = 512,
+    kNeed = kTemp | kCode,
+  };
+
+  struct Scan {
+    WeatherData w;
+    uint16_t seen;
+  };
+
+  // "current.<field>" and "daily.<field>[0]"; everything else streams past
+  static void onValue(void* ctx, const JsonScanner& at, const char* v, bool isString) {
+    if (isString || !strcmp(v, "null")) return;
+    Scan& s = *(Scan*)ctx;
+    const double x = atof(v);
+    const int    r = (int)lround(x);
+    if (at.depth() == 2 && at.keyIs(0, "current")) {
+      const char* k = at.key(1);
+      if      (!strcmp(k, "temperature_2m"))       { s.w.tempNow = r;   s.seen |= kTemp; }
+      else if (!strcmp(k, "apparent_temperature")) { s.w.feelsLike = r; s.seen |= kFeels; }
+      else if (!strcmp(k, "relative_humidity_2m")) { s.w.humidity = r;  s.seen |= kHum; }
+      else if (!strcmp(k, "weather_code"))         { applyWeatherCode(r, &s.w); s.seen |= kCode; }
+      else if (!strcmp(k, "wind_speed_10m"))       { s.w.windKph = r;   s.seen |= kWind; }
+      else if (!strcmp(k, "wind_direction_10m"))   { compass8(x, s.w.windDir, sizeof(s.w.windDir)); s.seen |= kWindDir; }
+    } else if (at.depth() == 3 && at.keyIs(0, "daily") && at.index(2) == 0) {
+      const char* k = at.key(1);
+      if      (!strcmp(k, "temperature_2m_max"))            { s.w.tempHigh = r;     s.seen |= kHigh; }
+      else if (!strcmp(k, "temperature_2m_min"))            { s.w.tempLow = r;      s.seen |= kLow; }
+      else if (!strcmp(k, "uv_index_max"))                  { s.w.uvIndex = r;      s.seen |= kUv; }
+      else if (!strcmp(k, "precipitation_probability_max")) { s.w.precipChance = r; s.seen |= kPrecip; }
+    }
+  }
+
+  bool fetch(uint32_t* ttl) {
+    if (!url_.length() || !session_.begin(url_)) return false;
+    HTTPClient& http = session_.http();
+    http.setAcceptEncoding("identity");  // well under 1 KB, not worth an inflate window
+
+    int code = session_.GET();
+    if (code != 200) {
+      DBG("[WTH] GET code=%d\n", code);
+      session_.end();
+      return false;
+    }
+    *ttl = ttlFromCacheControl(http.header("Cache-Control"));
+
+    Scan s;
+    s.w = cache_;  // fields missing from this response keep their last value
+    s.seen = 0;
+    JsonScanner json;
+    json.begin(onValue, &s);
+    uint8_t buf[256];
+    int got;
+    {
+      PhaseTimer timer(Phase::Transfer);
+      while ((got = session_.read(buf, sizeof(buf))) > 0) {
+        timer.addBytes((uint32_t)got);
+        if (!json.feed(buf, (size_t)got)) break;
+      }
+    }
+    session_.end();
+
+    if (got < 0 || json.failed() || (s.seen & kNeed) != kNeed) {
+      DBG("[WTH] bad body (read=%d json_failed=%d fields=0x%03x)\n", got, json.failed() ? 1 : 0, s.seen);
+      return false;
+    }
+    cache_ = s.w;
+    valid_ = true;
+    return true;
+  }
+
+  HttpSession     session_;
+  String          url_;
+  WeatherData     cache_{};
+  bool            valid_{false};
+  time_t          expires_{0};
+  WeatherNetStats stats_;
+};
+
+// Factory
+IWeatherProvider* makeOpenMeteoWeatherProvider(bool insecureTLS) {
+  return new OpenMeteoWeatherProvider(insecureTLS);
+}
@@ -0,0 +1,164 @@
+// WifiLink.cpp
+#include "WifiLink.h"
+#include "Fnv1a.h"
+#include "Metrics.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+
+#ifndef DBG
+  #define DBG(...) printf(__VA_ARGS__)
+#endif
+
+WifiLink gWifi;
+
+// ---- Tunables ----
+static const uint32_t kFastTimeoutMs = 2000;  // cached BSSID/channel: give up and scan after this
+static const uint32_t kPollMs        = 10;    // status poll while associating
+static const uint32_t kCacheMagic    = 0x574C4B31;  // "WLK1"
+static const char*    kNvsNamespace  = "wifilink";
+static const char*    kNvsKey        = "cache";
+
+void WifiLink::begin(const char* ssid, const char* pass, bool staticIp, bool offWhenIdle) {
+  ssid_ = ssid; pass_ = pass;
+  staticIp_ = staticIp; offWhenIdle_ = offWhenIdle;
+  if (!mutex_) mutex_ = xSemaphoreCreateMutex();
+  WiFi.persistent(false);  // the SDK's own flash copy of the config is not needed
+  loadCache();
+}
+
+void WifiLink::lock()   { if (mutex_) xSemaphoreTake(mutex_, portMAX_DELAY); }
+void WifiLink::unlock() { if (mutex_) xSemaphoreGive(mutex_); }
+
+bool WifiLink::connected() const {
+  return WiFi.status() == WL_CONNECTED;
+}
+
+bool WifiLink::acquire(uint32_t timeoutMs) {
+  lock();
+  users_++;
+  if (connected()) {
+    WiFi.setSleep(WIFI_PS_NONE);  // full throughput while a job holds the link
+    unlock();
+    return true;
+  }
+  if (connecting_) {  // another job is associating: wait for its attempt
+    unlock();
+    return waitConnected(millis(), timeoutMs);
+  }
+  connecting_ = true;
+  unlock();
+  // Seconds with a scan: users_ > 0 keeps release() from idling the radio meanwhile
+  const bool ok = connect(timeoutMs);
+  lock();
+  connecting_ = false;
+  unlock();
+  return ok;
+}
+
+void WifiLink::release() {
+  lock();
+  if (users_ > 0 && --users_ == 0) idle();
+  unlock();
+}
+
+void WifiLink::idle() {
+  if (offWhenIdle_) {
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+  } else if (connected()) {
+    WiFi.setSleep(WIFI_PS_MAX_MODEM);  // stays associated, radio wakes per DTIM
+  }
+}
+
+void WifiLink::forget() {
+  lock();
+  cacheValid_ = false;
+  Preferences nvs;
+  if (nvs.begin(kNvsNamespace, false)) { nvs.remove(kNvsKey); nvs.end(); }
+  unlock();
+}
+
+bool WifiLink::waitConnected(uint32_t t0, uint32_t timeoutMs) {
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - t0 >= timeoutMs) return false;
+    delay(kPollMs);
+  }
+  return true;
+}
+
+// Fast path first (no scan, optionally no DHCP); one full scan + DHCP if that fails
+bool WifiLink::connect(uint32_t timeoutMs) {
+  if (!ssid_) return false;
+  const uint32_t t0 = millis(), us0 = (uint32_t)micros();
+  stats_.attempts++;
+  WiFi.mode(WIFI_STA);
+
+  bool fast = cacheValid_, ok = false;
+  if (fast) {
+    if (staticIp_ && cache_.ip)
+      WiFi.config(IPAddress(cache_.ip), IPAddress(cache_.gateway), IPAddress(cache_.mask), IPAddress(cache_.dns));
+    WiFi.begin(ssid_, pass_, cache_.channel, cache_.bssid, true);
+    ok = waitConnected(t0, timeoutMs < kFastTimeoutMs ? timeoutMs : kFastTimeoutMs);
+    if (!ok) {
+      DBG("[WiFi] cached AP did not answer, scanning\n");
+      WiFi.disconnect();
+      cacheValid_ = false;
+      fast = false;
+    }
+  }
+  if (!ok && millis() - t0 < timeoutMs) {
+    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));  // back to DHCP
+    WiFi.begin(ssid_, pass_);
+    ok = waitConnected(t0, timeoutMs);
+  }
+
+  const uint32_t ms = millis() - t0;
+  if (ok) {
+    metricsRecord(Phase::WifiConnect, (uint32_t)micros() - us0);
+    if (fast) stats_.fast++; else stats_.full++;
+    stats_.lastMs = ms;
+    if (!stats_.bestMs || ms < stats_.bestMs) stats_.bestMs = ms;
+    if (ms > stats_.worstMs) stats_.worstMs = ms;
+    storeCache();
+  } else {
+    stats_.failures++;
+  }
+  DBG("[WiFi] %s connect %s in %u ms (IP=%s, RSSI=%d dBm, ch %d)\n", fast ? "fast" : "full",
+      ok ? "ok" : "FAILED", (unsigned)ms, WiFi.localIP().toString().c_str(), WiFi.RSSI(), (int)WiFi.channel());
+  return ok;
+}
+
+void WifiLink::loadCache() {
+  cacheValid_ = false;
+  Preferences nvs;
+  if (!nvs.begin(kNvsNamespace, true)) return;
+  Cache c;
+  if (nvs.getBytes(kNvsKey, &c, sizeof(c)) == sizeof(c) && c.magic == kCacheMagic && c.ssidHash == fnv1a(ssid_)) {
+    cache_ = c;
+    cacheValid_ = true;
+  }
+  nvs.end();
+}
+
+// Written only when the association changed: NVS is flash, every connect would wear it
+void WifiLink::storeCache() {
+  Cache c{};
+  c.magic = kCacheMagic;
+  c.ssidHash = fnv1a(ssid_);
+  const uint8_t* bssid = WiFi.BSSID();
+  if (bssid) memcpy(c.bssid, bssid, sizeof(c.bssid));
+  c.channel = (uint8_t)WiFi.channel();
+  c.ip = (uint32_t)WiFi.localIP();
+  c.gateway = (uint32_t)WiFi.gatewayIP();
+  c.mask = (uint32_t)WiFi.subnetMask();
+  c.dns = (uint32_t)WiFi.dnsIP();
+  if (cacheValid_ && memcmp(&c, &cache_, sizeof(c)) == 0) return;
+
+  Preferences nvs;
+  if (!nvs.begin(kNvsNamespace, false)) return;
+  nvs.putBytes(kNvsKey, &c, sizeof(c));
+  nvs.end();
+  cache_ = c;
+  cacheValid_ = true;
+}
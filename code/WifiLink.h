@@ -0,0 +1,85 @@
+// WifiLink.h
+// WiFi connection manager: fast (re)connect, radio asleep between fetches
+// - Caches BSSID + channel (and optionally the DHCP lease as static IP/DNS) in NVS,
+//   so a reconnect skips the scan and DHCP; falls back to a full connect once
+// - Reference counted: network jobs acquire() the link, the last release() idles
+//   the radio (modem sleep while associated, or radio off for a fast reconnect)
+// - connect() runs outside the lock: a second acquire() waits for that attempt instead of
+//   starting its own, and release()/forget() never block behind an association
+// - Every attempt is timed (Metrics WifiConnect + stats) to compare fast vs full
+#pragma once
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+struct WifiLinkStats {
+  uint32_t attempts{0};   // connects started
+  uint32_t fast{0};       // associated via the cached BSSID/channel
+  uint32_t full{0};       // scanned (no cache or the cached AP failed)
+  uint32_t failures{0};   // timed out
+  uint32_t lastMs{0};     // duration of the last successful connect
+  uint32_t bestMs{0};
+  uint32_t worstMs{0};
+};
+
+class WifiLink {
+public:
+  // offWhenIdle: radio off between fetches instead of modem sleep (reconnects cost ~0.3 s)
+  // staticIp: reuse the cached DHCP lease as static config (skip DHCP)
+  void begin(const char* ssid, const char* pass, bool staticIp, bool offWhenIdle);
+
+  // Wake the radio and connect if needed; true when the link is up. Pair with release().
+  bool acquire(uint32_t timeoutMs);
+  void release();
+  bool connected() const;
+
+  // Drop the cached association (e.g. after moving the device)
+  void forget();
+
+  const WifiLinkStats& stats() const { return stats_; }
+
+private:
+  struct Cache {
+    uint32_t magic;
+    uint32_t ssidHash;
+    uint8_t  bssid[6];
+    uint8_t  channel;
+    uint8_t  reserved;
+    uint32_t ip, gateway, mask, dns;
+  };
+
+  bool connect(uint32_t timeoutMs);
+  bool waitConnected(uint32_t t0, uint32_t timeoutMs);
+  void loadCache();
+  void storeCache();
+  void idle();
+  void lock();
+  void unlock();
+
+  const char* ssid_{nullptr};
+  const char* pass_{nullptr};
+  bool  staticIp_{false};
+  bool  offWhenIdle_{false};
+  int   users_{0};
+  bool  connecting_{false};  // an acquire() is associating (outside the lock)
+  Cache cache_{};
+  bool  cacheValid_{false};
+  SemaphoreHandle_t mutex_{nullptr};
+  WifiLinkStats stats_;
+};
+
+// Scoped acquire/release around a network job; want = false leaves the radio alone
+class WifiLease {
+public:
+  WifiLease(WifiLink& link, uint32_t timeoutMs, bool want = true)
+  : link_(link), held_(want), ok_(want && link.acquire(timeoutMs)) {}
+  ~WifiLease() { if (held_) link_.release(); }
+  bool ok() const { return ok_; }
+
+private:
+  WifiLink& link_;
+  bool held_;
+  bool ok_;
+};
+
+extern WifiLink gWifi;
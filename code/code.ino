@@ -3,8 +3,22 @@
  * - Uses ICalendarProvider (Calendar.h) + ICS backend (CalendarIcs.cpp)
  * - Memory-safe partial framebuffer sizing (max of all regions)
  * - Robust time init + guarded calendar rendering
- * - Partial updates: clock (1s), sensors/plants (10s), calendar (60s)
- * - Full refresh every ~10 min to mitigate ghosting
+ * - Partial updates: clock (each minute boundary), sensors/plants (10s), calendar (60s),
+ *   run by a deadline Scheduler; loop() sleeps until the earliest deadline
+ * - Text via TextRenderer (glyph atlas blits instead of per-pixel Paint_DrawChar)
+ * - Drawing and panel pushes go through a display backend (DisplayBackend.h): Waveshare
+ *   Paint_* and EPD_* calls on the device, an in-memory PBM renderer on a host (DisplayPbm.h);
+ *   the panel contents themselves (PanelRender.cpp) build on a host too (host/)
+ * - Calendar fetch/parse on a background task (core 0); loop() picks up
+ *   finished snapshots without blocking, so the clock never waits on I/O
+ * - Ghosting-aware refresh policy (GhostBudget): partial refreshes and flipped pixels
+ *   are counted per region; a region over budget gets a local inverse/normal cleanup,
+ *   repeated cleanups or a long stretch without one get a full refresh in a quiet
+ *   window. FBFull is kept composited (chrome + every region render), so a full
+ *   refresh is one push with no refetch
+ * - Content-hash dirty tracking: unchanged regions are not re-pushed
+ * - Optional deep-sleep mode (gConfig.deepSleep): wake each minute for the clock,
+ *   WiFi only on refresh cycles, state kept in RTC memory (SleepState.h)
  */
 
 #include "DEV_Config.h"
@@ -22,6 +36,25 @@
 #include "DateTimeFormatter.h"
 #include "Clock.h"
 #include "Calendar.h"
+#include "CalendarFeed.h"
+#include "TimeZone.h"
+#include "Weather.h"
+#include "PlantSensors.h"
+#include "DirtyRegion.h"
+#include "SleepState.h"
+#include "SnapshotChannel.h"
+#include "BackgroundTask.h"
+#include "TextRenderer.h"
+#include "MasterFrame.h"
+#include "Panel.h"
+#include "Scheduler.h"
+#include "Metrics.h"
+#include "WifiLink.h"
+#include "BootSnapshot.h"
+#include "EpdPush.h"
+#include "GhostBudget.h"
+#include "DisplayBackend.h"
+#include "PanelRender.h"
 
 
 #ifndef DBG
@@ -50,91 +83,52 @@ static const char* CAL_URL = SECRET_CAL_URL;
 
 
 // ---------- Layout constants ----------
-#define W EPD_7IN5_V2_WIDTH   // 800
-#define H EPD_7IN5_V2_HEIGHT  // 480
-
-// Calendar row layout (time + title)
-#define CAL_TIME_X 0
-#define CAL_TITLE_X 140
-
-
-// Header
-#define HDR_X 0
-#define HDR_Y 0
-#define HDR_W W
-#define HDR_H 46
-
-// Left column (Weather)
-#define GUTTER 8
-#define COL_L_X GUTTER
-#define COL_L_Y (HDR_Y + HDR_H + 4)
-#define COL_L_W 360
-#define COL_L_H 260
-
-// Right column (Calendar)
-#define COL_R_X (COL_L_X + COL_L_W + 12)
-#define COL_R_Y COL_L_Y
-#define COL_R_W (W - COL_R_X - GUTTER)
-#define COL_R_H COL_L_H
-
-// Bottom row (Plants)
-#define BOT_X GUTTER
-#define BOT_Y (COL_L_Y + COL_L_H + 12)
-#define BOT_W (W - 2 * GUTTER)
-#define BOT_H (H - BOT_Y - GUTTER)
-
-// Partial update rectangles
-#define PRT_CLK_X (W - 270)
-#define PRT_CLK_Y (HDR_Y + 6)
-#define PRT_CLK_W 260
-#define PRT_CLK_H (HDR_H - 12)
-
-#define PRT_WTH_X (COL_L_X + 6)
-#define PRT_WTH_Y (COL_L_Y + 26)
-#define PRT_WTH_W (COL_L_W - 12)
-#define PRT_WTH_H (COL_L_H - 36)
-
-#define PRT_CAL_X (COL_R_X + 6)
-#define PRT_CAL_Y (COL_R_Y + 26)
-#define PRT_CAL_W (COL_R_W - 12)
-#define PRT_CAL_H (COL_R_H - 36)
-
-#define PRT_PLT_X (BOT_X + 6)
-#define PRT_PLT_Y (BOT_Y + 26)
-#define PRT_PLT_W (BOT_W - 12)
-#define PRT_PLT_H (BOT_H - 36)
+#include "UiLayout.h"
+static_assert(W == EPD_7IN5_V2_WIDTH && H == EPD_7IN5_V2_HEIGHT, "UiLayout.h is laid out for the 7.5 inch V2 panel");
+
+// Time zone (Europe/Berlin) and refresh cadences
+#define TZ_POSIX "CET-1CEST,M3.5.0,M10.5.0/3"
+#define FULL_REFRESH_S 600        // deep sleep: full refresh cadence (no ghost counts across sleeps)
+#define GHOST_CHECK_MS 5000       // ghosting policy check
+#define GHOST_QUIET_S 15          // full refresh only with at least this long to the next minute
+#define SNAPSHOT_FRAME_S 600      // persist the frame and dump stats this often
+#define WIFI_TIMEOUT_MS 15000     // cold boot connect wait
+#define SLEEP_WIFI_TIMEOUT_MS 10000  // deep sleep refresh cycle connect wait
+#define FETCH_WIFI_TIMEOUT_MS 8000   // background fetch: wake the link from modem sleep / off
+#define SENSOR_PERIOD_MS 10000
+#define CAL_PERIOD_MS 60000          // background calendar query (network only when its cache is stale)
+#define METRICS_POLL_MS 250          // serial command / HTTP endpoint poll
+#define CAL_POLL_MS 2000             // render side: pick up published calendar rows
+#define SNAPSHOT_CAL_S 1800          // fetch task: persist the calendar cache at most this often
+#define CAL_SLICE_MS 20              // CAL_TIME_SLICED: work per calendar slice
+#define CAL_SLICE_PERIOD_MS 50       // CAL_TIME_SLICED: slice cadence while a refresh runs
 
 // ---------- Data types ----------
-typedef enum {
-  WeatherIcon_Sun = 0,
-  WeatherIcon_Partly,
-  WeatherIcon_Rain,
-  WeatherIcon_Storm,
-} WeatherIcon;
-
-typedef struct {
-  WeatherIcon icon;
-  char condition[24];
-  int tempNow;       // °C
-  int feelsLike;     // °C
-  int tempHigh;      // °C
-  int tempLow;       // °C
-  int humidity;      // %
-  int precipChance;  // %
-  int windKph;       // km/h
-  char windDir[4];
-  int uvIndex;
-} WeatherData;
-
+// Calendar rows as published by the fetch task
 typedef struct {
-  char name[18];
-  int moisture_pct;  // 0..100
-} PlantItem;
+  int n;
+  CalItem items[6];
+  CalNetStats net;
+} CalSnapshot;
 
 // ---------- Globals ----------
 static UBYTE* FBFull = NULL;               // full-screen framebuffer (1-bit)
 UBYTE* FBPart = NULL;                      // remove static so Clock.cpp can extern it
 static ICalendarProvider* gCal = nullptr;  // calendar provider
+static IWeatherProvider* gWeather = nullptr;  // weather provider (fetch task once it runs)
+
+// Last pushed content per partial region
+static DirtyRegion gDirtyWeather;
+static DirtyRegion gDirtyCalendar;
+static DirtyRegion gDirtyPlants;
+
+// Fetch task → render loop handoff (gCal is only touched by the task once it runs)
+static SnapshotChannel<CalSnapshot> gCalFeed;
+static BackgroundTask gCalTask;
+static CalSnapshot gCalShown;  // rows currently on the panel (render side only)
+static SnapshotChannel<WeatherData> gWeatherFeed;
+static WeatherData gWeatherShown;  // weather currently on the panel (render side only)
+static bool gWeatherShownValid = false;  // gWeatherShown came from a fetch, not the placeholder
 
 // --- Helpers to size framebuffers safely ---
 static inline UWORD bytesForMono1bpp(UWORD w, UWORD h) {
@@ -142,303 +136,468 @@ static inline UWORD bytesForMono1bpp(UWORD w, UWORD h) {
   return rowBytes * h;
 }
 
-// ---------- Sensor mock (replace with real sensors/APIs) ----------
-static void readWeather(WeatherData* w) {
-  w->icon = WeatherIcon_Partly;
-  snprintf(w->condition, sizeof(w->condition), "Partly Cloudy");
-  w->tempNow = 19;
-  w->feelsLike = 18;
-  w->tempHigh = 22;
-  w->tempLow = 11;
-  w->humidity = 58;
-  w->precipChance = 35;
-  w->windKph = 18;
-  snprintf(w->windDir, sizeof(w->windDir), "SW");
-  w->uvIndex = 5;
+static void allocFullBuffer() {
+  const UWORD fullSize = bytesForMono1bpp(W, H);
+  FBFull = (UBYTE*)malloc(fullSize);
+  if (!FBFull) {
+    printf("OOM full (%u bytes)\r\n", fullSize);
+    while (1)
+      ;
+  }
 }
 
-static void readPlants(PlantItem* p, int n) {
-  const char* names[5] = { "Monstera", "Basil", "Ficus", "Fern", "Aloe" };
-  int vals[5] = { 34, 52, 63, 28, 58 };
-  for (int i = 0; i < n; i++) {
-    snprintf(p[i].name, sizeof(p[i].name), "%s", names[i]);
-    p[i].moisture_pct = vals[i];
+// Partial framebuffer pool, each buffer sized for the LARGEST partial region.
+// FBPart is the one currently rendered into; presentPart() swaps it for a free one.
+static void allocPartBuffer() {
+  const UWORD partSizeClk = bytesForMono1bpp(PRT_CLK_W, PRT_CLK_H);  // 260 x ~28
+  const UWORD partSizeWeather = bytesForMono1bpp(PRT_WTH_W, PRT_WTH_H);  // 348 x 224
+  const UWORD partSizeCal = bytesForMono1bpp(PRT_CAL_W, PRT_CAL_H);  // 400 x 224
+  const UWORD partSizePlt = bytesForMono1bpp(PRT_PLT_W, PRT_PLT_H);  // 772 x 114
+
+  UWORD partSize = partSizeClk;
+  if (partSizeWeather > partSize) partSize = partSizeWeather;
+  if (partSizeCal > partSize) partSize = partSizeCal;  // <-- largest for current layout
+  if (partSizePlt > partSize) partSize = partSizePlt;
+
+  if (!epdPushBegin(partSize)) {
+    printf("OOM part (%u bytes)\r\n", partSize);
+    while (1)
+      ;
   }
+  FBPart = epdPushAcquire();
 }
 
-// ---------- Weather icon helpers ----------
-static void drawSunIcon(int x, int y, int size) {
-  int cx = x + size / 2;
-  int cy = y + size / 2;
-  int r = size / 3;
-  int ray = r + size / 6;
-
-  Paint_DrawCircle(cx, cy, r, BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-
-  // cardinal rays (thin rectangles)
-  Paint_DrawRectangle(cx - 1, cy - ray, cx + 1, cy - r - 2, BLACK, DOT_PIXEL_1X1,
-                      DRAW_FILL_FULL);
-  Paint_DrawRectangle(cx - 1, cy + r + 2, cx + 1, cy + ray, BLACK, DOT_PIXEL_1X1,
-                      DRAW_FILL_FULL);
-  Paint_DrawRectangle(cx - ray, cy - 1, cx - r - 2, cy + 1, BLACK, DOT_PIXEL_1X1,
-                      DRAW_FILL_FULL);
-  Paint_DrawRectangle(cx + r + 2, cy - 1, cx + ray, cy + 1, BLACK, DOT_PIXEL_1X1,
-                      DRAW_FILL_FULL);
-
-  // diagonal rays (small squares)
-  int diag = (ray * 7) / 10;
-  Paint_DrawRectangle(cx - diag, cy - diag, cx - diag + 2, cy - diag + 2, BLACK,
-                      DOT_PIXEL_1X1, DRAW_FILL_FULL);
-  Paint_DrawRectangle(cx + diag - 2, cy - diag, cx + diag, cy - diag + 2, BLACK,
-                      DOT_PIXEL_1X1, DRAW_FILL_FULL);
-  Paint_DrawRectangle(cx - diag, cy + diag - 2, cx - diag + 2, cy + diag, BLACK,
-                      DOT_PIXEL_1X1, DRAW_FILL_FULL);
-  Paint_DrawRectangle(cx + diag - 2, cy + diag - 2, cx + diag, cy + diag, BLACK,
-                      DOT_PIXEL_1X1, DRAW_FILL_FULL);
+// One ICS provider per feed; extra feeds (SECRET_CAL_URL_2/_3) are merged by a composite.
+// SECRET_FEED_URL puts the binary feed provider in front, with the ICS side as fallback.
+static ICalendarProvider* makeCalendar() {
+  const bool insecure = SECRET_INSECURE_TLS ? true : false;
+  static const char* urls[] = {
+    CAL_URL,
+#ifdef SECRET_CAL_URL_2
+    SECRET_CAL_URL_2,
+#endif
+#ifdef SECRET_CAL_URL_3
+    SECRET_CAL_URL_3,
+#endif
+  };
+  const int n = sizeof(urls) / sizeof(urls[0]);
+  static ICalendarProvider* sources[n];
+  for (int i = 0; i < n; i++) {
+    sources[i] = makeIcsCalendarProvider(insecure);
+    sources[i]->setUrl(urls[i]);
+  }
+  ICalendarProvider* cal = sources[0];
+  if (n > 1) {
+#ifdef SECRET_CAL_TAGS
+    static const char* tags[] = SECRET_CAL_TAGS;
+#else
+    static const char* const* tags = nullptr;
+#endif
+    cal = makeCompositeCalendarProvider(sources, tags, n);
+  }
+#ifdef SECRET_FEED_URL
+  // Pre-digested binary feed first; the ICS feeds answer whenever it is unavailable
+  cal = makeFeedCalendarProvider(cal, insecure);
+  cal->setUrl(SECRET_FEED_URL);
+#endif
+  return cal;
 }
 
-static void drawCloudIcon(int x, int y, int size) {
-  int baseY = y + size / 2 + 6;
-  int rSmall = size / 5;
-  int rMed = rSmall + 4;
-  int rLarge = rMed + 4;
-  int left = x + 8;
-
-  Paint_DrawCircle(left, baseY, rMed, BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-  Paint_DrawCircle(left + rMed + rSmall, baseY - rSmall, rLarge, BLACK,
-                   DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-  Paint_DrawCircle(left + rMed + rSmall + rLarge, baseY, rMed, BLACK,
-                   DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-  Paint_DrawRectangle(left - rSmall, baseY, left + rMed + rSmall + rLarge + rMed,
-                      baseY + rSmall, BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+// Takes a WifiLink reference: the caller releases it once its network work is done
+static bool connectWiFi(unsigned long timeoutMs) {
+  gWifi.begin(WIFI_SSID, WIFI_PASS, gConfig.wifiStaticIp, gConfig.wifiOffWhenIdle);
+  return gWifi.acquire(timeoutMs);
 }
 
-static void drawWeatherConditionIcon(int x, int y, int size, WeatherIcon icon) {
-  switch (icon) {
-    case WeatherIcon_Sun:
-      drawSunIcon(x, y, size);
-      break;
-    case WeatherIcon_Partly:
-      drawSunIcon(x + size / 5, y, size * 3 / 4);
-      drawCloudIcon(x, y + size / 4, size);
-      break;
-    case WeatherIcon_Rain:
-      drawCloudIcon(x, y + size / 5, size);
-      for (int i = 0; i < 3; i++) {
-        int dropX = x + 16 + i * 12;
-        int top = y + size - 28;
-        Paint_DrawRectangle(dropX, top, dropX + 2, top + 10, BLACK,
-                            DOT_PIXEL_1X1, DRAW_FILL_FULL);
-      }
-      break;
-    case WeatherIcon_Storm:
-      drawCloudIcon(x, y + size / 5, size);
-      Paint_DrawLine(x + size / 2, y + size - 26, x + size / 2 - 10,
-                     y + size - 10, BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
-      Paint_DrawLine(x + size / 2 - 10, y + size - 10, x + size / 2 + 2,
-                     y + size - 10, BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
-      Paint_DrawLine(x + size / 2 + 2, y + size - 10, x + size / 2 - 8,
-                     y + size, BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
-      break;
-  }
+// ---------- Weather ----------
+static IWeatherProvider* makeWeather() {
+  IWeatherProvider* w = makeOpenMeteoWeatherProvider(SECRET_INSECURE_TLS ? true : false);
+  w->setLocation(gConfig.weatherLat, gConfig.weatherLon);
+  w->begin();
+  return w;
 }
 
-static void drawThermometerSymbol(int x, int y) {
-  int bulbR = 6;
-  int stemTop = y;
-  int stemBottom = y + 16;
-  int cx = x + bulbR;
-
-  Paint_DrawRectangle(cx - 2, stemTop, cx + 2, stemBottom, BLACK, DOT_PIXEL_1X1,
-                      DRAW_FILL_EMPTY);
-  Paint_DrawCircle(cx, stemBottom + bulbR, bulbR, BLACK, DOT_PIXEL_1X1,
-                   DRAW_FILL_EMPTY);
-  Paint_DrawRectangle(cx - 4, stemBottom - 4, cx + 4, stemBottom, BLACK,
-                      DOT_PIXEL_1X1, DRAW_FILL_FULL);
+// Shown until the first forecast arrives
+static void weatherPlaceholder(WeatherData* w) {
+  *w = WeatherData();
+  w->icon = WeatherIcon_Partly;
+  snprintf(w->condition, sizeof(w->condition), "No data");
+  snprintf(w->windDir, sizeof(w->windDir), "--");
 }
 
-static void drawWindSymbol(int x, int y) {
-  for (int i = 0; i < 3; i++) {
-    int yLine = y + 4 + i * 6;
-    Paint_DrawLine(x, yLine, x + 16, yLine, BLACK, DOT_PIXEL_1X1,
-                   LINE_STYLE_SOLID);
-    Paint_DrawLine(x + 16, yLine, x + 20, yLine - 2, BLACK, DOT_PIXEL_1X1,
-                   LINE_STYLE_SOLID);
-  }
+// ---------- Plants ----------
+// Capacitive probes on ADC1 pins (continuous mode cannot use ADC2); calibrate dry/wet per probe
+static const PlantChannel kPlantChannels[] = {
+  { "Monstera", 36, 2600, 1100 },
+  { "Basil",    39, 2600, 1100 },
+  { "Ficus",    34, 2600, 1100 },
+  { "Fern",     35, 2600, 1100 },
+  { "Aloe",     32, 2600, 1100 },
+};
+static const int kPlantCount = sizeof(kPlantChannels) / sizeof(kPlantChannels[0]);
+static PlantSensors gPlants;
+
+// Latest filtered snapshot; sampling runs on its own task
+static void readPlants(PlantItem* p, int n) {
+  gPlants.read(p, n);
 }
 
-static void drawHumiditySymbol(int x, int y) {
-  int cx = x + 8;
-  Paint_DrawLine(cx, y, cx - 6, y + 10, BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
-  Paint_DrawLine(cx, y, cx + 6, y + 10, BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
-  Paint_DrawCircle(cx, y + 16, 6, BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+// ---------- UI drawing ----------
+// What each region shows is drawn by PanelRender; here: dirty checks, timing, pushes
+// Copy the rendered FBPart into the master frame, then push it as a partial
+// (composing: the caller pushes the whole master frame afterwards).
+// The region's render time runs from renderStartUs up to the push.
+static void presentPart(int x, int y, int w, int h, Phase render, uint32_t renderStartUs) {
+  masterFrameBlit(FBPart, x, y, w, h);
+  metricsRecord(render, (uint32_t)micros() - renderStartUs);
+  if (masterFrameComposeOnly()) return;
+  epdPushSubmit(FBPart, x, y, x + w, y + h);  // uploads while the next region renders
+  FBPart = epdPushAcquire();
 }
 
-static void drawPrecipSymbol(int x, int y) {
-  int top = y + 6;
-  Paint_DrawLine(x + 2, top, x + 20, top, BLACK, DOT_PIXEL_1X1,
-                 LINE_STYLE_SOLID);
-  Paint_DrawLine(x + 2, top, x + 6, top - 6, BLACK, DOT_PIXEL_1X1,
-                 LINE_STYLE_SOLID);
-  Paint_DrawLine(x + 16, top - 6, x + 20, top, BLACK, DOT_PIXEL_1X1,
-                 LINE_STYLE_SOLID);
-  Paint_DrawLine(x + 11, top, x + 11, top + 14, BLACK, DOT_PIXEL_1X1,
-                 LINE_STYLE_SOLID);
-  Paint_DrawLine(x + 8, top + 4, x + 8, top + 10, BLACK, DOT_PIXEL_1X1,
-                 LINE_STYLE_SOLID);
-  Paint_DrawLine(x + 14, top + 4, x + 14, top + 10, BLACK, DOT_PIXEL_1X1,
-                 LINE_STYLE_SOLID);
+// Weather block (partial)
+static void updateWeatherPart(const WeatherData* w) {
+  ContentHash hw;
+  hw.add((int)w->icon).add(w->condition).add(w->tempNow).add(w->feelsLike)
+    .add(w->tempHigh).add(w->tempLow).add(w->humidity).add(w->precipChance)
+    .add(w->windKph).add(w->windDir).add(w->uvIndex);
+  if (!gDirtyWeather.needsPush(hw.value())) return;
+  const uint32_t t0 = (uint32_t)micros();
+  renderWeather(FBPart, w);
+  presentPart(PRT_WTH_X, PRT_WTH_Y, PRT_WTH_W, PRT_WTH_H, Phase::RenderWeather, t0);
 }
 
-static void drawUvSymbol(int x, int y) {
-  drawSunIcon(x, y, 22);
-  Paint_DrawString_EN(x + 4, y + 24, (char*)"UV", &Font16, WHITE, BLACK);
+// Calendar (partial) — fed by ICalendarProvider
+static void updateCalendarPart(const CalItem* items, int n) {
+  ContentHash hc;
+  hc.add(n);
+  for (int i = 0; i < n && i < 6; i++) hc.add(items[i].time).add(items[i].title);
+  if (!gDirtyCalendar.needsPush(hc.value())) return;
+  const uint32_t t0 = (uint32_t)micros();
+  renderCalendar(FBPart, items, n);
+  presentPart(PRT_CAL_X, PRT_CAL_Y, PRT_CAL_W, PRT_CAL_H, Phase::RenderCalendar, t0);
 }
 
-// ---------- UI drawing ----------
-static void drawSectionTitle(int x, int y, const char* txt) {
-  Paint_DrawString_EN(x, y, (char*)txt, &Font20, WHITE, BLACK);
+// Plants (partial)
+static void updatePlantsPart(const PlantItem* p, int n) {
+  ContentHash hp;
+  hp.add(n);
+  for (int i = 0; i < n && i < 5; i++) hp.add(p[i].name).add(p[i].moisture_pct).add((int)p[i].needsWater);
+  if (!gDirtyPlants.needsPush(hp.value())) return;
+  const uint32_t t0 = (uint32_t)micros();
+  renderPlants(FBPart, p, n);
+  presentPart(PRT_PLT_X, PRT_PLT_Y, PRT_PLT_W, PRT_PLT_H, Phase::RenderPlants, t0);
 }
 
-static void drawStaticUI(void) {
-  Paint_SelectImage(FBFull);
-  Paint_Clear(WHITE);
-
-  // Header bar
-  Paint_DrawRectangle(HDR_X, HDR_Y, HDR_X + HDR_W - 1, HDR_Y + HDR_H - 1,
-                      BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-  Paint_DrawString_EN(HDR_X + 10, HDR_Y + 12, (char*)"Niklas Dathe", &Font20, WHITE, BLACK);
-  // Clock box outline
-  Paint_DrawRectangle(PRT_CLK_X - 6, PRT_CLK_Y - 4, PRT_CLK_X + PRT_CLK_W + 6, PRT_CLK_Y + PRT_CLK_H + 4,
-                      BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-
-  // Left column
-  Paint_DrawRectangle(COL_L_X, COL_L_Y, COL_L_X + COL_L_W, COL_L_Y + COL_L_H,
-                      BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-  drawSectionTitle(COL_L_X + 10, COL_L_Y + 4, "TODAY'S WEATHER");
-
-  // Right column
-  Paint_DrawRectangle(COL_R_X, COL_R_Y, COL_R_X + COL_R_W, COL_R_Y + COL_R_H,
-                      BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-  drawSectionTitle(COL_R_X + 10, COL_R_Y + 4, "GOOGLE CALENDAR");
-
-  // Bottom
-  Paint_DrawRectangle(BOT_X, BOT_Y, BOT_X + BOT_W, BOT_Y + BOT_H,
-                      BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
-  drawSectionTitle(BOT_X + 10, BOT_Y + 4, "PLANT STATUS");
-
-  // Push static frame
-  EPD_7IN5_V2_Display(FBFull);
+// Static chrome plus every region rendered into FBFull, pushed as one full refresh.
+// Regions are forced to render; the panel is left in partial mode.
+static void composeAndShowFull(IClockWidget* clk, const WeatherData* w, const CalItem* cal, int ncal,
+                               const PlantItem* plants, int nplants) {
+  renderStaticUI(FBFull);
+  gDirtyWeather.invalidate();
+  gDirtyCalendar.invalidate();
+  gDirtyPlants.invalidate();
+  masterFrameSetComposeOnly(true);
+  clk->begin();
+  updateWeatherPart(w);
+  updateCalendarPart(cal, ncal);
+  updatePlantsPart(plants, nplants);
+  masterFrameSetComposeOnly(false);
+
+  epdPushFlush();
+  gfx()->panelInit(PanelMode::Full);
+  {
+    PhaseTimer timer(Phase::EpdFull);
+    gfx()->panelShow(FBFull);
+  }
+  ghostFullDone(millis() / 1000);
+  gfx()->panelInit(PanelMode::Partial);
 }
 
+// ---------- Panels (scheduled regions) ----------
+// Shows whatever the fetch task published last; never touches the network
+class WeatherPanel : public IPanel {
+public:
+  void begin() override { gDirtyWeather.invalidate(); updateWeatherPart(&gWeatherShown); }
+  void tick() override {
+    if (!gWeatherFeed.consume()) return;
+    gWeatherShown = gWeatherFeed.front();
+    gWeatherShownValid = true;
+    updateWeatherPart(&gWeatherShown);
+  }
+  RegionStats stats() const override { return gDirtyWeather.stats(); }
+};
 
-// Weather block (partial)
-static void updateWeatherPart(const WeatherData* w) {
-  Paint_SelectImage(FBPart);
-  Paint_NewImage(FBPart, PRT_WTH_W, PRT_WTH_H, 0, WHITE);
-  Paint_Clear(WHITE);
-
-  const int iconSize = 64;
-  drawWeatherConditionIcon(4, 4, iconSize, w->icon);
+class PlantsPanel : public IPanel {
+public:
+  void begin() override { gDirtyPlants.invalidate(); tick(); }
+  void tick() override {
+    PlantItem plants[5];
+    readPlants(plants, 5);
+    updatePlantsPart(plants, 5);
+  }
+  RegionStats stats() const override { return gDirtyPlants.stats(); }
+};
+
+// Shows whatever the fetch task published last
+class CalendarPanel : public IPanel {
+public:
+  void begin() override { gDirtyCalendar.invalidate(); updateCalendarPart(gCalShown.items, gCalShown.n); }
+  void tick() override {
+    if (!gCalFeed.consume()) return;
+    gCalShown = gCalFeed.front();
+    const CalNetStats& ns = gCalShown.net;
+    DBG("[CAL] ui count=%d (tls handshakes=%u reuses=%u 304=%u)\n", gCalShown.n,
+        (unsigned)ns.handshakes, (unsigned)ns.reuses, (unsigned)ns.notModified);
+    updateCalendarPart(gCalShown.items, gCalShown.n);
+  }
+  RegionStats stats() const override { return gDirtyCalendar.stats(); }
+};
+
+static WeatherPanel gWeatherPanel;
+static PlantsPanel gPlantsPanel;
+static CalendarPanel gCalendarPanel;
+static IClockWidget* gClock = nullptr;
+static Scheduler gSched;
+static bool gEpdPartial = false;  // controller is in partial-refresh mode
+
+// Regions due together share one partial session: enter partial mode once per batch
+static void epdBatchBegin() {
+  if (!gEpdPartial) {
+    epdPushFlush();
+    gfx()->panelInit(PanelMode::Partial);
+    gEpdPartial = true;
+  }
+}
 
-  char buf[64];
-  int textX = iconSize + 16;
+// Everything the batch uploaded goes out in one panel refresh
+static void epdBatchEnd(int regions) {
+  (void)regions;
+  epdPushRefresh();
+}
 
-  Paint_DrawString_EN(textX, 6, (char*)w->condition, &Font20, WHITE, BLACK);
-  snprintf(buf, sizeof(buf), "Now %d%cC", w->tempNow, 0xB0);
-  Paint_DrawString_EN(textX, 34, buf, &Font16, WHITE, BLACK);
+// FBFull already holds the last render of every region: one push, no re-render or refetch
+static void fullRefresh() {
+  epdPushFlush();
+  gfx()->panelInit(PanelMode::Full);
+  {
+    PhaseTimer timer(Phase::EpdFull);
+    gfx()->panelShow(FBFull);
+  }
+  ghostFullDone(millis() / 1000);
+  gEpdPartial = false;  // the next batch re-enters partial mode
+}
 
-  snprintf(buf, sizeof(buf), "Feels like %d%cC", w->feelsLike, 0xB0);
-  Paint_DrawString_EN(textX, 52, buf, &Font16, WHITE, BLACK);
+// Inverse, then normal image of one region from FBFull (partial mode): every pixel of the
+// box goes through a full transition, which clears what the partial refreshes left behind
+static void cleanRegion(const GhostRegion& r) {
+  const int rowBytes = (r.w + 7) / 8, frameRow = (W + 7) / 8, bx = r.x / 8;
+  for (int pass = 0; pass < 2; ++pass) {
+    UBYTE* out = epdPushAcquire();
+    for (int y = 0; y < r.h; ++y) {
+      const UBYTE* src = FBFull + (size_t)(r.y + y) * frameRow + bx;
+      UBYTE* dst = out + (size_t)y * rowBytes;
+      for (int i = 0; i < rowBytes; ++i) dst[i] = pass ? src[i] : (UBYTE)~src[i];
+    }
+    epdPushSubmit(out, r.x, r.y, r.x + r.w, r.y + r.h);
+    epdPushRefresh();
+  }
+}
 
-  int rowY = 84;
-  const int rowStep = 32;
-  const int metricTextX = 48;
+// Pays for cleanups only when the counts call for one; a full refresh waits for a window
+// that the clock tick will not interrupt
+static void ghostJob(void*) {
+  int region = -1;
+  const GhostAction a = ghostNext(millis() / 1000, &region);
+  if (a == GhostAction::CleanRegion) {
+    const GhostRegion& r = ghostRegion(region);
+    DBG("[EPD] cleanup %s after %u partials\n", r.name, (unsigned)r.partials);
+    cleanRegion(r);
+    ghostCleaned(region);
+  } else if (a == GhostAction::Full) {
+    time_t now;
+    time(&now);
+    if (60 - now % 60 < GHOST_QUIET_S) return;  // checked again in GHOST_CHECK_MS
+    fullRefresh();
+  }
+}
 
-  drawThermometerSymbol(8, rowY - 18);
-  snprintf(buf, sizeof(buf), "Temperature  High %d%c / Low %d%c", w->tempHigh, 0xB0, w->tempLow, 0xB0);
-  Paint_DrawString_EN(metricTextX, rowY, buf, &Font16, WHITE, BLACK);
+// What is on the panel now is what the next boot shows first; stats ride along
+static void persistJob(void*) {
+  BootState st = BootState();
+  st.clock = gClock->saveState();
+  st.weather = gDirtyWeather;
+  st.calendar = gDirtyCalendar;
+  st.plants = gDirtyPlants;
+  st.hasWeather = gWeatherShownValid;
+  st.weatherData = gWeatherShown;
+  snapshotSaveFrame(FBFull, bytesForMono1bpp(W, H), st);
+  timeKeeperSave();
+  RegionStats sw = gWeatherPanel.stats(), sc = gCalendarPanel.stats(), sp = gPlantsPanel.stats();
+  RegionStats sk = gClock->stats();
+  DBG("[EPD] push/skip clock=%u/%u weather=%u/%u calendar=%u/%u plants=%u/%u\n",
+      (unsigned)sk.pushes, (unsigned)sk.skips, (unsigned)sw.pushes, (unsigned)sw.skips,
+      (unsigned)sc.pushes, (unsigned)sc.skips, (unsigned)sp.pushes, (unsigned)sp.skips);
+  ghostDump();
+  const WifiLinkStats& ws = gWifi.stats();
+  DBG("[WiFi] connects fast=%u full=%u failed=%u, last=%u ms best=%u ms worst=%u ms\n",
+      (unsigned)ws.fast, (unsigned)ws.full, (unsigned)ws.failures, (unsigned)ws.lastMs,
+      (unsigned)ws.bestMs, (unsigned)ws.worstMs);
+  gSched.dumpStats();
+  metricsDump();
+}
 
-  rowY += rowStep;
-  drawWindSymbol(8, rowY - 16);
-  snprintf(buf, sizeof(buf), "Wind  %d km/h %s", w->windKph, w->windDir);
-  Paint_DrawString_EN(metricTextX, rowY, buf, &Font16, WHITE, BLACK);
+// Serial 'm' dump and the optional /metrics endpoint
+static void metricsJob(void*) {
+  metricsPoll();
+}
 
-  rowY += rowStep;
-  drawHumiditySymbol(8, rowY - 18);
-  snprintf(buf, sizeof(buf), "Humidity  %d%%", w->humidity);
-  Paint_DrawString_EN(metricTextX, rowY, buf, &Font16, WHITE, BLACK);
+// ---------- Background jobs ----------
+// Rows into the channel's back buffer and out; the cache is persisted now and then
+static void publishCalendar(CalSnapshot& s, int n, time_t now) {
+  s.n = (n > 0) ? n : 0;
+  s.net = gCal->netStats();
+  gCalFeed.publish();
 
-  rowY += rowStep;
-  drawPrecipSymbol(6, rowY - 18);
-  snprintf(buf, sizeof(buf), "Precipitation  %d%% chance", w->precipChance);
-  Paint_DrawString_EN(metricTextX, rowY, buf, &Font16, WHITE, BLACK);
+  static time_t lastSave = 0;
+  if (n >= 0 && now - lastSave >= SNAPSHOT_CAL_S && snapshotSaveCalendar(gCal)) lastSave = now;
+}
 
-  rowY += rowStep;
-  drawUvSymbol(4, rowY - 24);
-  snprintf(buf, sizeof(buf), "UV Index  %d", w->uvIndex);
-  Paint_DrawString_EN(metricTextX, rowY, buf, &Font16, WHITE, BLACK);
+// Something on this run will go to the network: weather past its expiry, or a calendar refresh
+static bool fetchDue(time_t now) {
+  const bool weather = gWeather && now >= gWeather->expiresAt();
+  const bool cal = gCal && now >= 1700000000L && gCal->refreshDue();
+  return weather || cal;
+}
 
-  EPD_7IN5_V2_Display_Part(FBPart, PRT_WTH_X, PRT_WTH_Y, PRT_WTH_X + PRT_WTH_W,
-                           PRT_WTH_Y + PRT_WTH_H);
+// Runs on the fetch task: query, then publish the rows into the channel's back buffer.
+// Weather rides along: its provider only goes to the network once its cached response expired.
+// The radio is only woken when some provider is due; otherwise both answer from their caches.
+static void calendarJob(void*) {
+  time_t now;
+  time(&now);
+  WifiLease link(gWifi, FETCH_WIFI_TIMEOUT_MS, fetchDue(now));  // caches answer when it fails
+  if (gWeather && gWeather->read(&gWeatherFeed.writeBuffer())) gWeatherFeed.publish();
+
+  if (!gCal || now < 1700000000L) return;  // no NTP time yet
+  CalSnapshot& s = gCalFeed.writeBuffer();
+  publishCalendar(s, gCal->readToday(s.items, 6), now);
 }
 
-// Calendar (partial) — fed by ICalendarProvider
-static void updateCalendarPart(const CalItem* items, int n) {
-  Paint_SelectImage(FBPart);
-  Paint_NewImage(FBPart, PRT_CAL_W, PRT_CAL_H, 0, WHITE);
-  Paint_Clear(WHITE);
-
-  int y = 0;
-  const int rowH = 26;
-
-  // optional thin separator before title block (visual cue)
-  // Paint_DrawLine(CAL_TITLE_X - 8, 0, CAL_TITLE_X - 8, PRT_CAL_H - 1, BLACK, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
-
-  for (int i = 0; i < n && i < 6; i++) {
-    // time (e.g., "20:00 - 21:00")
-    Paint_DrawString_EN(CAL_TIME_X, y, (char*)items[i].time, &Font16, WHITE, BLACK);
-    // title pushed further right so it never overlaps time
-    Paint_DrawString_EN(CAL_TITLE_X, y, (char*)items[i].title, &Font16, WHITE, BLACK);
-    y += rowH;
-  }
-  if (n == 0) {
-    Paint_DrawString_EN(CAL_TIME_X, 0, (char*)"No events", &Font16, WHITE, BLACK);
+#if CAL_TIME_SLICED
+// Single core: no second core to hide the fetch on, so it runs on the loop in slices of
+// CAL_SLICE_MS between the clock and panel jobs. Between slices the loop sleeps in the
+// scheduler, which keeps the idle task (and its watchdog) fed. Requests are not sliced.
+static void calendarSliceJob(void*) {
+  static bool busy = false;  // refresh in progress
+  static bool linked = false;  // ... and holds the link
+  static uint32_t nextMs = 0;
+  time_t now;
+  time(&now);
+  if (!busy) {
+    if ((int32_t)(millis() - nextMs) < 0) return;
+    nextMs = millis() + CAL_PERIOD_MS;
+    if (!gCal || now < 1700000000L) return;  // no NTP time yet
+    linked = fetchDue(now);
+    if (linked) gWifi.acquire(FETCH_WIFI_TIMEOUT_MS);
+    if (gWeather && gWeather->read(&gWeatherFeed.writeBuffer())) gWeatherFeed.publish();
+    busy = true;
   }
+  const CalRefresh r = gCal->refreshStep(CAL_SLICE_MS);
+  if (r == CalRefresh::Running) return;
+  busy = false;
+  if (linked) gWifi.release();
+  linked = false;
+
+  CalSnapshot& s = gCalFeed.writeBuffer();
+  const int n = gCal->readRange(tzDayStartUTC(now), tzDayStartUTC(now, 1), s.items, 6);
+  publishCalendar(s, n, now);
+}
+#endif
 
-  EPD_7IN5_V2_Display_Part(FBPart, PRT_CAL_X, PRT_CAL_Y, PRT_CAL_X + PRT_CAL_W, PRT_CAL_Y + PRT_CAL_H);
+// ---------- Deep sleep ----------
+static void saveCalendarRows(const CalItem* items, int n) {
+  if (n > kSleepCalRows) n = kSleepCalRows;
+  for (int i = 0; i < n; i++) gSleep.cal[i] = items[i];
+  gSleep.ncal = n;
 }
 
+static void enterDeepSleep(IClockWidget* clk) {
+  gSleep.clock = clk->saveState();
+  gSleep.weather = gDirtyWeather;
+  gSleep.calendar = gDirtyCalendar;
+  gSleep.plants = gDirtyPlants;
+  sleepCommit();
+
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  epdPushFlush();       // refresh what the cycle uploaded before the controller sleeps
+  gfx()->panelSleep();  // the panel keeps its image unpowered
+  sleepUntilNextMinute();
+}
 
-// Plants (partial)
-static void updatePlantsPart(const PlantItem* p, int n) {
-  Paint_SelectImage(FBPart);
-  Paint_NewImage(FBPart, PRT_PLT_W, PRT_PLT_H, 0, WHITE);
-  Paint_Clear(WHITE);
-
-  int y = 0;
-  for (int i = 0; i < n && i < 5; i++) {
-    int needs = (p[i].moisture_pct < 40);  // threshold
-    // Bullet: filled if needs water
-    if (needs) {
-      Paint_DrawCircle(6, y + 10, 6, BLACK, DOT_PIXEL_1X1, DRAW_FILL_FULL);
-    } else {
-      Paint_DrawCircle(6, y + 10, 6, BLACK, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+// One duty cycle after a timer wakeup: clock partial every minute, WiFi and the
+// other regions only when a refresh is due, full refresh on the usual cadence.
+static void runWakeCycle() {
+  gSleep.wakes++;
+  setenv("TZ", TZ_POSIX, 1);  // env is lost in deep sleep; the RTC kept the time
+  tzset();
+  time_t now;
+  time(&now);
+  const bool refreshDue = (now - gSleep.lastRefreshUTC) >= (time_t)gConfig.sleepRefreshMin * 60;
+  const bool fullDue = (now - gSleep.lastFullUTC) >= FULL_REFRESH_S;
+
+  DEV_Module_Init();
+  allocPartBuffer();
+  gDirtyWeather = gSleep.weather;
+  gDirtyCalendar = gSleep.calendar;
+  gDirtyPlants = gSleep.plants;
+
+  IClockWidget* clk = makeEpdClockWidget(PRT_CLK_X, PRT_CLK_Y, PRT_CLK_W, PRT_CLK_H, makeFormatterStatic());
+  clk->restoreState(gSleep.clock);
+
+  if (refreshDue) {
+    if (connectWiFi(SLEEP_WIFI_TIMEOUT_MS)) {
+      configTime(0, 0, "pool.ntp.org", "time.cloudflare.com");  // correct RTC drift while online
+      gCal = makeCalendar();
+      gCal->begin();
+      CalItem cal[kSleepCalRows];
+      int ncal = gCal->readToday(cal, kSleepCalRows);
+      if (ncal >= 0) saveCalendarRows(cal, ncal);
+      gWeather = makeWeather();
+      gSleep.hasWeather = gWeather->read(&gSleep.weatherData) || gSleep.hasWeather;
+      gSleep.refreshes++;
     }
-    Paint_DrawString_EN(20, y, (char*)p[i].name, &Font16, WHITE, BLACK);
+    gSleep.lastRefreshUTC = now;  // a failed cycle retries on the next cadence, not every minute
+  }
 
-    char buf[32];
-    snprintf(buf, sizeof(buf), "%d %%", p[i].moisture_pct);
-    int px = PRT_PLT_W - 60;  // right align %
-    Paint_DrawString_EN(px, y, buf, &Font16, WHITE, BLACK);
+  WeatherData weather;
+  PlantItem plants[5];
+  if (refreshDue || fullDue) {
+    gPlants.begin(kPlantChannels, kPlantCount);
+    gPlants.sampleBurst();
+    if (gSleep.hasWeather) weather = gSleep.weatherData;
+    else weatherPlaceholder(&weather);
+    readPlants(plants, 5);
+  }
 
-    if (needs) {
-      Paint_DrawString_EN(px + 44, y, (char*)"!", &Font16, WHITE, BLACK);
+  if (fullDue) {
+    // The master frame did not survive the sleep: compose it from scratch, one full pass
+    allocFullBuffer();
+    masterFrameAttach(FBFull, W, H);
+    composeAndShowFull(clk, &weather, gSleep.cal, gSleep.ncal, plants, 5);
+    gSleep.lastFullUTC = now;
+  } else {
+    gfx()->panelInit(PanelMode::Partial);
+    clk->tick();  // no push if we woke inside the minute already shown
+    if (refreshDue) {
+      updateWeatherPart(&weather);
+      updateCalendarPart(gSleep.cal, gSleep.ncal);
+      updatePlantsPart(plants, 5);
     }
-    y += 28;
   }
 
-  EPD_7IN5_V2_Display_Part(FBPart, PRT_PLT_X, PRT_PLT_Y, PRT_PLT_X + PRT_PLT_W, PRT_PLT_Y + PRT_PLT_H);
+  enterDeepSleep(clk);
 }
 
 // ---------- App ----------
@@ -446,172 +605,157 @@ void setup() {
   setvbuf(stdout, NULL, _IONBF, 0);  // unbuffered printf
   DBG("\r\n[BOOT] E-Paper dashboard starting...\r\n");
 
+  // --- Config (choose date locale here or in AppConfig.cpp) ---
+  gConfig.dateLocale = DateLocale::DE;  // DE for "Dienstag, 07.10.2025"
+  // gConfig.dateLocale = DateLocale::EN; // alternative
+  // gConfig.dateLocale = DateLocale::FR; // "Mardi 07/10/2025"
+  gConfig.use24h = true;
+  // gConfig.deepSleep = true;        // battery units: sleep between minute ticks
+
+  // Timer wakeup from deep sleep: panel and RTC state are intact, skip the cold boot
+  if (gConfig.deepSleep && sleepResumed()) runWakeCycle();  // does not return
+  gSleep = SleepState();
+
   Serial.begin(115200);
   delay(300);
 
   // EPD low-level init
   DEV_Module_Init();
 
-  // WiFi
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(WIFI_SSID, WIFI_PASS);
-  DBG("[WiFi] Connecting to %s ...\n", WIFI_SSID);
-  unsigned long t0 = millis();
-  while (WiFi.status() != WL_CONNECTED && millis() - t0 < 15000) {
-    delay(200);
-    DBG(".");
+  // === Allocate framebuffers (1-bit) ===
+  allocFullBuffer();
+  allocPartBuffer();
+  masterFrameAttach(FBFull, W, H);
+  ghostAddRegion("clock", PRT_CLK_X, PRT_CLK_Y, PRT_CLK_W, PRT_CLK_H);
+  ghostAddRegion("weather", PRT_WTH_X, PRT_WTH_Y, PRT_WTH_W, PRT_WTH_H);
+  ghostAddRegion("calendar", PRT_CAL_X, PRT_CAL_Y, PRT_CAL_W, PRT_CAL_H);
+  ghostAddRegion("plants", PRT_PLT_X, PRT_PLT_Y, PRT_PLT_W, PRT_PLT_H);
+
+  // Last saved frame straight back on the panel, before WiFi and NTP (no clear).
+  // Deep-sleep units keep their state in RTC memory and take the cold path.
+  BootState boot = BootState();
+  const bool warm = snapshotBegin() && !gConfig.deepSleep &&
+                    snapshotLoadFrame(FBFull, bytesForMono1bpp(W, H), &boot);
+  gfx()->panelInit(PanelMode::Full);
+  if (warm) {
+    PhaseTimer timer(Phase::EpdFull);
+    gfx()->panelShow(FBFull);
+    ghostFullDone(millis() / 1000);
+    DBG("[BOOT] snapshot frame shown\n");
+  } else {
+    gfx()->panelClear();
+    DEV_Delay_ms(200);
   }
-  DBG("\n[WiFi] Status=%d, IP=%s, RSSI=%d dBm\n",
-      WiFi.status(), WiFi.localIP().toString().c_str(), WiFi.RSSI());
+
+  // An RTC that ran through the reset is trusted (drift-corrected); NTP reconciles later
+  timeKeeperBegin();
+  timeKeeperRestore();
+
+  // WiFi
+  connectWiFi(WIFI_TIMEOUT_MS);
 
   // TZ + NTP (Europe/Berlin)
-  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  setenv("TZ", TZ_POSIX, 1);
   tzset();
   configTime(0, 0, "pool.ntp.org", "time.cloudflare.com");
 
-  // Robust time readiness loop
+  // Robust time readiness loop (falls through at once if the RTC kept the time)
   time_t now = 0;
-  for (int i = 0; i < 100; i++) {
-    time(&now);
-    if (now > 1700000000UL) break;
-    delay(100);
+  {
+    PhaseTimer timer(Phase::NtpSync);
+    for (int i = 0; i < 100; i++) {
+      time(&now);
+      if (now > 1700000000UL) break;
+      delay(100);
+    }
   }
   struct tm lt;
   localtime_r(&now, &lt);
   DBG("[Time] now=%ld  %04d-%02d-%02d %02d:%02d:%02d (local)\n",
       (long)now, lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday, lt.tm_hour, lt.tm_min, lt.tm_sec);
 
-  // EPD init + clear
-  EPD_7IN5_V2_Init();
-  EPD_7IN5_V2_Clear();
-  DEV_Delay_ms(200);
-
-  // === Allocate full framebuffer (1-bit) ===
-  const UWORD fullSize = bytesForMono1bpp(W, H);
-  FBFull = (UBYTE*)malloc(fullSize);
-  if (!FBFull) {
-    printf("OOM full (%u bytes)\r\n", fullSize);
-    while (1)
-      ;
-  }
-
-  // === Allocate partial framebuffer: pick the LARGEST partial region ===
-  const UWORD partSizeClk = bytesForMono1bpp(PRT_CLK_W, PRT_CLK_H);  // 260 x ~28
-  const UWORD partSizeWeather = bytesForMono1bpp(PRT_WTH_W, PRT_WTH_H);  // 348 x 224
-  const UWORD partSizeCal = bytesForMono1bpp(PRT_CAL_W, PRT_CAL_H);  // 400 x 224
-  const UWORD partSizePlt = bytesForMono1bpp(PRT_PLT_W, PRT_PLT_H);  // 772 x 114
-
-  UWORD partSize = partSizeClk;
-  if (partSizeWeather > partSize) partSize = partSizeWeather;
-  if (partSizeCal > partSize) partSize = partSizeCal;  // <-- largest for current layout
-  if (partSizePlt > partSize) partSize = partSizePlt;
-
-  FBPart = (UBYTE*)malloc(partSize);
-  if (!FBPart) {
-    printf("OOM part (%u bytes)\r\n", partSize);
-    while (1)
-      ;
-  }
-
-  // Prepare canvas + draw static chrome
-  Paint_SelectImage(FBFull);
-  Paint_NewImage(FBFull, W, H, 0, WHITE);
-  Paint_Clear(WHITE);
-  drawStaticUI();
-
-  // Switch to partial mode for dynamic areas
-  EPD_7IN5_V2_Init_Part();
-
-  // --- Config (choose date locale here or in AppConfig.cpp) ---
-  gConfig.dateLocale = DateLocale::DE;  // DE for "Dienstag, 07.10.2025"
-  // gConfig.dateLocale = DateLocale::EN; // alternative
-  gConfig.use24h = true;
-
   // --- Clock widget ---
   IDateTimeFormatter* fmt = makeFormatterStatic();
   static IClockWidget* clockWidget =
     makeEpdClockWidget(PRT_CLK_X, PRT_CLK_Y, PRT_CLK_W, PRT_CLK_H, fmt);
-  clockWidget->begin();
 
-  // Calendar provider
-  gCal = makeIcsCalendarProvider(/*insecureTLS=*/(SECRET_INSECURE_TLS ? true : false));
-  gCal->setUrl(CAL_URL);
+  // Calendar provider; the saved cache answers until the fetch task reconciles
+  gCal = makeCalendar();
   gCal->begin();
+  snapshotLoadCalendar(gCal);
 
-  // Initial dynamic fills (clock already drew once)
-  WeatherData weather;
-  readWeather(&weather);
-  updateWeatherPart(&weather);
-
-  CalItem cal[6];
-  int ncal = 0;
-  if (now > 1700000000UL && gCal) {
-    ncal = gCal->readToday(cal, 6);
-    DBG("[CAL] ui count=%d\n", ncal);
-  }
-  updateCalendarPart(cal, (ncal > 0) ? ncal : 0);
+  // Weather provider
+  gWeather = makeWeather();
 
-  PlantItem plants[5];
-  readPlants(plants, 5);
-  updatePlantsPart(plants, 5);
-}
+  gPlants.begin(kPlantChannels, kPlantCount);
+  gPlants.sampleBurst();
 
-void loop() {
-  static int sensorTick = 0;
-  static int calTick = 0;
-  static int fullTick = 0;
-
-  // CLOCK: call often; it only updates when minute/day changed
-  extern IClockWidget* makeEpdClockWidget(int, int, int, int, IDateTimeFormatter*);
-  static IClockWidget* clk = nullptr;
-  if (!clk) {
-    IDateTimeFormatter* fmt = makeFormatterStatic();
-    clk = makeEpdClockWidget(PRT_CLK_X, PRT_CLK_Y, PRT_CLK_W, PRT_CLK_H, fmt);
-  }
-  clk->tick();
-  DEV_Delay_ms(1000);
-
-  // SENSORS: every 10s (partial)
-  if (++sensorTick >= 10) {
-    sensorTick = 0;
-    WeatherData weather;
-    readWeather(&weather);
-    updateWeatherPart(&weather);
-
-    PlantItem plants[5];
-    readPlants(plants, 5);
-    updatePlantsPart(plants, 5);
-  }
-
-  // CALENDAR: every 60s (partial)
-  if (++calTick >= 60) {
-    calTick = 0;
-    if (gCal) {
-      CalItem cal[6];
-      int ncal = gCal->readToday(cal, 6);
+  CalItem* cal = gCalShown.items;
+  int ncal = 0;
+  bool haveWeather = false;
+  if (warm) {
+    // The panel already shows the saved regions: restore what they pushed, so the first
+    // ticks repaint only what changed; weather and calendar follow from the fetch task
+    clockWidget->restoreState(boot.clock);
+    gDirtyWeather = boot.weather;
+    gDirtyCalendar = boot.calendar;
+    gDirtyPlants = boot.plants;
+    haveWeather = boot.hasWeather;
+    if (haveWeather) gWeatherShown = boot.weatherData;
+    else weatherPlaceholder(&gWeatherShown);
+    gfx()->panelInit(PanelMode::Partial);
+  } else {
+    // Initial dynamic content
+    haveWeather = gWeather->read(&gWeatherShown);
+    if (!haveWeather) weatherPlaceholder(&gWeatherShown);
+
+    if (now > 1700000000UL && gCal) {
+      ncal = gCal->readToday(cal, 6);
       DBG("[CAL] ui count=%d\n", ncal);
-      updateCalendarPart(cal, (ncal > 0) ? ncal : 0);
     }
-  }
+    gCalShown.n = (ncal > 0) ? ncal : 0;
 
-  // PERIODIC FULL REFRESH: every ~10 minutes
-  if (++fullTick >= 600) {
-    fullTick = 0;
-    EPD_7IN5_V2_Init();
-    EPD_7IN5_V2_Display(FBFull);
-    EPD_7IN5_V2_Init_Part();
-    // Repaint dynamic sections
-    if (clk) clk->begin();  // ensure clock region is clean after full refresh
-    WeatherData weather;
-    readWeather(&weather);
-    updateWeatherPart(&weather);
-    if (gCal) {
-      CalItem cal[6];
-      int ncal = gCal->readToday(cal, 6);
-      updateCalendarPart(cal, (ncal > 0) ? ncal : 0);
-    }
     PlantItem plants[5];
     readPlants(plants, 5);
-    updatePlantsPart(plants, 5);
+
+    // Chrome + all regions in one full refresh, then partial mode for dynamic areas
+    composeAndShowFull(clockWidget, &gWeatherShown, cal, gCalShown.n, plants, 5);
+  }
+  gWeatherShownValid = haveWeather;
+
+  if (gConfig.deepSleep) {
+    gSleep.lastRefreshUTC = now;
+    gSleep.lastFullUTC = now;
+    saveCalendarRows(cal, (ncal > 0) ? ncal : 0);
+    gSleep.weatherData = gWeatherShown;
+    gSleep.hasWeather = haveWeather;
+    enterDeepSleep(clockWidget);
   }
+
+  // From here on the providers belong to the fetch task, which wakes the link per run
+  gWifi.release();
+#if !CAL_TIME_SLICED
+  gCalTask.start("calFetch", calendarJob, nullptr, CAL_PERIOD_MS);
+#endif
+  gPlants.startTask();
+
+  // Region schedule
+  gClock = clockWidget;
+  gEpdPartial = true;  // composeAndShowFull() / the warm path left the panel in partial mode
+  gSched.setBatchHooks(epdBatchBegin, epdBatchEnd);
+  gSched.onWall("clock", 60, gClock);
+  gSched.every("weather", SENSOR_PERIOD_MS, &gWeatherPanel);
+  gSched.every("plants", SENSOR_PERIOD_MS, &gPlantsPanel);
+  gSched.every("calendar", CAL_POLL_MS, &gCalendarPanel);
+  gSched.every("ghost", GHOST_CHECK_MS, ghostJob, nullptr, /*display=*/true);
+  gSched.every("persist", SNAPSHOT_FRAME_S * 1000UL, persistJob, nullptr, /*display=*/false);
+  gSched.every("metrics", METRICS_POLL_MS, metricsJob, nullptr, /*display=*/false);
+#if CAL_TIME_SLICED
+  gSched.every("calSlice", CAL_SLICE_PERIOD_MS, calendarSliceJob, nullptr, /*display=*/false);
+#endif
+}
+
+void loop() {
+  // Runs whatever is due, then sleeps exactly until the earliest next deadline
+  gSched.runAndWait();
 }
@@ -8,5 +8,15 @@
 // ---- Calendar URL (treat like a password) ----
 #define SECRET_CAL_URL   "https://calendar.google.com/calendar/ical/REDACTED/basic.ics"
 
+// Optional: more calendars merged into the same list, and a short tag per calendar
+// shown in front of its titles ("" = no tag)
+// #define SECRET_CAL_URL_2 "https://calendar.google.com/calendar/ical/REDACTED/basic.ics"
+// #define SECRET_CAL_URL_3 "https://calendar.google.com/calendar/ical/REDACTED/basic.ics"
+// #define SECRET_CAL_TAGS  { "", "P", "R" }
+
+// Optional: pre-digested binary event feed (format in CalendarFeed.h) served by your own
+// endpoint; the ICS link(s) above stay as the fallback
+// #define SECRET_FEED_URL  "https://your-server/zeiger/events.bin"
+
 // Optional: set to 1 to allow insecure TLS (not recommended for production)
 #define SECRET_INSECURE_TLS 1
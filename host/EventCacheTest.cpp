@@ -0,0 +1,102 @@
+// EventCacheTest.cpp
+// Native check of EventCache's title pool at the compaction point
+// - Fresh slots: a pool filled with live titles, round after round on the same cache (a
+//   cleared slot keeps its previous title offset) and on a cache whose storage was poisoned
+//   before begin(), so a slot that is not yet counted would point anywhere in the pool
+// - Evictions: a full cache fed ever earlier events leaves dead titles behind; compaction
+//   must reclaim them and keep every live title intact
+// Exit code 0 when every check held; run by ctest.
+#include "EventCache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---- Tunables ----
+static const size_t kEvents      = 64;
+static const size_t kPoolBytes   = 1024;  // ~50 titles: the fresh rounds run the pool full
+static const size_t kEvictEvents = 8;     // their titles fit, the evicted ones must make room
+static const size_t kTitleBytes  = 19;    // "rN-event-NNN-title" + NUL
+static const int    kRounds      = 4;
+static const time_t kWinStart    = 1760000000;
+
+#ifdef __GLIBC__
+// Poison fresh heap blocks: an uncounted slot's title offset reads 0x0303, inside the pool
+// and in the middle of a title
+extern "C" void* __libc_malloc(size_t n);
+extern "C" void* malloc(size_t n) __THROW {
+  void* p = __libc_malloc(n);
+  if (p) memset(p, 0x03, n);
+  return p;
+}
+#endif
+
+static int gFails = 0;
+
+static void check(bool ok, const char* what, int round, size_t i) {
+  if (ok) return;
+  if (gFails++ < 10) fprintf(stderr, "round %d, event %zu: %s\n", round, i, what);
+}
+
+static void titleOf(char* out, size_t n, int round, size_t i) {
+  snprintf(out, n, "r%d-event-%03zu-title", round, i);
+}
+
+// Adds more titles than the pool holds: those that fit must read back exactly, the rest
+// degrade to "" (nothing is dead, so compaction frees nothing and keeps nothing extra)
+static void freshSlots(EventCache& c, int round) {
+  c.clear(kWinStart, kWinStart + 7 * 86400);
+  for (size_t i = 0; i < kEvents; ++i) {
+    char t[40];
+    titleOf(t, sizeof(t), round, i);
+    check(c.add(kWinStart + (time_t)i * 600, kWinStart + (time_t)i * 600 + 300, t, 0),
+          "not kept", round, i);
+  }
+  c.finalize();
+  size_t kept = 0;
+  for (size_t i = 0; i < c.count(); ++i) {
+    char t[40];
+    titleOf(t, sizeof(t), round, (size_t)(c.at(i).start - kWinStart) / 600);
+    const char* got = c.title(c.at(i));
+    check(!strcmp(got, t) || !*got, "title corrupted", round, i);
+    if (*got) kept++;
+  }
+  check(c.count() == kEvents, "event count", round, 0);
+  check(kept == (kPoolBytes - 1) / kTitleBytes, "pool space lost", round, 0);
+}
+
+// Every add evicts the latest event: titles only stay within the pool if compaction
+// reclaims the evicted ones
+static void evictions(EventCache& c) {
+  const int round = kRounds;
+  c.clear(kWinStart, kWinStart + 7 * 86400);
+  const size_t adds = kEvents * 4;
+  for (size_t k = 0; k < adds; ++k) {
+    const size_t i = adds - 1 - k;  // ever earlier starts
+    char t[40];
+    titleOf(t, sizeof(t), round, i);
+    c.add(kWinStart + (time_t)i * 600, kWinStart + (time_t)i * 600 + 300, t, 0);
+  }
+  c.finalize();
+  check(c.count() == kEvictEvents, "event count", round, 0);
+  // The kept events arrive last, after many evictions: each title is there only if
+  // compaction reclaimed the dead ones
+  for (size_t i = 0; i < c.count(); ++i) {
+    char t[40];
+    titleOf(t, sizeof(t), round, i);
+    check(c.at(i).start == kWinStart + (time_t)i * 600, "wrong event kept", round, i);
+    check(!strcmp(c.title(c.at(i)), t), "dead titles not reclaimed", round, i);
+  }
+}
+
+int main() {
+  EventCache c, small;
+  if (!c.begin(kEvents, kPoolBytes) || !small.begin(kEvictEvents, kPoolBytes)) {
+    fprintf(stderr, "begin failed\n");
+    return 1;
+  }
+  for (int r = 0; r < kRounds; ++r) freshSlots(c, r);
+  evictions(small);
+  printf("event cache: %d rounds of %zu events in a %zu-byte pool, evictions: %s\n",
+         kRounds, kEvents, kPoolBytes, gFails ? "FAIL" : "ok");
+  return gFails ? 1 : 0;
+}
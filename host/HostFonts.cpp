@@ -0,0 +1,41 @@
+// HostFonts.cpp
+// Glyph tables behind host/fonts.h: a hashed pattern per glyph inside a one-pixel margin,
+// space left blank, so proportional metrics (ink width, first column) vary per glyph
+#include "fonts.h"
+
+static const int kGlyphs = 0x7E - 0x20 + 1;
+
+template <int W, int H>
+struct Table {
+  static const int kRowBytes = (W + 7) / 8;
+  uint8_t bytes[kGlyphs * H * kRowBytes];
+
+  Table() {
+    for (int g = 0; g < kGlyphs; ++g) {
+      uint32_t h = 2166136261u ^ (uint32_t)(g + 0x20);
+      // Ink columns [lo, hi]: narrow glyphs for some characters, like a real pack
+      const int lo = 1 + (int)(g % 3 == 0), hi = W - 2 - (int)(g % 5 == 0);
+      for (int y = 0; y < H; ++y) {
+        uint8_t* row = bytes + (g * H + y) * kRowBytes;
+        for (int b = 0; b < kRowBytes; ++b) row[b] = 0;
+        if (g == 0 || y < 1 || y >= H - 2) continue;  // space, top and baseline margin
+        for (int x = lo; x <= hi; ++x) {
+          h = (h ^ (uint32_t)(y * 31 + x)) * 16777619u;
+          if ((h >> 13) % 5 < 2 || x == lo || y == 1) row[x >> 3] |= (uint8_t)(0x80 >> (x & 7));
+        }
+      }
+    }
+  }
+};
+
+static const Table<5, 8>   kT8;
+static const Table<7, 12>  kT12;
+static const Table<11, 16> kT16;
+static const Table<14, 20> kT20;
+static const Table<17, 24> kT24;
+
+sFONT Font8  = { kT8.bytes,  5,  8 };
+sFONT Font12 = { kT12.bytes, 7,  12 };
+sFONT Font16 = { kT16.bytes, 11, 16 };
+sFONT Font20 = { kT20.bytes, 14, 20 };
+sFONT Font24 = { kT24.bytes, 17, 24 };
@@ -0,0 +1,268 @@
+// IcsBench.cpp
+// Native benchmark of the ICS parse core (IcsParser + IcsRecurrence + EventCache + TimeZone)
+// - Generates 100 KB / 1 MB / 10 MB corpora: folded lines, VALARMs, TZID times,
+//   RRULE series with EXDATEs, all-day and UTC events, out of start order
+// - Parses each from memory (IcsMemorySource) in one pass and in 2 KB slices as on the
+//   device; both must agree, and the bytes/events seen must match what was generated
+// - Reports events/s, MB/s and the heap allocations made while parsing (there must be none
+//   once the cache is allocated: the parse working set lives in the parser)
+// Exit code 0 when every check held; run by ctest.
+#include "IcsParser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <chrono>
+#include <string>
+
+// ---- Tunables ----
+static const size_t   kCorpusBytes[] = { 100 * 1024, 1024 * 1024, 10 * 1024 * 1024 };
+static const int      kWindowDays    = 7;      // as kLookaheadDays on the device
+static const size_t   kCacheEvents   = 256;    // as CalendarICS.cpp
+static const size_t   kCachePoolBytes = 6144;
+static const size_t   kSliceBytes    = 2048;   // as kParseSliceBytes
+static const double   kMinRunSec     = 0.3;    // repeat a parse until this much time is measured
+static const char*    kDeviceTZ      = "CET-1CEST,M3.5.0,M10.5.0/3";
+
+// ---- Allocation counter (glibc: every malloc, operator new included, goes through here) ----
+static unsigned long gAllocs = 0, gAllocBytes = 0;
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t n);
+extern "C" void* __libc_calloc(size_t n, size_t sz);
+extern "C" void* __libc_realloc(void* p, size_t n);
+extern "C" void  __libc_free(void* p);
+
+extern "C" void* malloc(size_t n) __THROW { gAllocs++; gAllocBytes += n; return __libc_malloc(n); }
+extern "C" void* calloc(size_t n, size_t sz) __THROW { gAllocs++; gAllocBytes += n * sz; return __libc_calloc(n, sz); }
+extern "C" void* realloc(void* p, size_t n) __THROW { gAllocs++; gAllocBytes += n; return __libc_realloc(p, n); }
+extern "C" void  free(void* p) __THROW { __libc_free(p); }
+static const bool kCountsAllocs = true;
+#else
+static const bool kCountsAllocs = false;
+#endif
+
+// ---- Corpus generator ----
+// Deterministic: the same sizes always give the same bytes
+class Corpus {
+public:
+  explicit Corpus(time_t winStart) : win_(winStart) {}
+
+  std::string make(size_t bytes) {
+    out_.clear();
+    out_.reserve(bytes + 4096);
+    seed_ = 12345u;
+    events_ = 0;
+    line("BEGIN:VCALENDAR");
+    line("VERSION:2.0");
+    line("PRODID:-//Zeiger//IcsBench//EN");
+    line("X-WR-CALNAME:Gro\xC3\x9F" "er geteilter Kalender mit einem sehr langen Namen, der gefaltet wird");
+    zone();
+    while (out_.size() < bytes) event();
+    line("END:VCALENDAR");
+    return out_;
+  }
+
+  int events() const { return events_; }
+
+private:
+  uint32_t rnd(uint32_t n) {
+    seed_ = seed_ * 1103515245u + 12345u;
+    return (seed_ >> 8) % n;
+  }
+
+  // Content line, folded at 75 octets (CRLF + space) without splitting a UTF-8 sequence
+  void line(const std::string& s) {
+    size_t i = 0, col = 0;
+    while (i < s.size()) {
+      size_t len = 1;
+      const unsigned char c = (unsigned char)s[i];
+      if (c >= 0xF0) len = 4; else if (c >= 0xE0) len = 3; else if (c >= 0xC0) len = 2;
+      if (col + len > 75) { out_ += "\r\n "; col = 1; }
+      out_.append(s, i, len);
+      col += len; i += len;
+    }
+    out_ += "\r\n";
+  }
+
+  void zone() {
+    line("BEGIN:VTIMEZONE");
+    line("TZID:Europe/Berlin");
+    line("BEGIN:DAYLIGHT");
+    line("TZOFFSETFROM:+0100");
+    line("TZOFFSETTO:+0200");
+    line("DTSTART:19700329T020000");
+    line("RRULE:FREQ=YEARLY;BYMONTH=3;BYDAY=-1SU");
+    line("END:DAYLIGHT");
+    line("BEGIN:STANDARD");
+    line("TZOFFSETFROM:+0200");
+    line("TZOFFSETTO:+0100");
+    line("DTSTART:19701025T030000");
+    line("RRULE:FREQ=YEARLY;BYMONTH=10;BYDAY=-1SU");
+    line("END:STANDARD");
+    line("END:VTIMEZONE");
+  }
+
+  static std::string stamp(time_t t, bool utc, bool date) {
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char b[24];
+    if (date) strftime(b, sizeof(b), "%Y%m%d", &tm);
+    else      strftime(b, sizeof(b), utc ? "%Y%m%dT%H%M%SZ" : "%Y%m%dT%H%M%S", &tm);
+    return b;
+  }
+
+  void event() {
+    const int i = events_++;
+    // Mostly past events (a shared calendar's history), some in the window, some after it
+    const uint32_t where = rnd(100);
+    long day;
+    if      (where < 8)  day = (long)rnd(kWindowDays);
+    else if (where < 20) day = kWindowDays + (long)rnd(365);
+    else                 day = -(long)rnd(7 * 365);
+    const time_t start = win_ + day * 86400L + (7 + (long)rnd(12)) * 3600L + (long)rnd(4) * 900L;
+    const time_t end   = start + (1 + (long)rnd(3)) * 1800L;
+
+    char b[160];
+    line("BEGIN:VEVENT");
+    snprintf(b, sizeof(b), "UID:%08x-%d-bench@zeiger.example", (unsigned)rnd(0x7FFFFFFF), i);
+    line(b);
+    line("DTSTAMP:" + stamp(win_, true, false));
+
+    const uint32_t kind = rnd(100);
+    if (kind < 60) {
+      line("DTSTART;TZID=Europe/Berlin:" + stamp(start, false, false));
+      line("DTEND;TZID=Europe/Berlin:" + stamp(end, false, false));
+    } else if (kind < 85) {
+      line("DTSTART:" + stamp(start, true, false));
+      line("DTEND:" + stamp(end, true, false));
+    } else {
+      line("DTSTART;VALUE=DATE:" + stamp(start, false, true));
+      line("DTEND;VALUE=DATE:" + stamp(start + 86400L, false, true));
+    }
+
+    if (rnd(100) < 30) {
+      static const char* kRules[] = {
+        "RRULE:FREQ=WEEKLY;BYDAY=MO,WE,FR",
+        "RRULE:FREQ=DAILY;COUNT=30",
+        "RRULE:FREQ=WEEKLY;INTERVAL=2;BYDAY=TU;UNTIL=20301231T000000Z",
+        "RRULE:FREQ=MONTHLY;BYMONTHDAY=1,15",
+        "RRULE:FREQ=MONTHLY;BYDAY=2TH",
+        "RRULE:FREQ=YEARLY",
+      };
+      line(kRules[rnd(sizeof(kRules) / sizeof(kRules[0]))]);
+      if (rnd(100) < 30) {
+        const time_t ex = start + 7L * 86400L * (1 + (long)rnd(8));
+        line((kind < 60 ? "EXDATE;TZID=Europe/Berlin:" + stamp(ex, false, false)
+                        : "EXDATE:" + stamp(ex, true, false)));
+      }
+    }
+
+    snprintf(b, sizeof(b), "SUMMARY:Abstimmung %d \xE2\x80\x93 Pr\xC3\xBC" "fung\\, Planung & R\xC3\xBC" "ckblick", i);
+    line(b);
+    if (rnd(100) < 50) {
+      snprintf(b, sizeof(b), "LOCATION:Raum %u\\, Geb\xC3\xA4ude %u", (unsigned)rnd(400), (unsigned)rnd(9));
+      line(b);
+    }
+    std::string desc = "DESCRIPTION:";
+    const int words = 20 + (int)rnd(60);
+    for (int w = 0; w < words; ++w) desc += (w % 9 == 8) ? "Tagesordnung\\n" : "Lorem ipsum ";
+    line(desc);
+    for (uint32_t a = rnd(3); a > 0; --a) {
+      line("BEGIN:VALARM");
+      line("ACTION:DISPLAY");
+      line("DESCRIPTION:Reminder");
+      line(a == 1 ? "TRIGGER:-PT15M" : "TRIGGER;RELATED=START:-P1D");
+      line("END:VALARM");
+    }
+    line("END:VEVENT");
+  }
+
+  time_t      win_;
+  std::string out_;
+  uint32_t    seed_{0};
+  int         events_{0};
+};
+
+// ---- Bench ----
+struct Run {
+  bool          ok;
+  IcsParseStats st;
+  size_t        cached;
+  unsigned long allocs, allocBytes;
+};
+
+static Run parseOnce(IcsParser& p, EventCache& cache, const std::string& body,
+                     time_t winStart, time_t winEnd, size_t slice) {
+  Run r;
+  IcsMemorySource src((const uint8_t*)body.data(), body.size());
+  const unsigned long a0 = gAllocs, b0 = gAllocBytes;
+  p.beginWindow(&cache, winStart, winEnd);
+  p.beginRun(0);
+  IcsStep step;
+  while ((step = p.parseSome(src, true, slice)) == IcsStep::More) {}
+  cache.finalize();
+  r.allocs = gAllocs - a0;
+  r.allocBytes = gAllocBytes - b0;
+  r.ok = (step == IcsStep::Done);
+  r.st = p.stats();
+  r.cached = cache.count();
+  return r;
+}
+
+int main() {
+  // Fixed "today" so the corpora and the window never change between runs
+  struct tm day = {};
+  day.tm_year = 2026 - 1900; day.tm_mon = 9; day.tm_mday = 14;
+  const time_t today = timegm(&day);
+  tzSetDevice(kDeviceTZ, today);
+  const time_t winStart = tzDayStartUTC(today), winEnd = tzDayStartUTC(today, kWindowDays);
+
+  static IcsParser parser;  // static like the provider member: a few KB of working set
+  EventCache cache;
+  if (!cache.begin(kCacheEvents, kCachePoolBytes)) { fprintf(stderr, "cache alloc failed\n"); return 1; }
+
+  Corpus gen(winStart);
+  bool allOk = true;
+  printf("%-8s %9s %8s %8s %7s %9s %12s %8s %10s\n",
+         "corpus", "bytes", "events", "series", "cached", "ms/parse", "events/s", "MB/s", "allocs");
+  for (size_t c = 0; c < sizeof(kCorpusBytes) / sizeof(kCorpusBytes[0]); ++c) {
+    const std::string body = gen.make(kCorpusBytes[c]);
+
+    // Device-style slices first: the reference for the whole-body runs below
+    const Run sliced = parseOnce(parser, cache, body, winStart, winEnd, kSliceBytes);
+
+    double best = 1e30, total = 0;
+    Run whole{};
+    int reps = 0;
+    while (total < kMinRunSec || reps < 1) {
+      const auto t0 = std::chrono::steady_clock::now();
+      whole = parseOnce(parser, cache, body, winStart, winEnd, SIZE_MAX);
+      const double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      if (s < best) best = s;
+      total += s;
+      reps++;
+    }
+
+    char label[16];
+    snprintf(label, sizeof(label), "%uK", (unsigned)(kCorpusBytes[c] / 1024));
+    char allocs[24];
+    if (kCountsAllocs) snprintf(allocs, sizeof(allocs), "%lu", whole.allocs + sliced.allocs);
+    else               snprintf(allocs, sizeof(allocs), "n/a");
+    printf("%-8s %9u %8u %8u %7u %9.2f %12.0f %8.1f %10s\n", label, (unsigned)whole.st.bytes,
+           (unsigned)whole.st.events, (unsigned)whole.st.series, (unsigned)whole.cached, best * 1e3,
+           whole.st.events / best, whole.st.bytes / best / 1e6, allocs);
+
+    // Checks: every byte and VEVENT seen, slicing changes nothing, no heap while parsing
+    const char* why = nullptr;
+    if (!whole.ok || !sliced.ok)                              why = "parse error";
+    else if (whole.st.bytes != body.size())                   why = "byte count";
+    else if (whole.st.events != (uint32_t)gen.events())       why = "VEVENT count";
+    else if (whole.st.added == 0 || whole.cached == 0)        why = "no window events";
+    else if (sliced.st.events != whole.st.events || sliced.st.added != whole.st.added ||
+             sliced.cached != whole.cached)                   why = "sliced parse differs";
+    else if (whole.allocs || sliced.allocs)                   why = "heap allocation while parsing";
+    if (why) { printf("FAIL %s: %s\n", label, why); allOk = false; }
+  }
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+// RenderBench.cpp
+// Native benchmark + golden-image check of the dashboard panels (PanelRender on the PBM backend)
+// - Renders every panel (static frame, clock, weather per icon, calendar full/empty, plants)
+//   on the reference path (Paint_* pixel by pixel) and on the device path (Raster1bpp runs);
+//   both must give the same bytes
+// - Reports µs/frame for each path, the pixel writes of the reference path and the ink
+//   (black) pixels of the result
+// - Compares each panel with golden/<panel>.pbm byte for byte; --update rewrites them.
+//   The goldens are drawn with the stand-in font (fonts.h), not the Waveshare glyphs
+// - Randomized check: lines, rectangles and circles with random (also off-canvas) coordinates
+//   on random canvases must draw the same pixels on both paths
+// Usage: render_bench [golden dir] [--update]. Exit code 0 when every check held; run by ctest.
+#include "DisplayPbm.h"
+#include "PanelRender.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "UiLayout.h"
+
+// ---- Tunables ----
+static const double   kMinRunSec     = 0.1;    // repeat a render until this much time is measured
+static const int      kRandomShapes  = 20000;
+static const int      kRandomMaxW    = 300, kRandomMaxH = 200;
+static const int      kRandomMargin  = 24;     // coordinates reach this far past the canvas
+
+// ---- Panels ----
+static const WeatherData kWeather[] = {
+  { WeatherIcon_Sun,    "Clear sky",     24, 25, 27, 14, 41, 0,  9,  "SW", 6 },
+  { WeatherIcon_Partly, "Partly cloudy", 17, 16, 19, 9,  58, 20, 14, "W",  3 },
+  { WeatherIcon_Rain,   "Moderate rain", 11, 8,  12, 7,  88, 90, 23, "NW", 1 },
+  { WeatherIcon_Storm,  "Thunderstorm",  19, 19, 23, 15, 76, 70, 41, "S",  2 },
+};
+
+static const CalItem kCalendar[] = {
+  { "Standup",                                 "09:00 - 09:15", 0 },
+  { "Design review: panel layout",             "10:30 - 11:30", 0 },
+  { "Lunch",                                   "12:00 - 13:00", 0 },
+  { "1:1",                                     "14:00 - 14:30", 0 },
+  { "A title too long for the column to show",  "16:00 - 17:00", 0 },
+  { "Climbing",                                "19:30 - 21:30", 0 },
+  { "Dropped: only six rows fit",              "22:00 - 23:00", 0 },
+};
+
+static const PlantItem kPlants[] = {
+  { "Monstera", 64, false },
+  { "Basil",    12, true },
+  { "Ficus",    38, false },
+  { "Aloe",     3,  true },
+  { "Calathea", 100, false },
+};
+
+struct Panel {
+  const char* name;
+  int w, h;
+  int arg;
+  void (*render)(uint8_t* image, int arg);
+};
+
+static void staticUI(uint8_t* image, int)  { renderStaticUI(image); }
+static void clockRow(uint8_t* image, int)  { renderClock(image, PRT_CLK_W, PRT_CLK_H, "Mittwoch, 14. Oktober", "12:34"); }
+static void weather(uint8_t* image, int i) { renderWeather(image, &kWeather[i]); }
+static void calendar(uint8_t* image, int n) { renderCalendar(image, kCalendar, n); }
+static void plants(uint8_t* image, int n)  { renderPlants(image, kPlants, n); }
+
+static const Panel kPanels[] = {
+  { "static",         W,         H,         0, staticUI },
+  { "clock",          PRT_CLK_W, PRT_CLK_H, 0, clockRow },
+  { "weather_sun",    PRT_WTH_W, PRT_WTH_H, 0, weather },
+  { "weather_partly", PRT_WTH_W, PRT_WTH_H, 1, weather },
+  { "weather_rain",   PRT_WTH_W, PRT_WTH_H, 2, weather },
+  { "weather_storm",  PRT_WTH_W, PRT_WTH_H, 3, weather },
+  { "calendar",       PRT_CAL_W, PRT_CAL_H, (int)(sizeof(kCalendar) / sizeof(kCalendar[0])), calendar },
+  { "calendar_empty", PRT_CAL_W, PRT_CAL_H, 0, calendar },
+  { "plants",         PRT_PLT_W, PRT_PLT_H, (int)(sizeof(kPlants) / sizeof(kPlants[0])), plants },
+};
+
+// ---- Helpers ----
+static size_t imageBytes(int w, int h) { return (size_t)((w + 7) / 8) * h; }
+
+// Black pixels inside the w x h image (row padding bits not counted)
+static uint32_t inkPixels(const uint8_t* image, int w, int h) {
+  const int rowBytes = (w + 7) / 8;
+  uint32_t n = 0;
+  for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w; ++x)
+      if (!(image[(size_t)y * rowBytes + x / 8] & (0x80 >> (x % 8)))) n++;
+  return n;
+}
+
+static bool readFile(const std::string& path, std::vector<uint8_t>* out) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  out->clear();
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out->insert(out->end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+// Mean µs of one render on the current path, repeated until kMinRunSec is measured
+static double timeRender(const Panel& p, uint8_t* image) {
+  typedef std::chrono::steady_clock Clk;
+  int runs = 0;
+  const Clk::time_point t0 = Clk::now();
+  double sec = 0;
+  do {
+    p.render(image, p.arg);
+    runs++;
+    sec = std::chrono::duration<double>(Clk::now() - t0).count();
+  } while (sec < kMinRunSec);
+  return sec * 1e6 / runs;
+}
+
+// Render on both paths, time them, compare with the golden; false on any mismatch
+static bool runPanel(const Panel& p, const std::string& goldenDir, bool update) {
+  const size_t bytes = imageBytes(p.w, p.h);
+  std::vector<uint8_t> ref(bytes), fast(bytes);
+
+  pbmUseRaster(false);
+  pbmResetStats();
+  p.render(ref.data(), p.arg);
+  const uint32_t writes = pbmStats().pixelWrites;
+  const double refUs = timeRender(p, ref.data());
+
+  pbmUseRaster(true);
+  p.render(fast.data(), p.arg);
+  const double fastUs = timeRender(p, fast.data());
+  pbmUseRaster(false);
+
+  bool ok = true;
+  if (ref != fast) {
+    fprintf(stderr, "%s: raster path differs from the reference\n", p.name);
+    ok = false;
+  }
+
+  const std::string outPath = std::string(p.name) + ".pbm";
+  const std::string goldenPath = goldenDir + "/" + p.name + ".pbm";
+  if (!pbmWrite(outPath.c_str(), ref.data(), p.w, p.h)) {
+    fprintf(stderr, "%s: cannot write %s\n", p.name, outPath.c_str());
+    return false;
+  }
+  if (update && !pbmWrite(goldenPath.c_str(), ref.data(), p.w, p.h)) {
+    fprintf(stderr, "%s: cannot write %s\n", p.name, goldenPath.c_str());
+    return false;
+  }
+  std::vector<uint8_t> got, want;
+  if (!readFile(outPath, &got) || !readFile(goldenPath, &want)) {
+    fprintf(stderr, "%s: missing %s (run with --update to create it)\n", p.name, goldenPath.c_str());
+    ok = false;
+  } else if (got != want) {
+    fprintf(stderr, "%s: differs from %s (new render in %s)\n", p.name, goldenPath.c_str(), outPath.c_str());
+    ok = false;
+  }
+
+  printf("%-15s %4dx%-4d %9.1f %9.1f %6.1fx %9u %8u  %s\n", p.name, p.w, p.h, refUs, fastUs,
+         fastUs > 0 ? refUs / fastUs : 0.0, writes, inkPixels(ref.data(), p.w, p.h),
+         ok ? "ok" : "FAIL");
+  return ok;
+}
+
+// ---- Randomized reference vs raster check ----
+static uint32_t gSeed = 2463534242u;
+static int rnd(int n) {
+  gSeed ^= gSeed << 13; gSeed ^= gSeed >> 17; gSeed ^= gSeed << 5;
+  return (int)(gSeed % (uint32_t)n);
+}
+static int coord(int extent) { return rnd(extent + 2 * kRandomMargin) - kRandomMargin; }
+
+static bool randomShapes() {
+  std::vector<uint8_t> ref, fast;
+  int fails = 0;
+  for (int i = 0; i < kRandomShapes && fails < 5; ++i) {
+    const int w = 1 + rnd(kRandomMaxW), h = 1 + rnd(kRandomMaxH);
+    const int kind = rnd(5);
+    const int a = coord(w), b = coord(h), c = coord(w), d = coord(h);
+    const int r = rnd(kRandomMaxH / 2);
+    const uint16_t color = rnd(2) ? kGfxBlack : kGfxWhite;
+
+    // Same random background on both, so white strokes show too
+    ref.resize(imageBytes(w, h));
+    for (size_t k = 0; k < ref.size(); ++k) ref[k] = (uint8_t)rnd(256);
+    fast = ref;
+
+    for (int path = 0; path < 2; ++path) {
+      pbmUseRaster(path == 1);
+      gfx()->select(path ? fast.data() : ref.data(), w, h);
+      switch (kind) {
+        case 0: gfx()->line(a, b, c, d, color, kGfxDot1, GfxStyle::Solid); break;
+        case 1: gfx()->rect(a, b, c, d, color, kGfxDot1, GfxFill::Empty); break;
+        case 2: gfx()->rect(a, b, c, d, color, kGfxDot1, GfxFill::Full); break;
+        case 3: gfx()->circle(a, b, r, color, kGfxDot1, GfxFill::Empty); break;
+        default: gfx()->circle(a, b, r, color, kGfxDot1, GfxFill::Full); break;
+      }
+    }
+    pbmUseRaster(false);
+    if (ref != fast) {
+      static const char* kKinds[] = { "line", "rect", "filled rect", "circle", "filled circle" };
+      fprintf(stderr, "random #%d: %s (%d,%d) (%d,%d) r=%d color=%u on %dx%d differs\n", i,
+              kKinds[kind], a, b, c, d, r, color, w, h);
+      fails++;
+    }
+  }
+  printf("random shapes   %d drawn, %s\n", kRandomShapes, fails ? "FAIL" : "ok");
+  return fails == 0;
+}
+
+int main(int argc, char** argv) {
+  std::string goldenDir = "golden";
+  bool update = false;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--update")) update = true;
+    else goldenDir = argv[i];
+  }
+
+  gfxSetBackend(makePbmBackend(W, H));
+
+  bool ok = true;
+  printf("%-15s %-9s %9s %9s %7s %9s %8s\n", "panel", "size", "ref us", "fast us", "speedup",
+         "writes", "ink");
+  for (size_t i = 0; i < sizeof(kPanels) / sizeof(kPanels[0]); ++i)
+    ok = runPanel(kPanels[i], goldenDir, update) && ok;
+  ok = randomShapes() && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+// fonts.h (host)
+// Stand-in for the Waveshare font pack, whose tables are not part of this repo
+// - Same sFONT layout and cell sizes as the pack (Font8 5x8 ... Font24 17x24), so layout,
+//   wrapping, clipping and the glyph blits run exactly as on the device
+// - Glyphs are synthetic but fixed (HostFonts.cpp): golden images only change with the code
+#pragma once
+#include <stdint.h>
+
+typedef struct _tFont {
+  const uint8_t* table;  // 0x20..0x7E, rows padded to whole bytes, MSB = leftmost column
+  uint16_t Width;
+  uint16_t Height;
+} sFONT;
+
+extern sFONT Font8;
+extern sFONT Font12;
+extern sFONT Font16;
+extern sFONT Font20;
+extern sFONT Font24;